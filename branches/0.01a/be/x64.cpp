@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include "me/constpool.h"
+#include "me/profile.h"
 #include "me/stacklayout.h"
 
 #include "be/x64codegen.h"
@@ -214,12 +215,64 @@ void X64::emitStart(std::ofstream& ofs) const
         << "_start:\n"
         << "\t.cfi_startproc\n"
         << "\tandq\t$" << 0xFFFFFFFFFFFFFFF0ull << ", %rsp\n"
-        << "\tcall\tmain\n"
-        << "\tmovq\t%rax, %rdi\n"
+        << "\tcall\tmain\n";
+
+    bool instrument = me::profile && me::profile->mode() == me::Profile::GENERATE;
+
+    if (instrument)
+    {
+        ofs << "\tpushq\t%rax\n"
+            << "\tcall\tswift_profile_dump\n"
+            << "\tpopq\t%rax\n";
+    }
+
+    ofs << "\tmovq\t%rax, %rdi\n"
         << "\tmovq\t$0x3c, %rax\n"
         << "\tsyscall\n"
         << "\thlt\n"
         << "\t.cfi_endproc\n\n";
+
+    if (instrument)
+        emitProfileDump(ofs);
+}
+
+void X64::emitProfileDump(std::ofstream& ofs) const
+{
+    size_t size = me::profile->numCounters() * 8;
+
+    // open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+    ofs << "\t.type\tswift_profile_dump,@function\n"
+        << "swift_profile_dump:\n"
+        << "\tmovq\t$2, %rax\n"
+        << "\tleaq\tswift_profile_file(%rip), %rdi\n"
+        << "\tmovq\t$0x241, %rsi\n"
+        << "\tmovq\t$0644, %rdx\n"
+        << "\tsyscall\n"
+        << "\ttestq\t%rax, %rax\n"
+        << "\tjs\t.Lswift_profile_done\n"
+    // write(fd, counters, size)
+        << "\tmovq\t%rax, %rdi\n"
+        << "\tpushq\t%rdi\n"
+        << "\tmovq\t$1, %rax\n"
+        << "\tleaq\tswift_profile_counters(%rip), %rsi\n"
+        << "\tmovq\t$" << size << ", %rdx\n"
+        << "\tsyscall\n"
+    // close(fd)
+        << "\tpopq\t%rdi\n"
+        << "\tmovq\t$3, %rax\n"
+        << "\tsyscall\n"
+        << ".Lswift_profile_done:\n"
+        << "\tret\n"
+        << "\t.size\tswift_profile_dump, .-swift_profile_dump\n\n";
+
+    // the symbol must exist even if there is nothing to count
+    ofs << "\t.local\tswift_profile_counters\n"
+        << "\t.comm\tswift_profile_counters," << (size ? size : 8) << ",8\n";
+
+    ofs << "\t.section\t.rodata\n"
+        << "swift_profile_file:\n"
+        << "\t.string\t\"" << me::profile->filename() << "\"\n"
+        << "\t.text\n\n";
 }
 
 /*
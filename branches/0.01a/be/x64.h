@@ -70,6 +70,9 @@ public:
      */
 
     virtual void emitStart(std::ofstream& ofs) const;
+
+    /// Emits the counters and the routine which writes them to the profile.
+    void emitProfileDump(std::ofstream& ofs) const;
     
     /*
      * clean up
@@ -24,6 +24,7 @@
 
 #include "me/cfg.h"
 #include "me/functab.h"
+#include "me/profile.h"
 #include "me/stacklayout.h"
 
 #include "be/x64codegenhelpers.h"
@@ -113,8 +114,12 @@ void X64CodeGen::process()
             me::BBNode* oldNode = currentNode;
             currentNode = cfg_->labelNode2BBNode_[iter];
 
-            if (!phisInserted)
+            // only generate phi stuff if oldNode falls through to this one
+            if ( !phisInserted && oldNode && oldNode->succ_.size() == 1
+                    && oldNode->succ_.first()->value_ == currentNode )
+            {
                 genPhiInstr(oldNode, currentNode);
+            }
 
             currentNode = cfg_->labelNode2BBNode_[iter];
             phisInserted = false;
@@ -136,18 +141,9 @@ void X64CodeGen::process()
                 genPhiInstr(currentNode, target);
                 phisInserted = true;
 
-                me::InstrNode* labelIter = iter->next();
-                while ( labelIter != cfg_->instrList_.sentinel() 
-                        && typeid(*labelIter) == typeid(me::LabelInstr) )
-                {
-                    if (labelIter == jump->instrTargets_[0])
-                    {
-                        std::cout << labelIter->value_->toString() << std::endl;
-                        goto outer_loop;
-                    }
-
-                    labelIter = labelIter->next();
-                }
+                // omit the jump if the target follows anyway
+                if ( iter->next() == jump->instrTargets_[0] )
+                    goto outer_loop;
             }
         }
         else if ( typeid(*instr) == typeid(me::AssignInstr) )
@@ -184,6 +180,15 @@ void X64CodeGen::process()
 
         x64parse();
 
+        // count each execution of this basic block
+        if ( typeid(*instr) == typeid(me::LabelInstr)
+                && me::profile && me::profile->mode() == me::Profile::GENERATE )
+        {
+            int index = me::profile->counterIndex(iter);
+            if (index != -1)
+                ofs_ << "\tincq\tswift_profile_counters+" << 8*index << "(%rip)\n";
+        }
+
 outer_loop:
         continue;
     }
@@ -20,33 +20,56 @@
 #include "cmdlineparser.h"
 
 #include <iostream>
+#include <string>
 
 namespace swift {
 
 CmdLineParser::CmdLineParser(int argc, char** argv)
     : argc_(argc)
     , argv_(argv)
+    , filename_(0)
     , error_(false)
     , optimize_(false)
+    , profileGenerate_(false)
+    , profileUse_(false)
 {
-    switch (argc)
+    for (int i = 1; i < argc; ++i)
     {
-        case 0:
-        case 1:
-            std::cerr << "error: no input file specified" << std::endl;
+        std::string arg = argv[i];
+
+        if (arg == "-profile-generate")
+            profileGenerate_ = true;
+        else if (arg == "-profile-use")
+            profileUse_ = true;
+        else if ( !arg.empty() && arg[0] == '-' )
+        {
+            std::cerr << "error: unknown option '" << arg << "'" << std::endl;
             error_ = true;
             return;
-
-        case 2:
-            filename_ = argv[1];
-            break;
-
-        default:
+        }
+        else if (filename_)
+        {
             std::cerr << "error: too many arguments" << std::endl;
             error_ = true;
             return;
+        }
+        else
+            filename_ = argv[i];
+    }
+
+    if (!filename_)
+    {
+        std::cerr << "error: no input file specified" << std::endl;
+        error_ = true;
+        return;
     }
 
+    if (profileGenerate_ && profileUse_)
+    {
+        std::cerr << "error: -profile-generate and -profile-use are mutually exclusive" << std::endl;
+        error_ = true;
+        return;
+    }
 }
 
 } // namespace swift
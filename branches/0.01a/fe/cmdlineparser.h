@@ -32,6 +32,8 @@ struct CmdLineParser
     const char* filename_;
     bool error_;
     bool optimize_;
+    bool profileGenerate_;
+    bool profileUse_;
 
     CmdLineParser(int argc, char** argv);
 };
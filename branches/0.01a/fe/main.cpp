@@ -34,10 +34,12 @@
 #include "fe/syntaxtree.h"
 #include "fe/type.h"
 
+#include "me/blocklayout.h"
 #include "me/constpool.h"
 #include "me/functab.h"
 #include "me/defusecalc.h"
 #include "me/livenessanalysis.h"
+#include "me/profile.h"
 #include "me/stackcoloring.h"
 
 #include "be/x64.h"
@@ -102,6 +104,14 @@ int start(int argc, char** argv)
 
     me::constpool = new me::ConstPool();
 
+    me::Profile::Mode profileMode = me::Profile::NONE;
+    if (cmdLineParser.profileGenerate_)
+        profileMode = me::Profile::GENERATE;
+    else if (cmdLineParser.profileUse_)
+        profileMode = me::Profile::USE;
+
+    me::profile = new me::Profile( profileMode, std::string(cmdLineParser.filename_) + ".prof" );
+
     // populate symtab with builtin types
     readBuiltinTypes();
 
@@ -161,7 +171,14 @@ int start(int argc, char** argv)
      * calculate the dominance frontier,
      * place phi-functions in SSA form and update vars
      */
-    me::functab->buildUpME();
+    if ( !me::functab->buildUpME() )
+    {
+        cleanUpME();
+        return EXIT_FAILURE;
+    }
+
+    // number the basic blocks and read the profile if necessary
+    me::profile->init(me::functab);
 
     /*
      * build up back-end and generate assembly code
@@ -194,6 +211,7 @@ int start(int argc, char** argv)
         if ( function->ignore() )
             continue;
 
+        me::BlockLayout(function).process();
         me::arch->codeGen(function, ofs);
     }
 
@@ -231,6 +249,7 @@ void cleanUpME()
      */
     delete me::functab;
     delete me::constpool;
+    delete me::profile;
 
     /*
      * clean up back-end
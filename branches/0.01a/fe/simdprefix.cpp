@@ -103,7 +103,7 @@ void SimdPrefix::genPreSSA()
      *     IF simd_check THEN trueLabelNode ELSE nextLabelNode
      * trueLabelNode:
      *     //...                             <- will be created by the parent statement
-     *     $simd_counter = $simd_counter + 1 <- will be created by genSSA
+     *     $simd_counter = $simd_counter + simdLength <- will be created by genSSA
      *     GOTO simdLabelNode                <- will be created by genSSA
      * nextLabelNode:                        <- will be created by genSSA
      *     //...
@@ -156,7 +156,7 @@ void SimdPrefix::genPostSSA(SimdAnalysis& simdAnalysis)
      *     IF simd_check THEN trueLabelNode ELSE nextLabelNode  <- already created
      * trueLabelNode:                                           <- already created
      *     //...                                                <- already created
-     *     $simd_counter = $simd_counter + 1
+     *     $simd_counter = $simd_counter + simdLength
      *     GOTO simdLabelNode
      * nextLabelNode:
      *     //...
@@ -0,0 +1,241 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "me/blocklayout.h"
+
+#include <algorithm>
+#include <typeinfo>
+
+#include "utils/assert.h"
+
+#include "me/cfg.h"
+#include "me/functab.h"
+#include "me/profile.h"
+
+namespace me {
+
+//------------------------------------------------------------------------------
+
+// helpers
+namespace {
+
+struct LayoutEdge
+{
+    BBNode* from_;
+    BBNode* to_;
+    uint64_t count_;
+
+    LayoutEdge(BBNode* from, BBNode* to, uint64_t count)
+        : from_(from)
+        , to_(to)
+        , count_(count)
+    {}
+
+    /// Sorts the hottest edges to the front.
+    bool operator < (const LayoutEdge& edge) const
+    {
+        return count_ > edge.count_;
+    }
+};
+
+struct ChainCmp
+{
+    /// Sorts the hottest chains to the front.
+    bool operator () (const std::vector<BBNode*>* c1, const std::vector<BBNode*>* c2)
+    {
+        return profile->count(c1->front()) > profile->count(c2->front());
+    }
+};
+
+}
+
+//------------------------------------------------------------------------------
+
+/*
+ * constructor
+ */
+
+BlockLayout::BlockLayout(Function* function)
+    : CodePass(function)
+{}
+
+/*
+ * methods
+ */
+
+void BlockLayout::process()
+{
+    if ( !profile || !profile->hasCounts() )
+        return;
+
+    buildChains();
+
+    std::vector<BBNode*> order;
+    orderChains(order);
+    rearrange(order);
+
+    for (size_t i = 0; i < chains_.size(); ++i)
+        delete chains_[i];
+}
+
+void BlockLayout::buildChains()
+{
+    std::vector<LayoutEdge> edges;
+
+    // start with one chain per basic block in the current order
+    INSTRLIST_EACH(iter, cfg_->instrList_)
+    {
+        if ( typeid(*iter->value_) != typeid(LabelInstr) )
+            continue;
+
+        BBNode* bbNode = cfg_->labelNode2BBNode_[iter];
+        if (bbNode == cfg_->exit_)
+            continue;
+
+        Chain* chain = new Chain();
+        chain->push_back(bbNode);
+        chains_.push_back(chain);
+        bb2Chain_[bbNode] = chain;
+
+        CFG_RELATIVES_EACH(succIter, bbNode->succ_)
+        {
+            BBNode* succ = succIter->value_;
+
+            if (succ != cfg_->exit_ && succ != cfg_->entry_)
+                edges.push_back( LayoutEdge(bbNode, succ, profile->count(bbNode, succ)) );
+        }
+    }
+
+    // keep the original order for equally hot edges
+    std::stable_sort( edges.begin(), edges.end() );
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        LayoutEdge& edge = edges[i];
+
+        if (edge.count_ == 0)
+            break; // never taken -> do not chain
+
+        Chain* fromChain = bb2Chain_[edge.from_];
+        Chain* toChain   = bb2Chain_[edge.to_];
+
+        // from must be the tail and to the head of different chains
+        if (   fromChain == toChain
+            || fromChain->back()  != edge.from_
+            || toChain->front() != edge.to_ )
+        {
+            continue;
+        }
+
+        // append toChain to fromChain
+        for (size_t j = 0; j < toChain->size(); ++j)
+        {
+            fromChain->push_back( (*toChain)[j] );
+            bb2Chain_[ (*toChain)[j] ] = fromChain;
+        }
+
+        chains_.erase( std::find(chains_.begin(), chains_.end(), toChain) );
+        delete toChain;
+    }
+}
+
+void BlockLayout::orderChains(std::vector<BBNode*>& order)
+{
+    Chain* entryChain = bb2Chain_[cfg_->entry_];
+    swiftAssert( entryChain->front() == cfg_->entry_, "entry must head its chain" );
+
+    Chains chains;
+    for (size_t i = 0; i < chains_.size(); ++i)
+    {
+        if (chains_[i] != entryChain)
+            chains.push_back(chains_[i]);
+    }
+
+    // keep the original order for equally hot chains
+    std::stable_sort( chains.begin(), chains.end(), ChainCmp() );
+    chains.insert(chains.begin(), entryChain);
+
+    for (size_t i = 0; i < chains.size(); ++i)
+        order.insert( order.end(), chains[i]->begin(), chains[i]->end() );
+}
+
+void BlockLayout::rearrange(const std::vector<BBNode*>& order)
+{
+    InstrList& instrList = cfg_->instrList_;
+    InstrNode* exitLabel = cfg_->exit_->value_->begin_;
+
+    /*
+     * unlink all instructions in front of the exit and put them back in the
+     * new order
+     */
+
+    std::vector<InstrNode*> instrs;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        BasicBlock* bb = order[i]->value_;
+
+        for (InstrNode* iter = bb->begin_; iter != bb->end_; iter = iter->next())
+            instrs.push_back(iter);
+    }
+
+    for (size_t i = 0; i < instrs.size(); ++i)
+        instrList.unlink(instrs[i]);
+
+    InstrNode* prev = exitLabel->prev();
+    for (size_t i = 0; i < instrs.size(); ++i)
+    {
+        instrList.insert(prev, instrs[i]);
+        prev = instrs[i];
+    }
+
+    /*
+     * fix the bounds of the basic blocks and add gotos where the successor
+     * does not follow anymore
+     */
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        BBNode* bbNode = order[i];
+        BasicBlock* bb = bbNode->value_;
+        BBNode* next = (i + 1 < order.size()) ? order[i + 1] : cfg_->exit_;
+
+        bb->end_ = next->value_->begin_;
+
+        InstrNode* last = bb->end_->prev();
+        BBNode* succ = bbNode->succ_.first()->value_;
+
+        if ( !dynamic_cast<JumpInstr*>(last->value_) && succ != next )
+        {
+            swiftAssert( bbNode->succ_.size() == 1, "must have exactly one successor" );
+
+            GotoInstr* gi = new GotoInstr(succ->value_->begin_);
+            gi->bbTargets_[0] = succ;
+
+            // the code generation of phi functions needs proper liveness
+            gi->liveIn_  = last->value_->liveOut_;
+            gi->liveOut_ = last->value_->liveOut_;
+
+            instrList.insert(last, gi);
+        }
+
+        bb->fixPointers();
+    }
+}
+
+} // namespace me
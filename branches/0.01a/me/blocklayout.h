@@ -0,0 +1,81 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ME_BLOCK_LAYOUT_H
+#define ME_BLOCK_LAYOUT_H
+
+#include <vector>
+
+#include "me/codepass.h"
+#include "me/forward.h"
+
+namespace me {
+
+/**
+ * @brief Reorders the basic blocks according to the \a Profile.
+ *
+ * Basic blocks connected by the hottest edges are chained together so the
+ * hot paths fall through. The chain of the entry comes first, the other
+ * chains follow by decreasing execution count so never executed code ends
+ * up at the end of the function. The exit always stays last.
+ *
+ * Basic blocks which do not fall through to their successor anymore get an
+ * additional GotoInstr. This pass must run directly before code generation.
+ */
+class BlockLayout : public CodePass
+{
+public:
+
+    /*
+     * constructor
+     */
+
+    BlockLayout(Function* function);
+
+    /*
+     * methods
+     */
+
+    virtual void process();
+
+private:
+
+    typedef std::vector<BBNode*> Chain;
+    typedef std::vector<Chain*> Chains;
+
+    /// Builds chains of basic blocks along the hottest edges.
+    void buildChains();
+
+    /// Brings the chains into their final order.
+    void orderChains(std::vector<BBNode*>& order);
+
+    /// Moves the instructions according to \p order and fixes the jumps.
+    void rearrange(const std::vector<BBNode*>& order);
+
+    /*
+     * data
+     */
+
+    Chains chains_;
+    Map<BBNode*, Chain*> bb2Chain_;
+};
+
+} // namespace me
+
+#endif // ME_BLOCK_LAYOUT_H
@@ -1093,19 +1093,35 @@ BBNode* CFG::isIfElseClause(BBNode* headerNode)
     for (size_t i = 0; i < 2; ++i)
     {
         BBNode* iter = branch->bbTargets_[i];
+        bool afterLoop = false;
 
-        while ( iter->pred_.size() == 1 )
+        while (true)
         {
-            if ( !dominates(headerNode, iter) )
+            if ( iter->pred_.size() == 1 || afterLoop )
             {
-                std::cout << "fjdk" << std::endl;
-                return false;
+                if ( !dominates(headerNode, iter) )
+                    return 0;
+
+                if ( iter->succ_.empty() )
+                    return 0;
+
+                iter = iter->succ_.first()->value_;
+                afterLoop = false;
             }
+            else if (    loops_.contains(iter) 
+                      && iter->pred_.size() == loops_[iter]->backEdges_.size() + 1
+                      && dominates(headerNode, iter) )
+            {
+                // -> a loop which is only entered from this clause so step over it
+                iter = findLoopMerge(iter);
 
-            if ( iter->succ_.empty() )
-                return false;
+                if (!iter)
+                    return 0;
 
-            iter = iter->succ_.first()->value_;
+                afterLoop = true;
+            }
+            else
+                break;
         }
 
         mergeNodes[i] = iter;
@@ -1204,6 +1220,38 @@ void CFG::findLoops()
     } // for each node
 }
 
+BBNode* CFG::findLoopMerge(BBNode* headerNode)
+{
+    swiftAssert( loops_.contains(headerNode), "must be a loop header" );
+    Loop* loop = loops_[headerNode];
+
+    if ( loop->exitEdges_.empty() )
+        return 0;
+
+    if ( loop->exitEdges_.size() == 1 )
+        return loop->exitEdges_[0].to_;
+
+    BBNode* merge = 0;
+
+    // for each exit edge
+    for (size_t i = 0; i < loop->exitEdges_.size(); ++i)
+    {
+        BBNode* toNode = loop->exitEdges_[i].to_;
+
+        if ( toNode->succ_.size() != 1 )
+            return 0;
+
+        BBNode* succNode = toNode->succ_.first()->value_;
+
+        if ( merge && merge != succNode )
+            return 0; // the exits do not merge
+
+        merge = succNode;
+    }
+
+    return merge;
+}
+
 /*
  * ommiting the interference graph
  */
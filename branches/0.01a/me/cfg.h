@@ -190,6 +190,18 @@ struct CFG : public Graph<BasicBlock>
     BBNode* isIfElseClause(BBNode* headerNode);
     void findLoops();
 
+    /** 
+     * @brief Finds the basic block where the control flow continues after
+     * the loop headed by \p headerNode.
+     *
+     * If the loop has several exits each exit must lead through an empty basic
+     * block, which has been inserted by \a eliminateCriticalEdges, to the
+     * same basic block.
+     *
+     * @return The merging basic block or 0 if there is none.
+     */
+    BBNode* findLoopMerge(BBNode* headerNode);
+
     /*
      * ommiting the interference graph
      */
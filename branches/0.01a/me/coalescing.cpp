@@ -37,6 +37,7 @@
 #include "me/cfg.h"
 #include "me/functab.h"
 #include "me/op.h"
+#include "me/profile.h"
 #include "me/ssa.h"
 
 /*
@@ -166,6 +167,13 @@ void Coalescing::buildAffinityEdges()
                 else
                     reg2Node_[from].costs_ += 1;
 
+                // prefer to coalesce copies on hot edges
+                if (profile)
+                {
+                    int weight = profile->weight( function_, phi->sourceBBs_[i], to->def_.bbNode_ );
+                    reg2Node_[from].costs_ += weight;
+                    reg2Node_[to].costs_ += weight;
+                }
 
                 affinityEdges_.push_back( AffinityEdge(from, to) );
                 regs_.insert(from);
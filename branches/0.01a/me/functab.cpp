@@ -20,6 +20,7 @@
 #include "me/functab.h"
 
 #include <algorithm>
+#include <iostream>
 #include <sstream>
 #include <typeinfo>
 
@@ -27,6 +28,7 @@
 
 #include "me/arch.h"
 #include "me/cfg.h"
+#include "me/inliner.h"
 #include "me/struct.h"
 #include "me/stacklayout.h"
 #include "me/vectorizer.h"
@@ -470,7 +472,7 @@ void FunctionTable::analyzeStructs()
         structs_[i]->analyze();
 }
 
-void FunctionTable::buildUpME()
+bool FunctionTable::buildUpME()
 {
     // build up middle-end for normal functions
     for (FunctionMap::iterator iter = functions_.begin(); iter != functions_.end(); ++iter)
@@ -479,6 +481,9 @@ void FunctionTable::buildUpME()
         function->cfg_->constructSSAForm();
     }
 
+    // inline small functions so the simd functions do not contain calls
+    Inliner(this).process();
+
     // vectorize
     for (FunctionMap::iterator iter = functions_.begin(); iter != functions_.end(); ++iter)
     {
@@ -488,8 +493,21 @@ void FunctionTable::buildUpME()
         {
             Vectorizer vectorizer(function);
             vectorizer.process();
+
+            if ( vectorizer.getUnsupported() )
+            {
+                cerr << "error: simd routine '" << *function->id_ 
+                     << "' cannot be vectorized: " << vectorizer.getUnsupported()
+                     << " are not supported yet" << endl;
+                return false;
+            }
         }
     }
+
+    // now the simd versions of the functions are available, too
+    Inliner(this).process();
+
+    return true;
 }
 
 void FunctionTable::dumpSSA()
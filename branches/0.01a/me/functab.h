@@ -229,7 +229,8 @@ struct FunctionTable
     InstrNode* getFunctionEpilogue();
 
     void analyzeStructs();
-    void buildUpME();
+    /// Returns false if a simd function could not be vectorized.
+    bool buildUpME();
 
     void dumpSSA();
     void dumpDot();
@@ -0,0 +1,499 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "me/inliner.h"
+
+#include <typeinfo>
+
+#include "utils/assert.h"
+
+#include "me/cfg.h"
+#include "me/offset.h"
+
+namespace me {
+
+/*
+ * constructor
+ */
+
+Inliner::Inliner(FunctionTable* functab)
+    : functab_(functab)
+    , caller_(0)
+{}
+
+/*
+ * further methods
+ */
+
+void Inliner::process()
+{
+    FunctionTable::FunctionMap& functions = functab_->functions_;
+
+    for (FunctionTable::FunctionMap::iterator iter = functions.begin(); iter != functions.end(); ++iter)
+    {
+        Function* function = iter->second;
+
+        if ( !states_.contains(function) )
+            inlineCalls(function);
+    }
+}
+
+void Inliner::inlineCalls(Function* caller)
+{
+    states_[caller] = IN_PROGRESS;
+
+    // collect all calls first since the instruction list is modified afterwards
+    typedef std::vector< std::pair<InstrNode*, Function*> > Calls;
+    Calls calls;
+
+    INSTRLIST_EACH(iter, caller->instrList_)
+    {
+        CallInstr* call = dynamic_cast<CallInstr*>(iter->value_);
+        if (!call)
+            continue;
+
+        Function* callee = findCallee(call);
+        if (!callee)
+            continue;
+
+        // inline the callee's calls first
+        if ( !states_.contains(callee) )
+            inlineCalls(callee);
+
+        // do not inline recursive calls
+        if ( states_[callee] == IN_PROGRESS )
+            continue;
+
+        calls.push_back( std::make_pair(iter, callee) );
+    }
+
+    size_t callerSize = calcSize(caller);
+    bool inlined = false;
+
+    for (size_t i = 0; i < calls.size(); ++i)
+    {
+        InstrNode* callNode = calls[i].first;
+        Function* callee = calls[i].second;
+
+        if ( !isWorthInlining(caller, callerSize, callee, (CallInstr*) callNode->value_) )
+            continue;
+
+        caller_ = caller;
+        inlineCall(callNode, callee);
+        callerSize += calcSize(callee);
+        inlined = true;
+    }
+
+    if (inlined)
+    {
+        CFG* cfg = caller->cfg_;
+
+        // HACK this should be superfluous when there is a good graph implementation
+        cfg->entry_->postOrderIndex_ = 0;
+
+        // new basic blocks have been inserted, so recompute dominance stuff
+        cfg->calcPostOrder(cfg->entry_);
+        cfg->calcDomTree();
+        cfg->calcDomFrontier();
+    }
+
+    states_[caller] = DONE;
+}
+
+Function* Inliner::findCallee(CallInstr* call)
+{
+    if ( call->isVarArg() )
+        return 0;
+
+    FunctionTable::FunctionMap::iterator iter = functab_->functions_.find(&call->symbol_);
+    if ( iter == functab_->functions_.end() )
+        return 0;
+
+    Function* callee = iter->second;
+
+    // ignored functions are not built so there is nothing to inline
+    if ( callee->ignore() || callee->isMain() )
+        return 0;
+
+    return callee;
+}
+
+bool Inliner::isWorthInlining(Function* caller, size_t callerSize,
+        Function* callee, CallInstr* call)
+{
+    // the call must match the callee's params and results
+    if ( call->arg_.size() != callee->arg_.size() || call->res_.size() != callee->res_.size() )
+        return false;
+
+    // params and results are connected via copies which is only possible with regs
+    for (size_t i = 0; i < call->arg_.size(); ++i)
+    {
+        if ( call->arg_[i].op_->type_ == Op::R_MEM )
+            return false;
+    }
+    for (size_t i = 0; i < call->res_.size(); ++i)
+    {
+        if ( call->res_[i].var_->type_ == Op::R_MEM )
+            return false;
+    }
+
+    size_t calleeSize = calcSize(callee);
+
+    if (callerSize + calleeSize > MAX_CALLER_SIZE)
+        return false;
+
+    // a call cannot be vectorized so inline as much as possible here
+    if (caller->vectorize_)
+        return calleeSize <= MAX_SIMD_CALLEE_SIZE;
+
+    /*
+     * Each param and each result must be shuffled into place. The cost of
+     * caller-saved regs around the call is covered by GROWTH_FACTOR.
+     */
+    size_t callCost = CALL_COST + call->arg_.size() + call->res_.size();
+
+    return calleeSize <= GROWTH_FACTOR * callCost;
+}
+
+void Inliner::inlineCall(InstrNode* callNode, Function* callee)
+{
+    CFG* cfg = caller_->cfg_;
+    CFG* calleeCFG = callee->cfg_;
+    InstrList& instrList = caller_->instrList_;
+    CallInstr* call = (CallInstr*) callNode->value_;
+
+    src2dstVar_.clear();
+    src2dstLabel_.clear();
+    src2dstBBNode_.clear();
+
+    /*
+     * Split the basic block of the call:
+     *
+     * +-------------+
+     * | topNode     | <--- keeps the preds and the phis
+     * +-------------+
+     *        |
+     *        v
+     * +-------------+
+     * | copy of the |
+     * | callee      |
+     * +-------------+
+     *        |
+     *        v
+     * +-------------+
+     * | bbNode      | <--- keeps the succs, starts with the call
+     * +-------------+
+     */
+
+    BBNode* bbNode = cfg->findBBNode(callNode);
+    cfg->splitBB(callNode, bbNode);
+    BBNode* topNode = bbNode->pred_.first()->value_;
+
+    // unlink top from bottom since the callee is put in between
+    topNode->succ_.clear();
+    bbNode->pred_.clear();
+
+    InstrNode* bottomLabel = bbNode->value_->begin_;
+    InstrNode* calleeExitLabel = calleeCFG->exit_->value_->begin_;
+
+    // create all labels in advance so jumps can be mapped at once
+    INSTRLIST_EACH(iter, callee->instrList_)
+    {
+        if ( typeid(*iter->value_) != typeid(LabelInstr) )
+            continue;
+
+        if (iter == calleeExitLabel)
+            src2dstLabel_[iter] = bottomLabel;
+        else
+            src2dstLabel_[iter] = new InstrNode( new LabelInstr() );
+    }
+
+    /*
+     * copy the callee's instructions in front of the bottom label
+     */
+
+    InstrNode* appendTo = bottomLabel->prev();
+    SetResults* setResults = 0;
+
+    INSTRLIST_EACH(iter, callee->instrList_)
+    {
+        InstrBase* instr = iter->value_;
+
+        if (iter == calleeExitLabel)
+            break;
+
+        if ( typeid(*instr) == typeid(LabelInstr) )
+        {
+            instrList.insert( appendTo, src2dstLabel_[iter] );
+            appendTo = src2dstLabel_[iter];
+        }
+        else if ( typeid(*instr) == typeid(SetParams) )
+        {
+            // params = args of the call
+            for (size_t i = 0; i < instr->res_.size(); ++i)
+            {
+                appendTo = instrList.insert( appendTo, new AssignInstr(
+                            '=', cloneVar(instr->res_[i].var_), call->arg_[i].op_) );
+            }
+        }
+        else if ( typeid(*instr) == typeid(SetResults) )
+        {
+            // results are copied right at the call
+            setResults = (SetResults*) instr;
+        }
+        else
+            appendTo = instrList.insert( appendTo, cloneInstr(instr) );
+    }
+
+    // results of the call = results of the callee
+    appendTo = callNode;
+    for (size_t i = 0; i < call->res_.size(); ++i)
+    {
+        swiftAssert(setResults, "must have been found here");
+        appendTo = instrList.insert( appendTo, new AssignInstr(
+                    '=', call->res_[i].var_, cloneOp(setResults->arg_[i].op_)) );
+    }
+
+    delete call;
+    instrList.erase(callNode);
+
+    /*
+     * create the basic blocks
+     */
+
+    src2dstBBNode_[calleeCFG->exit_] = bbNode;
+
+    INSTRLIST_EACH(iter, callee->instrList_)
+    {
+        if ( iter == calleeExitLabel || typeid(*iter->value_) != typeid(LabelInstr) )
+            continue;
+
+        BasicBlock* bb = calleeCFG->labelNode2BBNode_[iter]->value_;
+        BBNode* newNode = cfg->insert( new BasicBlock(
+                    src2dstLabel_[bb->begin_], src2dstLabel_[bb->end_]) );
+        newNode->value_->fixPointers();
+
+        cfg->labelNode2BBNode_[ newNode->value_->begin_ ] = newNode;
+        src2dstBBNode_[ calleeCFG->labelNode2BBNode_[iter] ] = newNode;
+    }
+
+    topNode->value_->end_ = src2dstLabel_[calleeCFG->entry_->value_->begin_];
+    topNode->value_->fixPointers();
+    bbNode->value_->fixPointers();
+
+    /*
+     * wire the basic blocks -- keep the order of the preds since phi
+     * functions rely on it
+     */
+
+    for (BBNode2BBNode::iterator iter = src2dstBBNode_.begin(); iter != src2dstBBNode_.end(); ++iter)
+    {
+        BBNode* src = iter->first;
+        BBNode* dst = iter->second;
+
+        if (src == calleeCFG->exit_)
+            continue;
+
+        CFG_RELATIVES_EACH(succIter, src->succ_)
+            dst->succ_.append( src2dstBBNode_[succIter->value_] );
+
+        CFG_RELATIVES_EACH(predIter, src->pred_)
+            dst->pred_.append( src2dstBBNode_[predIter->value_] );
+    }
+
+    BBNode* entryNode = src2dstBBNode_[calleeCFG->entry_];
+    swiftAssert( entryNode->pred_.empty(), "the callee's entry must not have preds" );
+    topNode->link(entryNode);
+
+    CFG_RELATIVES_EACH(predIter, calleeCFG->exit_->pred_)
+        bbNode->pred_.append( src2dstBBNode_[predIter->value_] );
+
+    /*
+     * fix jumps and phi functions
+     */
+
+    for (BBNode2BBNode::iterator iter = src2dstBBNode_.begin(); iter != src2dstBBNode_.end(); ++iter)
+    {
+        if (iter->first == calleeCFG->exit_)
+            continue;
+
+        BasicBlock* bb = iter->second->value_;
+
+        for (InstrNode* instrIter = bb->firstPhi_; instrIter != bb->firstOrdinary_; instrIter = instrIter->next())
+        {
+            PhiInstr* phi = (PhiInstr*) instrIter->value_;
+
+            for (size_t i = 0; i < phi->arg_.size(); ++i)
+                phi->sourceBBs_[i] = src2dstBBNode_[ phi->sourceBBs_[i] ];
+        }
+
+        JumpInstr* ji = dynamic_cast<JumpInstr*>( bb->end_->prev()->value_ );
+        if (ji)
+        {
+            for (size_t i = 0; i < ji->numTargets_; ++i)
+                ji->bbTargets_[i] = cfg->labelNode2BBNode_[ ji->instrTargets_[i] ];
+        }
+    }
+}
+
+Var* Inliner::cloneVar(Var* var)
+{
+    Var2Var::iterator iter = src2dstVar_.find(var);
+
+    if ( iter != src2dstVar_.end() )
+        return iter->second;
+
+    Var* newVar = caller_->cloneNewSSA(var);
+    src2dstVar_[var] = newVar;
+
+    return newVar;
+}
+
+Op* Inliner::cloneOp(Op* op)
+{
+    if ( Var* var = dynamic_cast<Var*>(op) )
+        return cloneVar(var);
+
+    if ( Const* _const = dynamic_cast<Const*>(op) )
+    {
+        Const* newConst = caller_->newConst(_const->type_, _const->numBoxElems_);
+
+        for (size_t i = 0; i < _const->numBoxElems_; ++i)
+            newConst->boxes_[i] = _const->boxes_[i];
+
+        return newConst;
+    }
+
+    swiftAssert( typeid(*op) == typeid(Undef), "must be an Undef here" );
+
+    return caller_->newUndef(op->type_);
+}
+
+InstrBase* Inliner::cloneInstr(InstrBase* instr)
+{
+    InstrBase* newInstr;
+
+    if ( typeid(*instr) == typeid(PhiInstr) )
+    {
+        PhiInstr* phi = (PhiInstr*) instr;
+        PhiInstr* newPhi = new PhiInstr( phi->result(), phi->arg_.size() );
+
+        // remember src BBNode and substitute it later
+        for (size_t i = 0; i < phi->arg_.size(); ++i)
+        {
+            newPhi->arg_[i] = phi->arg_[i];
+            newPhi->sourceBBs_[i] = phi->sourceBBs_[i];
+        }
+
+        newInstr = newPhi;
+    }
+    else if ( typeid(*instr) == typeid(AssignInstr) )
+        newInstr = new AssignInstr( *(AssignInstr*) instr );
+    else if ( typeid(*instr) == typeid(Cast) )
+        newInstr = new Cast( *(Cast*) instr );
+    else if ( typeid(*instr) == typeid(NOP) )
+        newInstr = new NOP( *(NOP*) instr );
+    else if ( typeid(*instr) == typeid(Pack) )
+        newInstr = new Pack( *(Pack*) instr );
+    else if ( typeid(*instr) == typeid(Unpack) )
+        newInstr = new Unpack( *(Unpack*) instr );
+    else if ( typeid(*instr) == typeid(CallInstr) )
+        newInstr = new CallInstr( *(CallInstr*) instr );
+    else if ( typeid(*instr) == typeid(Malloc) )
+        newInstr = new Malloc( *(Malloc*) instr );
+    else if ( typeid(*instr) == typeid(Free) )
+        newInstr = new Free( *(Free*) instr );
+    else if ( typeid(*instr) == typeid(Memcpy) )
+        newInstr = new Memcpy( *(Memcpy*) instr );
+    else if ( typeid(*instr) == typeid(GotoInstr) )
+    {
+        GotoInstr* gi = new GotoInstr( *(GotoInstr*) instr );
+        gi->instrTargets_[0] = src2dstLabel_[ gi->instrTargets_[0] ];
+        newInstr = gi;
+    }
+    else if ( typeid(*instr) == typeid(BranchInstr) )
+    {
+        BranchInstr* bi = new BranchInstr( *(BranchInstr*) instr );
+        bi->instrTargets_[BranchInstr::TRUE_TARGET] =
+            src2dstLabel_[ bi->instrTargets_[BranchInstr::TRUE_TARGET] ];
+        bi->instrTargets_[BranchInstr::FALSE_TARGET] =
+            src2dstLabel_[ bi->instrTargets_[BranchInstr::FALSE_TARGET] ];
+        newInstr = bi;
+    }
+    else if ( typeid(*instr) == typeid(Load) )
+    {
+        Load* load = new Load( *(Load*) instr );
+        load->offset_ = load->offset_ ? load->offset_->clone() : 0;
+        newInstr = load;
+    }
+    else if ( typeid(*instr) == typeid(LoadPtr) )
+    {
+        LoadPtr* loadPtr = new LoadPtr( *(LoadPtr*) instr );
+        loadPtr->offset_ = loadPtr->offset_ ? loadPtr->offset_->clone() : 0;
+        newInstr = loadPtr;
+    }
+    else if ( typeid(*instr) == typeid(Store) )
+    {
+        Store* store = new Store( *(Store*) instr );
+        store->offset_ = store->offset_ ? store->offset_->clone() : 0;
+        newInstr = store;
+    }
+    else
+    {
+        swiftAssert(false, "unreachable code");
+        return 0;
+    }
+
+    newInstr->liveIn_.clear();
+    newInstr->liveOut_.clear();
+
+    // substitute all vars
+    for (size_t i = 0; i < newInstr->res_.size(); ++i)
+    {
+        Var* var = cloneVar(newInstr->res_[i].var_);
+        newInstr->res_[i].var_ = var;
+        newInstr->res_[i].oldVarNr_ = var->varNr_;
+    }
+
+    for (size_t i = 0; i < newInstr->arg_.size(); ++i)
+        newInstr->arg_[i].op_ = cloneOp(newInstr->arg_[i].op_);
+
+    return newInstr;
+}
+
+size_t Inliner::calcSize(Function* function)
+{
+    size_t result = 0;
+
+    INSTRLIST_EACH(iter, function->instrList_)
+    {
+        InstrBase* instr = iter->value_;
+
+        if (   typeid(*instr) != typeid(LabelInstr)
+            && typeid(*instr) != typeid(SetParams)
+            && typeid(*instr) != typeid(SetResults) )
+        {
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+} // namespace me
@@ -0,0 +1,130 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ME_INLINER_H
+#define ME_INLINER_H
+
+#include <vector>
+
+#include "utils/map.h"
+
+#include "me/forward.h"
+#include "me/functab.h"
+
+namespace me {
+
+/**
+ * @brief Inlines calls of small functions.
+ *
+ * All functions must already be in SSA form. Calls are processed in post
+ * order of the call graph so a callee has already got its own calls inlined
+ * when it is spliced into its callers. Recursive calls are never inlined.
+ *
+ * The basic block of a call is split at the call and a copy of the callee's
+ * CFG is put in between. Each var of the callee gets a fresh SSA var in the
+ * caller. The params and the results are connected via copies so the caller
+ * stays in SSA form.
+ */
+class Inliner
+{
+public:
+
+    /*
+     * constructor
+     */
+
+    Inliner(FunctionTable* functab);
+
+    /*
+     * further methods
+     */
+
+    void process();
+
+private:
+
+    enum
+    {
+        /// Size of a call in instructions excluding params and results.
+        CALL_COST = 8,
+
+        /// A callee may be this many times larger than the call it replaces.
+        GROWTH_FACTOR = 2,
+
+        /**
+         * Calls in functions which get vectorized are inlined up to this size
+         * since a call cannot be vectorized.
+         */
+        MAX_SIMD_CALLEE_SIZE = 256,
+
+        /// Stop inlining into a caller if it reaches this size.
+        MAX_CALLER_SIZE = 4096
+    };
+
+    /// Inlines all calls worth inlining into \p caller.
+    void inlineCalls(Function* caller);
+
+    /// Returns the Function called by \p call or 0 if it is unknown.
+    Function* findCallee(CallInstr* call);
+
+    /// Implements the cost model.
+    bool isWorthInlining(Function* caller, size_t callerSize,
+            Function* callee, CallInstr* call);
+
+    /// Splices \p callee into \a caller_ in place of \p callNode.
+    void inlineCall(InstrNode* callNode, Function* callee);
+
+    Var* cloneVar(Var* var);
+    Op* cloneOp(Op* op);
+    InstrBase* cloneInstr(InstrBase* instr);
+
+    /// Counts the instructions of \p function which make up its size.
+    static size_t calcSize(Function* function);
+
+    /*
+     * data
+     */
+
+    FunctionTable* functab_;
+
+    enum State
+    {
+        IN_PROGRESS,
+        DONE
+    };
+
+    typedef Map<Function*, State> States;
+    States states_;
+
+    /// The function which is currently processed.
+    Function* caller_;
+
+    typedef Map<Var*, Var*> Var2Var;
+    Var2Var src2dstVar_;
+
+    typedef Map<InstrNode*, InstrNode*> Label2Label;
+    Label2Label src2dstLabel_;
+
+    typedef Map<BBNode*, BBNode*> BBNode2BBNode;
+    BBNode2BBNode src2dstBBNode_;
+};
+
+} // namespace me
+
+#endif // ME_INLINER_H
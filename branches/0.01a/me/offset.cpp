@@ -42,6 +42,14 @@ ArrayOffset* ArrayOffset::toSimd() const
     return 0;
 }
 
+ArrayOffset* ArrayOffset::clone() const
+{
+    ArrayOffset* offset = new ArrayOffset(index_);
+    offset->next_ = next_ ? next_->clone() : 0;
+
+    return offset;
+}
+
 std::string ArrayOffset::toString() const
 {
     std::ostringstream oss;
@@ -80,6 +88,14 @@ StructOffset* StructOffset::toSimd() const
     return new StructOffset((Struct*) struct_->vectorized_, member_->vectorized_);
 }
 
+StructOffset* StructOffset::clone() const
+{
+    StructOffset* offset = new StructOffset(struct_, member_);
+    offset->next_ = next_ ? next_->clone() : 0;
+
+    return offset;
+}
+
 std::string StructOffset::toString() const
 {
     std::ostringstream oss;
@@ -32,6 +32,7 @@ struct Offset
 
     virtual size_t getOffset() const = 0;
     virtual Offset* toSimd() const = 0;
+    virtual Offset* clone() const = 0;
     virtual std::string toString() const = 0;
 };
 
@@ -53,6 +54,7 @@ public:
 
     virtual size_t getOffset() const;
     virtual ArrayOffset* toSimd() const;
+    virtual ArrayOffset* clone() const;
     virtual std::string toString() const;
 
 private:
@@ -78,6 +80,7 @@ struct StructOffset : public Offset
 
     virtual size_t getOffset() const;
     virtual StructOffset* toSimd() const;
+    virtual StructOffset* clone() const;
     virtual std::string toString() const;
 };
 
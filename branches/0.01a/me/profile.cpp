@@ -0,0 +1,187 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "me/profile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <typeinfo>
+
+#include "me/cfg.h"
+#include "me/functab.h"
+
+namespace me {
+
+Profile* profile = 0;
+
+/*
+ * constructor
+ */
+
+Profile::Profile(Mode mode, const std::string& filename)
+    : mode_(mode)
+    , filename_(filename)
+{}
+
+/*
+ * further methods
+ */
+
+Profile::Mode Profile::mode() const
+{
+    return mode_;
+}
+
+const std::string& Profile::filename() const
+{
+    return filename_;
+}
+
+void Profile::init(FunctionTable* functab)
+{
+    if (mode_ == NONE)
+        return;
+
+    int counter = 0;
+
+    // for each function which is emitted
+    for (FunctionTable::FunctionMap::iterator iter = functab->functions_.begin(); iter != functab->functions_.end(); ++iter)
+    {
+        Function* function = iter->second;
+
+        if ( function->ignore() )
+            continue;
+
+        CFG* cfg = function->cfg_;
+
+        // for each basic block except the exit
+        INSTRLIST_EACH(instrIter, function->instrList_)
+        {
+            if ( typeid(*instrIter->value_) != typeid(LabelInstr) )
+                continue;
+
+            if ( !cfg->labelNode2BBNode_.contains(instrIter)
+                    || cfg->labelNode2BBNode_[instrIter] == cfg->exit_ )
+                continue;
+
+            label2Index_[instrIter] = counter++;
+        }
+    }
+
+    if (mode_ != USE || counter == 0)
+        return;
+
+    std::ifstream ifs( filename_.c_str(), std::ios::in | std::ios::binary );
+    if ( !ifs.is_open() )
+    {
+        std::cerr << "warning: could not open profile '" << filename_ << "'" << std::endl;
+        return;
+    }
+
+    counts_.resize(counter);
+    ifs.read( (char*) &counts_[0], counter * sizeof(uint64_t) );
+
+    // the profile must exactly match the number of counters
+    if ( !ifs || ifs.peek() != EOF )
+    {
+        std::cerr << "warning: profile '" << filename_
+                  << "' does not match the program and is ignored" << std::endl;
+        counts_.clear();
+    }
+}
+
+size_t Profile::numCounters() const
+{
+    return label2Index_.size();
+}
+
+int Profile::counterIndex(InstrNode* labelNode) const
+{
+    Label2Index::const_iterator iter = label2Index_.find(labelNode);
+
+    return iter == label2Index_.end() ? -1 : iter->second;
+}
+
+bool Profile::hasCounts() const
+{
+    return !counts_.empty();
+}
+
+uint64_t Profile::count(BBNode* bbNode) const
+{
+    if ( counts_.empty() )
+        return 0;
+
+    /*
+     * Basic blocks which have been inserted after numbering do not have a
+     * counter. These are split off from a counted one so follow the unique
+     * predecessor or successor.
+     */
+    for (size_t i = 0; i < label2Index_.size(); ++i)
+    {
+        int index = counterIndex(bbNode->value_->begin_);
+        if (index != -1)
+            return counts_[index];
+
+        if ( bbNode->pred_.size() == 1 && bbNode->pred_.first()->value_->succ_.size() == 1 )
+            bbNode = bbNode->pred_.first()->value_;
+        else if ( bbNode->succ_.size() == 1 && bbNode->succ_.first()->value_->pred_.size() == 1 )
+            bbNode = bbNode->succ_.first()->value_;
+        else
+            return 0;
+    }
+
+    return 0;
+}
+
+uint64_t Profile::count(BBNode* from, BBNode* to) const
+{
+    if (from->succ_.size() == 1)
+        return count(from);
+
+    if (to->pred_.size() == 1)
+        return count(to);
+
+    // there are no critical edges so this is just a guess
+    return std::min( count(from), count(to) );
+}
+
+int Profile::weight(Function* function, BBNode* bbNode) const
+{
+    return scale( function, count(bbNode) );
+}
+
+int Profile::weight(Function* function, BBNode* from, BBNode* to) const
+{
+    return scale( function, count(from, to) );
+}
+
+int Profile::scale(Function* function, uint64_t count) const
+{
+    if ( counts_.empty() )
+        return 0;
+
+    uint64_t calls = std::max( this->count(function->cfg_->entry_), uint64_t(1) );
+    uint64_t result = (count * WEIGHT_SCALE) / calls;
+
+    return result > MAX_WEIGHT ? int(MAX_WEIGHT) : int(result);
+}
+
+} // namespace me
@@ -0,0 +1,144 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef ME_PROFILE_H
+#define ME_PROFILE_H
+
+#include <string>
+#include <vector>
+
+#include "utils/map.h"
+#include "utils/types.h"
+
+#include "me/forward.h"
+
+namespace me {
+
+//------------------------------------------------------------------------------
+
+/*
+ * forward declarations
+ */
+struct FunctionTable;
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Execution counts of the basic blocks of a previous run.
+ *
+ * In GENERATE mode the back-end emits a counter for each basic block which is
+ * incremented whenever the basic block is entered. The program writes all
+ * counters to the profile file on exit. In USE mode these counters are read
+ * again and serve as weights for the block layout, the spiller and the
+ * coalescing.
+ *
+ * The counters are numbered in the order of the functions and in the order of
+ * the basic blocks within each function right after the middle-end has been
+ * built up. Thus the profile only fits to the very same program.
+ *
+ * Edges are not counted: Since there are no critical edges each edge is
+ * either the only outgoing edge of its source or the only incoming edge of
+ * its target.
+ */
+class Profile
+{
+public:
+
+    enum Mode
+    {
+        NONE,
+        GENERATE,
+        USE
+    };
+
+    /*
+     * constructor
+     */
+
+    Profile(Mode mode, const std::string& filename);
+
+    /*
+     * further methods
+     */
+
+    Mode mode() const;
+    const std::string& filename() const;
+
+    /// Numbers all basic blocks and reads the profile file in USE mode.
+    void init(FunctionTable* functab);
+
+    /// Returns the number of counters needed for the instrumentation.
+    size_t numCounters() const;
+
+    /**
+     * @brief Returns the counter of the basic block starting with \p labelNode.
+     *
+     * @return The index of the counter or -1 if this basic block is not counted.
+     */
+    int counterIndex(InstrNode* labelNode) const;
+
+    /// Returns whether execution counts are available.
+    bool hasCounts() const;
+
+    /// Returns how often \p bbNode has been executed.
+    uint64_t count(BBNode* bbNode) const;
+
+    /// Returns how often the edge \p from -> \p to has been taken.
+    uint64_t count(BBNode* from, BBNode* to) const;
+
+    /**
+     * @brief Returns how often \p bbNode is executed per call of \p function
+     * scaled by \a WEIGHT_SCALE.
+     *
+     * The result is saturated at \a MAX_WEIGHT and 0 if no counts are
+     * available.
+     */
+    int weight(Function* function, BBNode* bbNode) const;
+
+    /// Returns the weight of the edge \p from -> \p to -- see above.
+    int weight(Function* function, BBNode* from, BBNode* to) const;
+
+    enum
+    {
+        WEIGHT_SCALE = 10,
+        MAX_WEIGHT = 1000000
+    };
+
+private:
+
+    int scale(Function* function, uint64_t count) const;
+
+    /*
+     * data
+     */
+
+    Mode mode_;
+    std::string filename_;
+
+    typedef Map<InstrNode*, int> Label2Index;
+    Label2Index label2Index_;
+
+    std::vector<uint64_t> counts_;
+};
+
+extern Profile* profile;
+
+} // namespace me
+
+#endif // ME_PROFILE_H
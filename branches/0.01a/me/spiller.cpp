@@ -25,6 +25,7 @@
 
 #include "me/cfg.h"
 #include "me/functab.h"
+#include "me/profile.h"
 
 namespace me {
 
@@ -46,6 +47,20 @@ inline void subOne(int& i)
         --i;
 }
 
+/// Distance which is added for each loop which is left on the way to the next use.
+inline int loopExitPenalty()
+{
+    return 100000;
+}
+
+inline int addDistance(int dist, int inc)
+{
+    if ( dist == infinity() || dist >= infinity() - inc )
+        return infinity();
+
+    return dist + inc;
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -74,6 +89,8 @@ Spiller::~Spiller()
 
 void Spiller::process()
 {
+    calcLoopDepths();
+
     spill(cfg_->entry_);
     combine(cfg_->entry_);
 
@@ -180,6 +197,49 @@ void Spiller::process()
     }
 }
 
+/*
+ * loop analysis
+ */
+
+void Spiller::calcLoopDepths()
+{
+    cfg_->findLoops();
+
+    // each basic block gets the number of loops it is part of
+    for (Loops::iterator iter = cfg_->loops_.begin(); iter != cfg_->loops_.end(); ++iter)
+    {
+        Loop* loop = iter->second;
+
+        BBSET_EACH(bbIter, loop->body_)
+            ++loopDepths_[*bbIter];
+    }
+}
+
+int Spiller::loopDepth(BBNode* bbNode) const
+{
+    LoopDepths::const_iterator iter = loopDepths_.find(bbNode);
+
+    if ( iter == loopDepths_.end() )
+        return 0; // not part of any loop
+
+    return iter->second;
+}
+
+int Spiller::exitPenalty(BBNode* from, BBNode* to) const
+{
+    int numExits = loopDepth(from) - loopDepth(to);
+    int penalty = numExits > 0 ? numExits * loopExitPenalty() : 0;
+
+    // a cold edge is as bad as leaving a loop
+    if ( profile && profile->hasCounts()
+            && profile->count(from) != 0 && profile->count(from, to) == 0 )
+    {
+        penalty += loopExitPenalty();
+    }
+
+    return penalty;
+}
+
 /*
  * insertion of spills and reloads
  */
@@ -187,6 +247,31 @@ void Spiller::process()
 Var* Spiller::insertSpill(BBNode* bbNode, Var* var, InstrNode* appendTo)
 {
     swiftAssert( var->typeCheck(typeMask_), "wrong var type" );
+
+    /*
+     * Is the spill placed inside a loop which does not contain var's definition?
+     * Then spill var directly behind its definition -- phis are not
+     * considered since they may be phi-spilled later on.
+     */
+    BBNode* defNode = var->def_.bbNode_;
+    InstrNode* defInstrNode = var->def_.instrNode_;
+
+    if (    defNode 
+         && typeid(*defInstrNode->value_) != typeid(PhiInstr) 
+         && loopDepth(bbNode) > loopDepth(defNode) )
+    {
+        SpillMap::iterator iter = defSpills_.find(var);
+
+        // is there already a spill behind the definition?
+        if ( iter != defSpills_.end() )
+            return iter->second;
+
+        Var* mem = insertSpill(defNode, var, defInstrNode);
+        defSpills_[var] = mem;
+
+        return mem;
+    }
+
     BasicBlock* bb = bbNode->value_;
 
     // create a new memory location
@@ -281,6 +366,7 @@ int Spiller::distance(BBNode* bbNode, Var* var, InstrNode* instrNode)
             walked.insert(target);
 
             int dist = distanceHere(target, var, ji->instrTargets_[i], walked);
+            dist = addDistance( dist, exitPenalty(bbNode, target) );
             min = (dist < min) ? dist : min;
         }
 
@@ -338,7 +424,9 @@ int Spiller::distanceRec(BBNode* bbNode, Var* var, InstrNode* instrNode, BBSet w
             else
             {
                 walked.insert(target);
-                results[i] = distanceHere( target, var, ji->instrTargets_[i], walked );
+                results[i] = addDistance( 
+                        distanceHere(target, var, ji->instrTargets_[i], walked), 
+                        exitPenalty(bbNode, target) );
             }
         }
 
@@ -362,7 +450,9 @@ int Spiller::distanceRec(BBNode* bbNode, Var* var, InstrNode* instrNode, BBSet w
         else
         {
             walked.insert(succ);
-            result = distanceHere( succ, var, instrNode->next(), walked );
+            result = addDistance( 
+                    distanceHere(succ, var, instrNode->next(), walked), 
+                    exitPenalty(bbNode, succ) );
         }
 
     }
@@ -380,7 +470,7 @@ int Spiller::distanceRec(BBNode* bbNode, Var* var, InstrNode* instrNode, BBSet w
         inc = 0;
 
     // add up the distance and do not calculate around
-    result = (result == infinity()) ? infinity() : result + inc;
+    result = addDistance(result, inc);
 
     return result;
 }
@@ -874,8 +964,10 @@ void Spiller::insertSpillIfNecessarry(Var* var, BBNode* bbNode)
     if ( typeid(*appendTo->value_) == typeid(PhiInstr) )
     {
         appendTo = var->def_.bbNode_->value_->firstOrdinary_->prev();
+        insertSpill(var->def_.bbNode_, var, appendTo);
     }
-    insertSpill(var->def_.bbNode_, var, appendTo);
+    else
+        defSpills_[var] = insertSpill(var->def_.bbNode_, var, appendTo);
 }
 
 } // namespace me
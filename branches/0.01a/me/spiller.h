@@ -33,6 +33,10 @@ namespace me {
  *
  * This class in independet from any architecture and can be adopted by the
  * back-end.
+ *
+ * The distances used by Belady's algorithm are weighted with the loop nesting
+ * depth so reloads are placed in front of loops and spills of vars defined
+ * outside of a loop are hoisted behind their definitions.
  */
 class Spiller : public CodePass
 {
@@ -116,6 +120,21 @@ private:
 
     typedef std::vector<DefUse> LaterReloads;
     LaterReloads laterReloads_;
+
+    /// BBNode -> number of loops this basic block belongs to
+    typedef Map<BBNode*, int> LoopDepths;
+
+    /**
+     * Knows for each basic block its loop nesting depth. 
+     * Basic blocks which are not part of any loop are not inserted here.
+     */
+    LoopDepths loopDepths_;
+
+    /**
+     * Knows for each var which is spilled directly behind its definition the
+     * memory var it is spilled to.
+     */
+    SpillMap defSpills_;
     
 public:
 
@@ -138,6 +157,29 @@ public:
 
 private:
 
+    /*
+     * loop analysis
+     */
+
+    /// Calculates \a loopDepths_ with the help of CFG::loops_.
+    void calcLoopDepths();
+
+    /// Returns the loop nesting depth of \p bbNode.
+    int loopDepth(BBNode* bbNode) const;
+
+    /** 
+     * @brief Returns the penalty for leaving loops along the edge \p from -> \p to.
+     *
+     * This makes uses behind a loop exit appear farther away than uses inside
+     * the loop. Thus vars which are used inside a loop are preferred to be
+     * kept in real registers and reloads are placed in front of the loop
+     * instead of inside it.
+     *
+     * If a \a Profile is available, edges which have never been taken although
+     * \p from has been executed are penalized in the same way.
+     */
+    int exitPenalty(BBNode* from, BBNode* to) const;
+
     /*
      * insertion of spills and reloads
      */
@@ -149,6 +191,11 @@ private:
      * @param bbNode Basic block of the to be created spill.
      * @param var Var to be spilled.
      * @param appendTo Append to which instruction?
+     *
+     * If \p bbNode is nested deeper in loops than the definition of \p var
+     * the spill is placed directly behind the definition instead. Since \p
+     * var is in SSA form this is always valid and executes the spill less
+     * often.
      * 
      * @return The newly created memory pseudo register where \p reg is spilled
      * to.
@@ -171,7 +171,8 @@ void AtomicAggregate::analyze()
 
 AtomicAggregate* AtomicAggregate::vectorize(int& simdLength)
 {
-    simdLength = arch->getSimdWidth() / size_;
+    // 8 bit types yield 16 elements, 16 bit types 8 elements and so on
+    simdLength = arch->getSimdWidth() / Op::sizeOf(type_);
 
     AtomicAggregate* aggregate = new AtomicAggregate( Op::toSimd(type_, simdLength) );
     aggregate->simdLength_ = simdLength;
@@ -199,7 +200,8 @@ void ArrayAggregate::analyze()
 
 ArrayAggregate* ArrayAggregate::vectorize(int& simdLength)
 {
-    simdLength = arch->getSimdWidth() / size_;
+    // the length depends on the element type and not on the size of the whole array
+    simdLength = arch->getSimdWidth() / Op::sizeOf(type_);
 
     ArrayAggregate* aggregate = new ArrayAggregate( Op::toSimd(type_, simdLength), num_);
     aggregate->simdLength_ = simdLength;
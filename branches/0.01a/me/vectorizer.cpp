@@ -20,9 +20,12 @@
 
 #include "me/vectorizer.h"
 
+#include "me/arch.h"
 #include "me/cfg.h"
 #include "me/defusecalc.h"
 #include "me/functab.h"
+#include "me/offset.h"
+#include "me/struct.h"
 
 namespace me {
 
@@ -34,8 +37,10 @@ Vectorizer::Vectorizer(Function* function)
     : CodePass(function)
     , simdFunction_( functab->insertFunction(
                 new std::string(*function->id_ + "simd"), false) )
-    , simdLength_(4) // TODO
-{}
+    , unsupported_(0)
+{
+    simdLength_ = calcSimdLength();
+}
 
 /*
  * virtual methods
@@ -43,6 +48,9 @@ Vectorizer::Vectorizer(Function* function)
 
 void Vectorizer::process()
 {
+    if (unsupported_)
+        return;
+
     // map function_->functionEpilogue_ to simdFunction_->functionEpilogue_
     src2dstLabel_[function_->functionEpilogue_] = simdFunction_->functionEpilogue_;
 
@@ -108,6 +116,8 @@ void Vectorizer::process()
 
     // find and eliminate all if-else clauses
     eliminateIfElseClauses(simdFunction_->cfg_->entry_);
+    if (unsupported_)
+        return;
 
     // HACK this should be superfluous when there is a good graph implementation
     simdFunction_->cfg_->entry_->postOrderIndex_ = 0;     
@@ -120,6 +130,21 @@ void Vectorizer::process()
     DefUseCalc(simdFunction_).process();
 
     vectorizeLoops(simdFunction_->cfg_->entry_);
+    if (unsupported_)
+        return;
+
+    if ( !deadBBs_.empty() )
+    {
+        // breaks have been removed, so recompute dominance stuff
+        eraseDeadBBs();
+
+        // HACK this should be superfluous when there is a good graph implementation
+        simdFunction_->cfg_->entry_->postOrderIndex_ = 0;     
+
+        simdFunction_->cfg_->calcPostOrder(simdFunction_->cfg_->entry_);
+        simdFunction_->cfg_->calcDomTree();
+        simdFunction_->cfg_->calcDomFrontier();
+    }
 
     VDUMAP_EACH(iter, vduMap_)
     {
@@ -145,8 +170,102 @@ Function* Vectorizer::function()
 
 int Vectorizer::getSimdLength()
 {
-    // TODO
-    return 4;
+    return simdLength_;
+}
+
+const char* Vectorizer::getUnsupported() const
+{
+    return unsupported_;
+}
+
+// helper
+namespace {
+
+int offset2SimdLength(const Offset* offset)
+{
+    const StructOffset* structOffset = dynamic_cast<const StructOffset*>(offset);
+    if (!structOffset)
+        return 0;
+
+    Aggregate* vectorized = structOffset->struct_->vectorized_;
+    if (!vectorized)
+        return 0;
+
+    int simdLength = vectorized->getSimdLength();
+
+    return simdLength > 0 ? simdLength : 0;
+}
+
+}
+
+int Vectorizer::calcSimdLength()
+{
+    int simdLength = 0;
+
+    /*
+     * collect the simd lengths of all vectorized aggregates accessed in function_
+     */
+
+    INSTRLIST_EACH(iter, cfg_->instrList_)
+    {
+        InstrBase* instr = iter->value_;
+        int current;
+
+        if ( typeid(*instr) == typeid(Load) )
+            current = offset2SimdLength( ((Load*) instr)->offset_ );
+        else if ( typeid(*instr) == typeid(LoadPtr) )
+            current = offset2SimdLength( ((LoadPtr*) instr)->offset_ );
+        else if ( typeid(*instr) == typeid(Store) )
+            current = offset2SimdLength( ((Store*) instr)->offset_ );
+        else
+            continue;
+
+        if (current == 0)
+            continue;
+
+        // one function cannot step through aggregates of different lengths
+        if ( simdLength != 0 && simdLength != current )
+        {
+            setUnsupported("vectorized types with different simd lengths");
+            break;
+        }
+
+        simdLength = current;
+    }
+
+    if (simdLength)
+        return simdLength;
+
+    /*
+     * no vectorized aggregate found 
+     * -> take the element size of the vectorizable types of this function
+     */
+
+    int size = 0;
+    VARMAP_EACH(iter, function_->vars_)
+    {
+        Var* var = iter->second;
+
+        if ( !var->typeCheck(Op::VECTORIZABLE) )
+            continue;
+
+        int current = Op::sizeOf(var->type_);
+
+        // all vectorized types must get the same number of lanes
+        if ( size != 0 && size != current )
+        {
+            setUnsupported("vectorizable types of different sizes");
+            return 0;
+        }
+
+        size = current;
+    }
+
+    // take 32 bit types if nothing has been found
+    if (size == 0)
+        size = 4;
+
+    return arch->getSimdWidth() / size;
 }
 
 void Vectorizer::eliminateIfElseClauses(BBNode* bbNode)
@@ -164,6 +283,9 @@ void Vectorizer::eliminateIfElseClauses(BBNode* bbNode)
         eliminateIfElseClauses(current);
     }
 
+    if (unsupported_)
+        return;
+
     // this is the node where the control flow merges after the split at bb
     BBNode* nextNode = simdFunction_->cfg_->isIfElseClause(bbNode);
     if (!nextNode)
@@ -203,6 +325,37 @@ void Vectorizer::eliminateIfElseClauses(BBNode* bbNode)
     BasicBlock* lastIf   = lastIfNode->value_;
     BasicBlock* lastElse = lastElseNode->value_;
 
+    /*
+     * the values merged in next must live in regs
+     */
+    next->fixPointers();
+    for (InstrNode* iter = next->firstPhi_; iter != next->firstOrdinary_; iter = iter->next_)
+    {
+        PhiInstr* phi = (PhiInstr*) iter->value_;
+
+        if (    typeid(*phi->arg_[0].op_) != typeid(Reg)
+             || typeid(*phi->arg_[1].op_) != typeid(Reg)
+             || typeid(*phi->result())    != typeid(Reg) )
+        {
+            setUnsupported("if-else clauses which merge values not held in registers");
+            return;
+        }
+    }
+
+    /*
+     * loops inside the clauses may only be entered by the lanes of their clause
+     */
+    Loops& loops = simdFunction_->cfg_->loops_;
+    for (Loops::iterator iter = loops.begin(); iter != loops.end(); ++iter)
+    {
+        BBNode* header = iter->first;
+
+        if ( simdFunction_->cfg_->dominates(ifChildNode, header) )
+            loopGuards_[header].push_back( Guard(branch->getOp(), false) );
+        else if ( simdFunction_->cfg_->dominates(elseChildNode, header) )
+            loopGuards_[header].push_back( Guard(branch->getOp(), true) );
+    }
+
     /*
      * We now have this situation:
      *
@@ -323,9 +476,6 @@ void Vectorizer::eliminateIfElseClauses(BBNode* bbNode)
         PhiInstr* phi = (PhiInstr*) iter->value_;
 
         swiftAssert( phi->arg_.size() == 2, "must exactly have two results" );
-        swiftAssert( typeid(*phi->arg_[0].op_) == typeid(Reg), "TODO" );
-        swiftAssert( typeid(*phi->arg_[1].op_) == typeid(Reg), "TODO" );
-        swiftAssert( typeid(*phi->result())    == typeid(Reg), "TODO" );
 
         Reg* ifReg; 
         Reg* elseReg; 
@@ -389,6 +539,35 @@ void Vectorizer::eliminateIfElseClauses(BBNode* bbNode)
     next->fixPointers();
 }
 
+// helpers
+namespace {
+
+/// The values which flow through a loop while its exits are evaluated.
+struct LoopState
+{
+    BBNode* bbNode_;    ///< these values are valid at the end of this basic block
+    Op* active_;        ///< lanes still running the loop
+    Op* broken_;        ///< lanes which have left the loop via a break
+    std::vector<Op*> carried_; ///< values carried out of the loop via the breaks
+};
+
+typedef std::vector<LoopState> LoopStates;
+
+/// Returns the state which is valid at the end of \p bbNode.
+const LoopState& stateAt(const LoopStates& states, CFG* cfg, BBNode* bbNode)
+{
+    // the last state whose basic block dominates bbNode is the valid one
+    for (size_t i = states.size() - 1; i > 0; --i)
+    {
+        if ( cfg->dominates(states[i].bbNode_, bbNode) )
+            return states[i];
+    }
+
+    return states[0];
+}
+
+}
+
 void Vectorizer::vectorizeLoops(BBNode* bbNode)
 {
     /*
@@ -397,6 +576,7 @@ void Vectorizer::vectorizeLoops(BBNode* bbNode)
      */
 
     BasicBlock* bb = bbNode->value_;
+    CFG* cfg = simdFunction_->cfg_;
 
     BBLIST_EACH(iter, bbNode->value_->domChildren_)
     {
@@ -404,29 +584,95 @@ void Vectorizer::vectorizeLoops(BBNode* bbNode)
         vectorizeLoops(current);
     }
 
+    if (unsupported_)
+        return;
+
     // is this a loop?
-    Loops::iterator loopIter = simdFunction_->cfg_->loops_.find(bbNode);
-    if ( loopIter == simdFunction_->cfg_->loops_.end() )
+    Loops::iterator loopIter = cfg->loops_.find(bbNode);
+    if ( loopIter == cfg->loops_.end() )
         return;
 
     Loop* loop = loopIter->second;
     swiftAssert(bbNode == loop->header_, "must be the header");
 
-    //std::cout << "header: " << bb->name() << std::endl;
+    if ( loop->backEdges_.size() != 1 )
+    {
+        setUnsupported("loops with more than one back edge");
+        return;
+    }
+
+    BBNode* lastNode = loop->backEdges_[0].from_;
+    BasicBlock* lastBB = lastNode->value_;
+
+    if ( bbNode->pred_.size() != 2 )
+    {
+        setUnsupported("loops which are entered from more than one place");
+        return;
+    }
+
+    BBNode* preheaderNode = bbNode->pred_.first()->value_;
+    if (preheaderNode == lastNode)
+        preheaderNode = bbNode->pred_.last()->value_;
+
+    /*
+     * Find the main exit. This is the exit in the header or, if there is
+     * none, the one in the last basic block. All other exits are breaks.
+     * Each exit must be evaluated in each iteration.
+     */
+
+    std::vector<Edge> exits;
+    size_t mainIndex = loop->exitEdges_.size();
+
+    for (size_t i = 0; i < loop->exitEdges_.size(); ++i)
+    {
+        const Edge& edge = loop->exitEdges_[i];
+        if ( !cfg->dominates(edge.from_, lastNode) )
+        {
+            setUnsupported("loop exits which are not evaluated in each iteration");
+            return;
+        }
+
+        if ( edge.from_ == bbNode )
+            mainIndex = i;
+        else if ( edge.from_ == lastNode && mainIndex == loop->exitEdges_.size() )
+            mainIndex = i;
+
+        // keep exits sorted by dominance
+        std::vector<Edge>::iterator pos = exits.begin();
+        while ( pos != exits.end() && cfg->dominates(pos->from_, edge.from_) )
+            ++pos;
+        exits.insert(pos, edge);
+    }
+
+    swiftAssert( mainIndex != loop->exitEdges_.size(), "no main exit found" );
+    BBNode* branchBBNode = loop->exitEdges_[mainIndex].from_;
+    BBNode* mergeNode = cfg->findLoopMerge(bbNode);
+    if ( exits.size() > 1 )
+    {
+        if (!mergeNode)
+        {
+            setUnsupported("breaks which do not merge with the main loop exit");
+            return;
+        }
+
+        if ( mergeNode->pred_.size() != exits.size() )
+        {
+            setUnsupported("loop merges which are not only reached via the loop exits");
+            return;
+        }
 
-    //// for each back edge
-    //for (size_t i = 0; i < loop->backEdges_.size(); ++i)
-    //{
-        //std::cout << "back: " << loop->backEdges_[i].toString() << std::endl;
-    //}
+        for (size_t i = 0; i < exits.size(); ++i)
+        {
+            BasicBlock* breakBB = exits[i].to_->value_;
 
-    //// for each exit edge
-    //for (size_t i = 0; i < loop->exitEdges_.size(); ++i)
-    //{
-        //std::cout << "exitEdges_: " << loop->exitEdges_[i].toString() << std::endl;
-    //}
+            if ( exits[i].from_ != branchBBNode && breakBB->firstPhi_ != breakBB->end_ )
+            {
+                setUnsupported("breaks which execute instructions on the way out of the loop");
+                return;
+            }
+        }
+    }
 
-    BBNode* branchBBNode = loop->exitEdges_[0].from_;
     InstrNode* branchNode = branchBBNode->value_->end_->prev_;
     swiftAssert( typeid(*branchNode->value_) == typeid(BranchInstr),
             "must be a BranchInstr here" );
@@ -444,37 +690,157 @@ void Vectorizer::vectorizeLoops(BBNode* bbNode)
         swiftAssert( loop->body_.contains(branch->bbTargets_[BranchInstr::TRUE_TARGET]), 
                 "true-target must be in the loop" );
 
-    swiftAssert( loop->backEdges_.size() == 1, "TODO" );
-    BBNode* lastNode = loop->backEdges_[0].from_;
-    BasicBlock* lastBB = lastNode->value_;
+    if ( typeid(*branch->getOp()) != typeid(Reg) )
+    {
+        setUnsupported("loop conditions which are not held in a register");
+        return;
+    }
 
-    std::vector<InstrBase*> and_ToBeInserted;
-    std::vector<InstrBase*> andnToBeInserted;
-    std::vector<InstrBase*>   orToBeInserted;
-    std::vector<InstrBase*> copyToBeInserted;
+    Op::Type maskType = branch->getOp()->type_;
+
+    /*
+     * collect the phi functions which merge the values of the breaks
+     */
 
-    swiftAssert( typeid(*branch->getOp()) == typeid(Reg), "TODO" );
-    Reg* mask = (Reg*) branch->getOp();
+    std::vector<PhiInstr*> mergePhis;
+    std::vector<InstrNode*> mergePhiNodes;
 
-    if (branchBBNode != loop->header_)
+    if ( exits.size() > 1 )
     {
-        Const* falseConst = simdFunction_->newConst(mask->type_, simdLength_);
-        Box box;
-        box.uint64_ = 0xFFFFFFFFFFFFFFFFull; // set all bits
-        falseConst->broadcast(box);
+        BasicBlock* merge = mergeNode->value_;
 
-        AssignInstr* init = new AssignInstr('=', mask, falseConst);
-        InstrNode* initNode = simdFunction_->instrList_.insert(bb->firstOrdinary_->prev_, init);
-        bb->fixPointers();
+        for (InstrNode* iter = merge->firstPhi_; iter != merge->firstOrdinary_; iter = iter->next_)
+        {
+            swiftAssert( typeid(*iter->value_) == typeid(PhiInstr), 
+                    "must be a PhiInstr here" );
+            mergePhis.push_back( (PhiInstr*) iter->value_ );
+            mergePhiNodes.push_back(iter);
+        }
+    }
 
-        VarDefUse* vdu = new VarDefUse();
-        vdu->defs_.append( DefUse(mask, initNode, branchBBNode) ); // new def
-        vdu->defs_.append( DefUse(mask, mask->def_.instrNode_, mask->def_.bbNode_) ); // original def
-        vdu->uses_ = mask->uses_; // original uses
+    /*
+     * create the results of the phi functions in the header
+     */
+
+    LoopStates states(1);
+    states[0].bbNode_ = bbNode;
 
-        vduMap_[mask] = vdu;
+    Reg* activeReg = newSSAReg(maskType, "active");
+    Reg* brokenReg = newSSAReg(maskType, "broken");
+    states[0].active_ = activeReg;
+    states[0].broken_ = brokenReg;
+
+    std::vector<Reg*> carriedRegs;
+    for (size_t i = 0; i < mergePhis.size(); ++i)
+    {
+        carriedRegs.push_back( newSSAReg(mergePhis[i]->result()->type_, "carried") );
+        states[0].carried_.push_back( carriedRegs.back() );
     }
 
+    /*
+     * update the masks at each exit in dominance order
+     */
+
+    for (size_t i = 0; i < exits.size(); ++i)
+    {
+        BBNode* exitNode = exits[i].from_;
+        BasicBlock* exitBB = exitNode->value_;
+        swiftAssert( typeid(*exitBB->end_->prev_->value_) == typeid(BranchInstr),
+                "must be a BranchInstr here" );
+        BranchInstr* exitBranch = (BranchInstr*) exitBB->end_->prev_->value_;
+
+        LoopState state = states.back();
+        state.bbNode_ = exitNode;
+        Op* cond = exitBranch->getOp();
+
+        if ( exitNode == branchBBNode )
+        {
+            // active = active AND cond
+            Reg* newActive = newSSAReg(maskType, "active");
+            appendBeforeJump( exitNode, 
+                    new AssignInstr(AssignInstr::AND, newActive, state.active_, cond) );
+
+            // loop while any lane is active
+            exitBranch->arg_[0].op_ = newActive;
+            state.active_ = newActive;
+            states.push_back(state);
+
+            continue;
+        }
+
+        /*
+         * -> this is a break
+         */
+
+        BBNode* breakNode = exits[i].to_;
+        bool breakOnTrue = exitBranch->bbTargets_[BranchInstr::TRUE_TARGET] == breakNode;
+        size_t stayIndex = breakOnTrue ? BranchInstr::FALSE_TARGET : BranchInstr::TRUE_TARGET;
+
+        swiftAssert( breakNode->succ_.first()->value_ == mergeNode, 
+                "must lead to the merge" );
+
+        // find the phi args coming from this break
+        size_t breakIndex = 0;
+        CFG_RELATIVES_EACH(predIter, mergeNode->pred_)
+        {
+            if (predIter->value_ == breakNode)
+                break;
+
+            ++breakIndex;
+        }
+
+        // brk = active AND cond or active AND NOT cond respectively
+        Reg* brk = newSSAReg(maskType, "break");
+        if (breakOnTrue)
+            appendBeforeJump( exitNode, new AssignInstr(AssignInstr::AND, brk, state.active_, cond) );
+        else
+            appendBeforeJump( exitNode, new AssignInstr(AssignInstr::ANDN, brk, cond, state.active_) );
+
+        // active = active AND NOT brk
+        Reg* newActive = newSSAReg(maskType, "active");
+        appendBeforeJump( exitNode, 
+                new AssignInstr(AssignInstr::ANDN, newActive, brk, state.active_) );
+
+        // broken = broken OR brk
+        Reg* newBroken = newSSAReg(maskType, "broken");
+        appendBeforeJump( exitNode, 
+                new AssignInstr(AssignInstr::OR, newBroken, state.broken_, brk) );
+
+        // carry out the values of the breaking lanes
+        for (size_t j = 0; j < mergePhis.size(); ++j)
+        {
+            Reg* newCarried = newSSAReg( carriedRegs[j]->type_, "carried" );
+            insertBlend( exitBB->getLastNonJump(), newCarried, brk, 
+                    mergePhis[j]->arg_[breakIndex].op_, state.carried_[j] );
+            state.carried_[j] = newCarried;
+        }
+
+        state.active_ = newActive;
+        state.broken_ = newBroken;
+        states.push_back(state);
+
+        // substitute the branch with a goto to the target which stays in the loop
+        InstrNode* stayLabel = exitBranch->instrTargets_[stayIndex];
+        BBNode* stayNode = exitBranch->bbTargets_[stayIndex];
+        GotoInstr* gotoInstr = new GotoInstr(stayLabel);
+        gotoInstr->bbTargets_[0] = stayNode;
+
+        delete exitBB->end_->prev_->value_;
+        exitBB->end_->prev_->value_ = gotoInstr;
+
+        exitNode->succ_.erase( exitNode->succ_.find(breakNode) );
+        breakNode->pred_.erase( breakNode->pred_.find(exitNode) );
+        deadBBs_.insert(breakNode);
+
+        exitBB->fixPointers();
+    }
+
+    const LoopState& latchState = stateAt(states, cfg, lastNode);
+
+    /*
+     * blend all loop carried values with the final active mask
+     */
+
     // for each phi function in the loop header
     for (InstrNode* iter = bb->firstPhi_; iter != bb->firstOrdinary_; iter = iter->next_)
     {
@@ -485,16 +851,15 @@ void Vectorizer::vectorizeLoops(BBNode* bbNode)
         // get loop argument
         size_t sourceIndex;
         Reg* sourceReg;
-        swiftAssert( phi->arg_.size() == 2, "TODO" );
-        if ( loop->body_.contains(phi->sourceBBs_[0]) )
+        swiftAssert( phi->arg_.size() == 2, "the header has exactly two predecessors" );
+        if ( phi->sourceBBs_[0] == lastNode )
         {
             sourceIndex = 0;
             sourceReg = (Reg*) phi->arg_[0].op_;
         }
         else
         {
-            swiftAssert( loop->body_.contains(phi->sourceBBs_[1]), 
-                    "must be the loop source" );
+            swiftAssert( phi->sourceBBs_[1] == lastNode, "must be the loop source" );
             sourceIndex = 1;
             sourceReg = (Reg*) phi->arg_[1].op_;
         }
@@ -509,31 +874,146 @@ void Vectorizer::vectorizeLoops(BBNode* bbNode)
         // subtitute phi source arg
         phi->arg_[sourceIndex].op_ = newReg;
 
-        // save old value
-        InstrNode* insertionPoint = lastBB->getLastNonJump();
+        // keep the old value in inactive lanes
+        insertBlend( lastBB->getLastNonJump(), newReg, 
+                latchState.active_, sourceReg, phi->result() );
+    }
+    lastBB->fixPointers();
 
-#ifdef SWIFT_DEBUG
-        std::string andStr = "and";
-        std::string andnStr = "andn";
-        Reg* and_Reg = simdFunction_->newSSAReg(sourceReg->type_, & andStr);
-        Reg* andnReg = simdFunction_->newSSAReg(sourceReg->type_, &andnStr);
-#else // SWIFT_DEBUG
-        Reg* and_Reg = simdFunction_->newSSAReg(sourceReg->type_);
-        Reg* andnReg = simdFunction_->newSSAReg(sourceReg->type_);
-#endif // SWIFT_DEBUG
+    /*
+     * now create the phi functions in the header
+     */
 
-        AssignInstr* and_ = new AssignInstr(AssignInstr::AND,  and_Reg, mask, sourceReg);
-        AssignInstr* andn = new AssignInstr(AssignInstr::ANDN, andnReg, mask, (Reg*) phi->result() );
-        AssignInstr*  _or = new AssignInstr(AssignInstr::OR, newReg, and_Reg, andnReg);
+    Op* initActive = newMaskConst(maskType, true);
 
-        and_ToBeInserted.push_back(and_);
-        andnToBeInserted.push_back(andn);
-          orToBeInserted.push_back(_or);
+    // only lanes of the enclosing clauses may enter the loop
+    LoopGuards::iterator guardIter = loopGuards_.find(bbNode);
+    if ( guardIter != loopGuards_.end() )
+    {
+        Guards& guards = guardIter->second;
+
+        for (size_t i = 0; i < guards.size(); ++i)
+        {
+            Reg* guarded = newSSAReg(maskType, "guarded");
+            appendBeforeJump( preheaderNode, new AssignInstr(
+                        guards[i].negate_ ? AssignInstr::ANDN : AssignInstr::AND, 
+                        guarded, guards[i].mask_, initActive) );
+            initActive = guarded;
+        }
+    }
+
+    std::vector<Reg*> phiResults;
+    std::vector<Op*> inits;
+    std::vector<Op*> latches;
+
+    phiResults.push_back(activeReg);
+    inits.push_back(initActive);
+    latches.push_back(latchState.active_);
+
+    if ( exits.size() > 1 )
+    {
+        phiResults.push_back(brokenReg);
+        inits.push_back( newMaskConst(maskType, false) );
+        latches.push_back(latchState.broken_);
+
+        for (size_t i = 0; i < carriedRegs.size(); ++i)
+        {
+            phiResults.push_back(carriedRegs[i]);
+            inits.push_back( simdFunction_->newUndef(carriedRegs[i]->type_) );
+            latches.push_back(latchState.carried_[i]);
+        }
+    }
+
+    PhiInstr* activePhi = 0;
+    size_t initIndex = 0;
+
+    for (size_t i = 0; i < phiResults.size(); ++i)
+    {
+        PhiInstr* phi = new PhiInstr( phiResults[i], bbNode->pred_.size() );
+
+        size_t counter = 0;
+        CFG_RELATIVES_EACH(predIter, bbNode->pred_)
+        {
+            BBNode* predNode = predIter->value_;
+            phi->sourceBBs_[counter] = predNode;
+
+            if (predNode == preheaderNode)
+            {
+                phi->arg_[counter].op_ = inits[i];
+                initIndex = counter;
+            }
+            else
+                phi->arg_[counter].op_ = latches[i];
+
+            ++counter;
+        }
+
+        simdFunction_->instrList_.insert(bb->begin_, phi);
 
-        simdFunction_->instrList_.insert(insertionPoint, _or);
-        simdFunction_->instrList_.insert(insertionPoint, andn);
-        simdFunction_->instrList_.insert(insertionPoint, and_);
+        if (i == 0)
+            activePhi = phi;
     }
+    bb->fixPointers();
+
+    /*
+     * substitute the phi functions in the merge by blends 
+     */
+
+    if ( exits.size() > 1 )
+    {
+        BasicBlock* merge = mergeNode->value_;
+        const LoopState& exitState = stateAt(states, cfg, branchBBNode);
+
+        // find the arg coming from the main exit
+        size_t mainIndex = 0;
+        CFG_RELATIVES_EACH(predIter, mergeNode->pred_)
+        {
+            if ( !deadBBs_.contains(predIter->value_) )
+                break;
+
+            ++mainIndex;
+        }
+
+        InstrNode* appendTo = merge->firstOrdinary_->prev_;
+        for (size_t i = 0; i < mergePhis.size(); ++i)
+        {
+            PhiInstr* phi = mergePhis[i];
+
+            appendTo = insertBlend( appendTo, (Reg*) phi->result(), exitState.broken_, 
+                    exitState.carried_[i], phi->arg_[mainIndex].op_ );
+
+            delete mergePhiNodes[i]->value_;
+            simdFunction_->instrList_.erase(mergePhiNodes[i]);
+        }
+
+        merge->fixPointers();
+    }
+
+    /*
+     * restrict the active masks of nested loops to the lanes of this loop
+     */
+
+    for (LoopMasks::iterator iter = loopMasks_.begin(); iter != loopMasks_.end(); ++iter)
+    {
+        LoopMask& inner = iter->second;
+
+        if ( inner.nested_ || !loop->body_.contains(iter->first) )
+            continue;
+
+        const LoopState& state = stateAt(states, cfg, inner.preheader_);
+        Reg* nested = newSSAReg(maskType, "nested");
+        appendBeforeJump( inner.preheader_, new AssignInstr(AssignInstr::AND, 
+                    nested, state.active_, inner.phi_->arg_[inner.initIndex_].op_) );
+
+        inner.phi_->arg_[inner.initIndex_].op_ = nested;
+        inner.nested_ = true;
+    }
+
+    LoopMask& loopMask = loopMasks_[bbNode];
+    loopMask.phi_ = activePhi;
+    loopMask.preheader_ = preheaderNode;
+    loopMask.initIndex_ = initIndex;
+    loopMask.nested_ = false;
 }
 
 void Vectorizer::twistBranch(BBNode* bbNode)
@@ -586,4 +1066,94 @@ void Vectorizer::twistBranch(BBNode* bbNode)
     notReg->uses_.append( DefUse(notReg, branchInstrNode, bbNode) );
 }
 
+/*
+ * helpers
+ */
+
+Reg* Vectorizer::newSSAReg(Op::Type type, const std::string& id)
+{
+#ifdef SWIFT_DEBUG
+    return simdFunction_->newSSAReg(type, &id);
+#else // SWIFT_DEBUG
+    return simdFunction_->newSSAReg(type);
+#endif // SWIFT_DEBUG
+}
+
+Const* Vectorizer::newMaskConst(Op::Type type, bool allSet)
+{
+    Const* mask = simdFunction_->newConst(type, simdLength_);
+    Box box;
+    box.uint64_ = allSet ? 0xFFFFFFFFFFFFFFFFull : 0ull;
+    mask->broadcast(box);
+
+    return mask;
+}
+
+InstrNode* Vectorizer::appendBeforeJump(BBNode* bbNode, InstrBase* instr)
+{
+    BasicBlock* bb = bbNode->value_;
+    InstrNode* instrNode = simdFunction_->instrList_.insert(bb->getLastNonJump(), instr);
+    bb->fixPointers();
+
+    return instrNode;
+}
+
+InstrNode* Vectorizer::insertBlend(InstrNode* appendTo, Reg* result, 
+        Op* mask, Op* trueOp, Op* falseOp)
+{
+    Reg* and_Reg = newSSAReg(result->type_, "and");
+    Reg* andnReg = newSSAReg(result->type_, "andn");
+
+    InstrList& instrList = simdFunction_->instrList_;
+    appendTo = instrList.insert( appendTo, 
+            new AssignInstr(AssignInstr::AND,  and_Reg, mask, trueOp) );
+    appendTo = instrList.insert( appendTo, 
+            new AssignInstr(AssignInstr::ANDN, andnReg, mask, falseOp) );
+    appendTo = instrList.insert( appendTo, 
+            new AssignInstr(AssignInstr::OR, result, and_Reg, andnReg) );
+
+    return appendTo;
+}
+
+void Vectorizer::setUnsupported(const char* reason)
+{
+    if (!unsupported_)
+        unsupported_ = reason;
+}
+
+void Vectorizer::eraseDeadBBs()
+{
+    CFG* cfg = simdFunction_->cfg_;
+
+    BBSET_EACH(iter, deadBBs_)
+    {
+        BBNode* deadNode = *iter;
+        BasicBlock* dead = deadNode->value_;
+
+        swiftAssert( deadNode->pred_.empty(), "must not be reachable anymore" );
+        swiftAssert( dead->begin_->next() == dead->end_, "must only consist of its label" );
+
+        // the basic block in front of dead now ends where dead ended
+        CFG_RELATIVES_EACH(bbIter, cfg->nodes_)
+        {
+            BasicBlock* bb = bbIter->value_->value_;
+
+            if (bb->end_ == dead->begin_)
+            {
+                bb->end_ = dead->end_;
+                bb->fixPointers();
+                break;
+            }
+        }
+
+        cfg->labelNode2BBNode_.erase(dead->begin_);
+        delete dead->begin_->value_;
+        simdFunction_->instrList_.erase(dead->begin_);
+
+        cfg->erase(deadNode);
+    }
+
+    deadBBs_.clear();
+}
+
 } // namespace me
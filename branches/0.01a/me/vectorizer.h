@@ -25,6 +25,7 @@
 #include "me/codepass.h"
 #include "me/defuse.h"
 #include "me/forward.h"
+#include "me/op.h"
 
 namespace me {
 
@@ -52,14 +53,67 @@ public:
     Function* function();
     int getSimdLength();
 
+    /** 
+     * @brief Returns why \a function_ could not be vectorized or 0 if
+     * \a process has been successful.
+     *
+     * In this case \a simdFunction_ is only partially built up and must not
+     * be used.
+     */
+    const char* getUnsupported() const;
+
+    /** 
+     * @brief Calculates the number of elements which are processed at once
+     * by the simd version of \a function_.
+     *
+     * The length is taken from the vectorized \a Aggregate types which are
+     * accessed in \a function_. If there are none the size of the
+     * vectorizable types of \a function_'s vars and \a Arch::getSimdWidth
+     * determine the length. Aggregates of different lengths or vectorizable
+     * types of different sizes cannot be vectorized together and make
+     * \a function_ unsupported.
+     */
+    int calcSimdLength();
+
     void eliminateIfElseClauses(BBNode* bbNode);
+
+    /** 
+     * @brief Vectorizes all loops in the dominance subtree of \p bbNode.
+     *
+     * Each loop gets an active mask which knows the lanes still running the
+     * loop. The loop is executed as long as any lane is active. Lanes which
+     * leave the loop via an additional exit (a break) are removed from the
+     * active mask and the values they carry out of the loop are blended into
+     * the results after the loop.
+     */
     void vectorizeLoops(BBNode* bbNode);
     void twistBranch(BBNode* bbNode);
 
+    /*
+     * helpers
+     */
+
+    Reg* newSSAReg(Op::Type type, const std::string& id);
+    Const* newMaskConst(Op::Type type, bool allSet);
+
+    /// Inserts the instruction in front of the last JumpInstr of \p bbNode.
+    InstrNode* appendBeforeJump(BBNode* bbNode, InstrBase* instr);
+
+    /// Inserts: result = (mask AND trueOp) OR (NOT mask AND falseOp)
+    InstrNode* insertBlend(InstrNode* appendTo, Reg* result, 
+            Op* mask, Op* trueOp, Op* falseOp);
+
+    /// Removes the basic blocks in \a deadBBs_ from the CFG.
+    void eraseDeadBBs();
+
+    /// Remembers the first shape which cannot be vectorized.
+    void setUnsupported(const char* reason);
+
 //private:
 
     Function* simdFunction_;
     int simdLength_;
+    const char* unsupported_;
 
     InstrNode* currentInstrNode_;
     BBNode* currentBB_;
@@ -74,6 +128,40 @@ public:
     BBNode2BBNode src2dstBBNode_;
 
     VDUMap vduMap_;
+
+    /// A mask which must be set for a lane in order to enter a loop.
+    struct Guard
+    {
+        Op* mask_;
+        bool negate_; ///< use the negated mask
+
+        Guard() {}
+        Guard(Op* mask, bool negate)
+            : mask_(mask)
+            , negate_(negate)
+        {}
+    };
+
+    typedef std::vector<Guard> Guards;
+    typedef Map<BBNode*, Guards> LoopGuards;
+
+    /// Knows for each loop header inside an if-else-clause its guards.
+    LoopGuards loopGuards_;
+
+    /// The active mask of an already vectorized loop.
+    struct LoopMask
+    {
+        PhiInstr* phi_;
+        BBNode* preheader_;
+        size_t initIndex_; ///< index of the phi arg coming from the preheader
+        bool nested_;      ///< already restricted by an enclosing loop?
+    };
+
+    typedef Map<BBNode*, LoopMask> LoopMasks;
+    LoopMasks loopMasks_;
+
+    /// Basic blocks which are not reachable anymore after removing breaks.
+    BBSet deadBBs_;
 };
 
 } // namespace me
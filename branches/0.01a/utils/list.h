@@ -331,6 +331,18 @@ public:
         --size_;
     }
 
+    /// Removes \p n from the list without destroying it.
+    void unlink(Node* n)
+    {
+        swiftAssert(size_ != 0, "cannot remove item from an empty list");
+        swiftAssert(n != sentinel_, "tried to unlink sentinel");
+
+        n->prev_->next_ = n->next_;
+        n->next_->prev_ = n->prev_;
+
+        --size_;
+    }
+
     /**
      * Searches for the first \p t in the list. Returns sentinel() if not found.
      * @param t the value to be searched
@@ -0,0 +1,49 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef BENCHMARK_BENCH_H
+#define BENCHMARK_BENCH_H
+
+/*
+ * Timing API of the benchmark programs.
+ *
+ * Each bench_begin/bench_end pair encloses one kernel region. The monotonic
+ * time of each region is appended to the file named by the environment
+ * variable SWIFT_BENCH_FILE as
+ *
+ *     kernel <number> <nanoseconds>
+ *
+ * where kernels are numbered in the order they end. Without SWIFT_BENCH_FILE
+ * the times are printed to stderr. Both are implemented in test/lib.c, so
+ * Swift programs simply call them via c_call while the C++ programs link
+ * test/lib.o.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void bench_begin();
+void bench_end();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCHMARK_BENCH_H
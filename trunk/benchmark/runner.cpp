@@ -0,0 +1,273 @@
+/*
+ * Swift compiler framework
+ * Copyright (C) 2007-2009 Roland Leißa <r_leis01@math.uni-muenster.de>
+ *
+ * This framework is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 3 as published by the Free Software Foundation.
+ *
+ * This framework is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this framework; see the file LICENSE. If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Runs a benchmark program instrumented with bench.h several times and
+ * reports statistics of its kernel regions:
+ *
+ *     bench_runner [options] program [args]
+ *
+ *     -w <n>          number of warmup runs which are not measured (default 1)
+ *     -r <n>          number of measured runs (default 5)
+ *     -e <n>          number of elements processed by each kernel
+ *     -b <n>          number of bytes moved per element
+ *     -m <key=value>  add meta data to the JSON record, may be repeated
+ *     -j <file>       append the JSON record as one line to file
+ *
+ * A summary is printed to stderr; stdout only receives the median of the
+ * total kernel time in seconds so that scripts can pick it up easily.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef std::vector<double> Samples;
+
+struct Stats
+{
+    double median_;
+    double min_;
+    double stddev_;
+
+    Stats(Samples samples)
+    {
+        std::sort( samples.begin(), samples.end() );
+        size_t n = samples.size();
+
+        median_ = (n % 2) ? samples[n/2] : (samples[n/2 - 1] + samples[n/2]) / 2.0;
+        min_ = samples[0];
+
+        double mean = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            mean += samples[i];
+        mean /= n;
+
+        double var = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            var += (samples[i] - mean) * (samples[i] - mean);
+
+        stddev_ = n > 1 ? std::sqrt( var / (n - 1) ) : 0.0;
+    }
+};
+
+static void usage()
+{
+    fprintf(stderr, "usage: bench_runner [-w warmup] [-r runs] [-e elements] "
+            "[-b bytes] [-m key=value]... [-j file] program [args]\n");
+    exit(EXIT_FAILURE);
+}
+
+/// Runs \p argv once and returns the kernel times in seconds.
+static Samples run(char** argv)
+{
+    char name[] = "/tmp/swift_bench_XXXXXX";
+    int fd = mkstemp(name);
+    if (fd == -1)
+    {
+        perror("mkstemp");
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        setenv("SWIFT_BENCH_FILE", name, 1);
+        execv(argv[0], argv);
+        perror(argv[0]);
+        _exit(EXIT_FAILURE);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+
+    if ( !WIFEXITED(status) || WEXITSTATUS(status) != 0 )
+    {
+        fprintf(stderr, "error: %s failed\n", argv[0]);
+        unlink(name);
+        exit(EXIT_FAILURE);
+    }
+
+    Samples kernels;
+    FILE* file = fopen(name, "r");
+    int kernel;
+    long long ns;
+
+    while ( file && fscanf(file, "kernel %i %lld\n", &kernel, &ns) == 2 )
+        kernels.push_back(ns * 1e-9);
+
+    if (file)
+        fclose(file);
+    unlink(name);
+
+    if ( kernels.empty() )
+    {
+        fprintf(stderr, "error: %s does not call bench_begin/bench_end\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    return kernels;
+}
+
+static void printStats(FILE* out, const Stats& stats, double elements, double bytes)
+{
+    fprintf(out, "\"median_s\": %.9g, \"min_s\": %.9g, \"stddev_s\": %.9g", 
+            stats.median_, stats.min_, stats.stddev_);
+
+    if (elements != 0.0)
+    {
+        fprintf(out, ", \"elements_per_s\": %.9g, \"gb_per_s\": %.9g", 
+                elements / stats.median_, elements * bytes / stats.median_ * 1e-9);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int numWarmups = 1;
+    int numRuns = 5;
+    double elements = 0.0;
+    double bytes = 0.0;
+    std::vector<std::string> meta;
+    const char* json = 0;
+
+    int opt;
+    while ( (opt = getopt(argc, argv, "+w:r:e:b:m:j:")) != -1 )
+    {
+        switch (opt)
+        {
+            case 'w': numWarmups = atoi(optarg); break;
+            case 'r': numRuns = atoi(optarg); break;
+            case 'e': elements = atof(optarg); break;
+            case 'b': bytes = atof(optarg); break;
+            case 'm': meta.push_back(optarg); break;
+            case 'j': json = optarg; break;
+            default: usage();
+        }
+    }
+
+    if (optind == argc || numRuns < 1)
+        usage();
+
+    char** program = argv + optind;
+
+    for (int i = 0; i < numWarmups; ++i)
+        run(program);
+
+    // kernels[k][i]: time of kernel k in run i
+    std::vector<Samples> kernels;
+    Samples totals;
+
+    for (int i = 0; i < numRuns; ++i)
+    {
+        Samples times = run(program);
+
+        if ( kernels.empty() )
+            kernels.resize( times.size() );
+        else if ( times.size() != kernels.size() )
+        {
+            fprintf(stderr, "error: number of kernels differs between runs\n");
+            return EXIT_FAILURE;
+        }
+
+        double total = 0.0;
+        for (size_t k = 0; k < times.size(); ++k)
+        {
+            kernels[k].push_back(times[k]);
+            total += times[k];
+        }
+
+        totals.push_back(total);
+    }
+
+    /*
+     * summary
+     */
+
+    Stats total(totals);
+
+    for (size_t k = 0; k < kernels.size(); ++k)
+    {
+        Stats stats(kernels[k]);
+        fprintf(stderr, "kernel %zu: median %.4fs, min %.4fs, stddev %.4fs", 
+                k, stats.median_, stats.min_, stats.stddev_);
+
+        if (elements != 0.0)
+        {
+            fprintf(stderr, ", %.3g elements/s, %.3f GB/s", 
+                    elements / stats.median_, elements * bytes / stats.median_ * 1e-9);
+        }
+
+        fprintf(stderr, "\n");
+    }
+
+    /*
+     * JSON record
+     */
+
+    if (json)
+    {
+        FILE* out = fopen(json, "a");
+        if (!out)
+        {
+            perror(json);
+            return EXIT_FAILURE;
+        }
+
+        fprintf(out, "{\"program\": \"%s\", ", program[0]);
+
+        for (size_t i = 0; i < meta.size(); ++i)
+        {
+            size_t pos = meta[i].find('=');
+            if (pos == std::string::npos)
+                continue;
+
+            fprintf(out, "\"%s\": \"%s\", ", 
+                    meta[i].substr(0, pos).c_str(), meta[i].substr(pos + 1).c_str());
+        }
+
+        fprintf(out, "\"warmups\": %i, \"runs\": %i, \"elements\": %.0f, \"bytes_per_element\": %.0f, ", 
+                numWarmups, numRuns, elements, bytes);
+
+        fprintf(out, "\"total\": {");
+        printStats(out, total, elements, bytes);
+        fprintf(out, "}, \"kernels\": [");
+
+        for (size_t k = 0; k < kernels.size(); ++k)
+        {
+            fprintf(out, "%s{", k ? ", " : "");
+            printStats( out, Stats(kernels[k]), elements, bytes );
+            fprintf(out, "}");
+        }
+
+        fprintf(out, "]}\n");
+        fclose(out);
+    }
+
+    printf("%.4f\n", total.median_);
+
+    return EXIT_SUCCESS;
+}
@@ -25,14 +25,17 @@
 # int16
 # int32
 # int64
-# sat8
-# sat16
 #
 # uint
 # uint8
 # uint16
 # uint32
 # uint64
+
+
+# The following types shall be generated from sat_template.swift:
+# sat8
+# sat16
 # usat8
 # usat16
 
@@ -56,21 +59,17 @@ int_to_real[ 3]=""                                               #int8
 int_to_real[ 4]=""                                               #int16
 int_to_real[ 5]="def simd bitcast_to_real32() -> real32 result; end" #int32
 int_to_real[ 6]="def simd bitcast_to_real64() -> real64 result; end" #int64
-int_to_real[ 7]=""                                               #sat8
-int_to_real[ 8]=""                                               #sat16
 
-int_to_real[ 9]=""                                               #uint8
-int_to_real[10]=""                                               #uint16
-int_to_real[11]="def simd bitcast_to_real32() -> real32 result; end" #uint32
-int_to_real[12]="def simd bitcast_to_real64() -> real64 result; end" #uint64
-int_to_real[13]=""                                               #usat8
-int_to_real[14]=""                                               #usat16
+int_to_real[ 7]=""                                               #uint8
+int_to_real[ 8]=""                                               #uint16
+int_to_real[ 9]="def simd bitcast_to_real32() -> real32 result; end" #uint32
+int_to_real[10]="def simd bitcast_to_real64() -> real64 result; end" #uint64
 
 i=0
 for TYPE in \
     index int uint \
-     int8  int16  int32  int64  sat8  sat16 \
-    uint8 uint16 uint32 uint64 usat8 usat16
+     int8  int16  int32  int64 \
+    uint8 uint16 uint32 uint64
 do
     # build file name
     FILE=$TYPE.swift
@@ -95,6 +94,23 @@ do
     let i=i+1
 done
 
+#
+# auto generate saturating types from sat_template.swift
+#
+
+for TYPE in sat8 sat16 usat8 usat16
+do
+    # build file name
+    FILE=$TYPE.swift
+
+    # generate remark
+    echo "# auto-generated file for the built-in type $TYPE derived from the file sat_template.swift" > $FILE
+    echo >> $FILE
+
+    # substitute SAT with $TYPE and append to the proper file
+    sed s/SAT/${TYPE}/g <sat_template.swift >> $FILE
+done
+
 #
 # auto generate real types from real.swift
 #
@@ -45,6 +45,10 @@ simd class INT
     # unary minus
     reader - () -> INT res; end
 
+    # minimum and maximum
+    def simd min (INT i) -> INT res; end
+    def simd max (INT i) -> INT res; end
+
     # normal casts
 
     def simd to_int()   -> int result; end
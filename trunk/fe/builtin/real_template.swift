@@ -37,6 +37,13 @@ simd class REAL
     # unary minus
     simd reader - () -> REAL res; end
 
+    # square root
+    simd reader sqrt() -> REAL result; end
+
+    # minimum and maximum
+    simd reader min(REAL r) -> REAL result; end
+    simd reader max(REAL r) -> REAL result; end
+
     # normal casts
 
     simd reader to_int()   -> int result; end
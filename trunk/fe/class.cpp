@@ -21,10 +21,16 @@
 
 #include <memory>
 #include <sstream>
+#include <tr1/functional>
+
+#include <llvm/DerivedTypes.h>
+#include <llvm/Function.h>
 
 #include "utils/assert.h"
 #include "utils/cast.h"
 
+#include "vec/vectype.h"
+
 #include "fe/context.h"
 #include "fe/error.h"
 #include "fe/scope.h"
@@ -38,9 +44,12 @@ namespace swift {
 
 //------------------------------------------------------------------------------
 
+size_t Class::numFctLookups_ = 0;
+size_t Class::numFctCacheHits_ = 0;
+
 Class::Class(const Location& loc, Module* parent, bool simd, std::string* id)
     : Node(loc, parent)
-    , id_(id)
+    , id_( intern(id) )
     , simd_(simd)
     , copyCreate_(NOT_ANALYZED)
     , defaultCreate_(NOT_ANALYZED)
@@ -88,7 +97,7 @@ bool Class::insert(MemberVar* m)
 {
     memberVars_.push_back(m);
 
-    MemberVarMap::iterator iter = memberVarMap_.find(m->id());
+    MemberVarMap::iterator iter = memberVarMap_.find( m->id() );
 
     if (iter != memberVarMap_.end())
     {
@@ -107,8 +116,8 @@ bool Class::insert(MemberFct* m)
     // TODO reader foo(int, int) <-> writer foo(int, int)
     memberFcts_.push_back(m);
 
-    MemberFctMap::iterator iter = memberFctMap_.find(m->id());
-    memberFctMap_.insert( std::make_pair(m->id(), m) );
+    memberFctMap_[m->id()].push_back(m);
+    fctCache_.clear();
 
     return true;
 }
@@ -125,18 +134,48 @@ MemberVar* Class::lookupMemberVar(const std::string* id) const
 
 MemberFct* Class::lookupMemberFct(Module* module, const std::string* id, const TypeList& inTypes) const
 {
-    typedef MemberFctMap::const_iterator CIter;
-    std::pair<CIter, CIter> p = memberFctMap_.equal_range(id);
+    ++numFctLookups_;
+
+    MemberFctMap::const_iterator overloads = memberFctMap_.find(id);
+    if ( overloads == memberFctMap_.end() )
+        return 0;
+
+    std::string inKey = inTypes.key();
+    std::string key = *id + '(' + inKey + ')';
+
+    FctCache::const_iterator cached = fctCache_.find(key);
+    if ( cached != fctCache_.end() )
+    {
+        ++numFctCacheHits_;
+        return cached->second;
+    }
+
+    size_t inHash = std::tr1::hash<std::string>()(inKey);
+    bool hasError = inTypes.hasError();
+    MemberFct* result = 0;
+
+    // try the overloads in the order of their declaration
+    const MemberFcts& fcts = overloads->second;
 
-    for (CIter iter = p.first; iter != p.second; ++iter)
+    for (size_t i = 0; i < fcts.size(); ++i)
     {
-        MemberFct* m = iter->second;
+        MemberFct* m = fcts[i];
 
-        if ( m->sig_.checkIn(module, inTypes) )
-            return m;
+        // signatures with a different hash cannot match -- unless an error
+        // type is involved which does not care about the key
+        bool prefilter = !hasError && !m->sig_.inError_;
+
+        if ( (!prefilter || m->sig_.inHash_ == inHash) && m->sig_.checkIn(module, inTypes) )
+        {
+            result = m;
+            break;
+        }
     }
 
-    return 0;
+    // misses are cached, too
+    fctCache_[key] = result;
+
+    return result;
 }
 
 //void Class::addAssignCreate(Context* ctxt)
@@ -293,13 +332,11 @@ int Class::getSimdLength() const
 
 ClassMember::ClassMember(const Location& loc, Class* parent, std::string* id)
     : Node(loc, parent)
-    , id_(id)
+    , id_( intern(id) )
 {}
 
 ClassMember::~ClassMember()
-{
-    delete id_;
-}
+{}
 
 const std::string* ClassMember::id() const
 {
@@ -329,9 +366,12 @@ MemberFct::MemberFct(const Location& loc,
                      const Qualifiers& qualifiers, 
                      std::string* id)
     : ClassMember(loc, parent, id)
+    , qualifiers_(qualifiers)
     , scope_(new Scope(loc, this, 0) )
     , main_(false)
     , constructor_(false)
+    , sideEffects_(false)
+    , purity_(UNKNOWN)
     , thisValue_(0)
 {}
 
@@ -339,9 +379,12 @@ MemberFct::MemberFct(const Location& loc,
                      Class* parent, 
                      const Qualifiers& qualifiers)
     : ClassMember(loc, parent, new std::string("this"))
+    , qualifiers_(qualifiers)
     , scope_(new Scope(loc, this, 0) )
     , main_(false)
     , constructor_(true)
+    , sideEffects_(false)
+    , purity_(UNKNOWN)
     , thisValue_(0)
 {
     // constructors are always static
@@ -399,11 +442,69 @@ Value* MemberFct::getThisValue() const
     return thisValue_;
 }
 
+/*
+ * The caller always has the address of an aggregate argument at hand -- load
+ * the ones which are passed by value. Bools cross the boundary as masks.
+ */
+void MemberFct::prepareSimdArgs(LLVMBuilder& builder, Values& args) const
+{
+    swiftAssert( args.size() == simdByValue_.size(), "sizes must match" );
+    const llvm::FunctionType* fctType = simdFct_->getFunctionType();
+
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        if (simdByValue_[i])
+            args[i] = builder.CreateLoad(args[i]);
+        else if ( vec::isPredicate(args[i]->getType()) )
+            args[i] = vec::toMask( builder, args[i], fctType->getParamType(i) );
+    }
+}
+
 Scope* MemberFct::scope()
 {
     return scope_;
 }
 
+void MemberFct::addCallee(MemberFct* callee)
+{
+    callees_.push_back(callee);
+}
+
+void MemberFct::setSideEffects()
+{
+    sideEffects_ = true;
+}
+
+bool MemberFct::isPure() const
+{
+    switch (purity_)
+    {
+        case PURE:    return true;
+        case IMPURE:  return false;
+        case PENDING: return false;
+        case UNKNOWN: break;
+    }
+
+    purity_ = PENDING;
+    bool pure = isSimd() && !sideEffects_;
+
+    // constructors and writers store through this
+    if (constructor_)
+        pure = false;
+    else if ( hasThisArg() )
+        pure &= getVarOrConst() == Token::CONST;
+
+    for (size_t i = 0; i < sig_.in_.size() && pure; ++i)
+        pure = !sig_.in_[i]->getType()->isVar();
+
+    for (size_t i = 0; i < callees_.size() && pure; ++i)
+        pure = callees_[i]->isPure();
+
+    purity_ = pure ? PURE : IMPURE;
+
+    return pure;
+}
+
 //----------------------------------------------------------------------
 
 //Method::Method(const Location& loc, bool simd, std::string* id, Scope* scope)
@@ -24,6 +24,7 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <tr1/unordered_map>
 
 #include "fe/location.h"
 #include "fe/var.h"
@@ -61,8 +62,11 @@ public:
     const char* cid() const;
     bool insert(MemberVar* m);
     bool insert(MemberFct* m);
+
+    /// \p id must be a symbol -- see \a intern.
     MemberFct* lookupMemberFct(Module* module, const std::string* id, const TypeList&) const;
     MemberVar* lookupMemberVar(const std::string* id) const;
+
     void addAssignCreate(Context* ctxt);
 
     typedef std::vector<MemberVar*> MemberVars;
@@ -88,19 +92,28 @@ public:
     const llvm::StructType* getVecType() const;
     int getSimdLength() const;
 
+    static size_t numFctLookups_;  ///< number of calls of lookupMemberFct
+    static size_t numFctCacheHits_; ///< number of those answered by the cache
+
 protected:
 
-    std::string* id_;
+    const std::string* id_;
     bool simd_;
 
-    typedef std::     map<const std::string*, MemberVar*, StringPtrCmp> MemberVarMap;
-    typedef std::multimap<const std::string*, MemberFct*, StringPtrCmp> MemberFctMap;
+    typedef std::tr1::unordered_map<const std::string*, MemberVar*, SymbolHash> MemberVarMap;
+
+    /// Maps a symbol to its overloads in the order of their declaration.
+    typedef std::tr1::unordered_map<const std::string*, MemberFcts, SymbolHash> MemberFctMap;
 
     MemberVars memberVars_;
     MemberFcts memberFcts_;
     MemberFctMap memberFctMap_;
     MemberVarMap memberVarMap_;         
 
+    /// Maps "id(key of the in types)" to the resolved MemberFct or 0 if there is none.
+    typedef std::tr1::unordered_map<std::string, MemberFct*> FctCache;
+    mutable FctCache fctCache_;
+
 private:
 
     void setLLVMType(const llvm::Type* llvmType);
@@ -134,7 +147,7 @@ public:
 
 private:
 
-    std::string* id_;
+    const std::string* id_;
     std::string llvmName_;
 
     template<class T> friend class ClassVisitor;
@@ -195,6 +208,25 @@ public:
     TokenType getVarOrConst() const;
     llvm::Value* getThisValue() const;
     Scope* scope();
+    void prepareSimdArgs(LLVMBuilder& builder, Values& args) const;
+
+    /// Notes that the body calls \p callee.
+    void addCallee(MemberFct* callee);
+
+    /// The body contains c_calls or stores through references.
+    void setSideEffects();
+
+    /**
+     * @brief Calls of pure member functions may be reordered.
+     *
+     * A member function is pure if it is a simd function whose params and
+     * this are const, whose body neither contains c_calls nor stores through
+     * references, and which only calls pure member functions. Recursive
+     * member functions are never pure.
+     *
+     * This is only valid after all bodies have been analyzed.
+     */
+    bool isPure() const;
 
 protected:
 
@@ -205,12 +237,29 @@ protected:
     std::vector<RetVal*> realOut_;
     bool main_;
     bool constructor_;
+    bool sideEffects_;
+    std::vector<MemberFct*> callees_;
+
+    enum Purity
+    {
+        UNKNOWN,
+        PENDING, ///< Currently computed -- the member function is recursive.
+        PURE,
+        IMPURE
+    };
+
+    mutable Purity purity_;
 
 public:
 
     Sig sig_;
     llvm::Function* llvmFct_;
     llvm::Function* simdFct_;
+
+    /// Which params of simdFct_ travel by value in vector registers instead of per pointer.
+    std::vector<bool> simdByValue_;
+    /// Which per-ref return values simdFct_ returns in vector registers instead of per pointer.
+    std::vector<bool> simdRetByValue_;
     const llvm::Type* retType_; 
     llvm::AllocaInst* retAlloca_;
     llvm::BasicBlock* returnBB_;
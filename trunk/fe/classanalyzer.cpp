@@ -5,6 +5,7 @@
 #include "fe/context.h"
 #include "fe/error.h"
 #include "fe/scope.h"
+#include "fe/simdloopfuser.h"
 #include "fe/stmnt.h"
 #include "fe/stmntanalyzer.h"
 #include "fe/type.h"
@@ -106,8 +107,28 @@ void ClassAnalyzer::checkSig(MemberFct* m)
 
 void ClassAnalyzer::checkStmnts(MemberFct* m)
 {
+    ctxt_->memberFct_ = m;
+
     StmntAnalyzer sa(ctxt_);
     m->scope_->accept(&sa);
+
+    ctxt_->memberFct_ = 0;
+    memberFcts_.push_back(m);
+}
+
+/*
+ * Whether a call within a simd loop has side effects depends on the body of
+ * the callee. So fusing must wait until all member functions are analyzed.
+ */
+void ClassAnalyzer::fuseSimdLoops()
+{
+    if (!ctxt_->result_)
+        return;
+
+    SimdLoopFuser fuser(ctxt_);
+
+    for (size_t i = 0; i < memberFcts_.size(); ++i)
+        fuser.fuse(memberFcts_[i]->scope_);
 }
 
 } // namespace swift
@@ -34,10 +34,15 @@ public:
     virtual void visit(MemberFct* m);
     virtual void visit(MemberVar* m);
 
+    /// Runs the \a SimdLoopFuser on all analyzed member functions.
+    void fuseSimdLoops();
+
 private:
 
     void checkSig(MemberFct* m);
     void checkStmnts(MemberFct* m);
+
+    std::vector<MemberFct*> memberFcts_;
 };
 
 typedef ClassVisitor<class Analyzer> ClassAnalyzer;
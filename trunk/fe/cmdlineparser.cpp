@@ -22,6 +22,7 @@
 #include <llvm/Pass.h>
 #include <llvm/Transforms/IPO.h>
 
+#include <cstdlib>
 #include <iostream>
 
 namespace swift {
@@ -47,6 +48,20 @@ template <class T> class Cmd;
 
 //------------------------------------------------------------------------------
 
+template<>
+class Cmd <class Source> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class Source> SourceCmd;
+
+//------------------------------------------------------------------------------
+
 template<>
 class Cmd <class Dump> : public CmdBase
 {
@@ -75,6 +90,118 @@ typedef Cmd<class CleanDump> CleanDumpCmd;
 
 //------------------------------------------------------------------------------
 
+template<>
+class Cmd <class Run> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class Run> RunCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class EmitObj> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class EmitObj> EmitObjCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class EmitListings> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class EmitListings> EmitListingsCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class Cpu> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class Cpu> CpuCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class Features> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class Features> FeaturesCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class CodeGenThreads> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class CodeGenThreads> CodeGenThreadsCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class CacheDir> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class CacheDir> CacheDirCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class CacheSize> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class CacheSize> CacheSizeCmd;
+
+//------------------------------------------------------------------------------
+
 template<>
 class Cmd <class OptLevel> : public CmdBase
 {
@@ -111,6 +238,90 @@ typedef Cmd<class OptSize> OptSizeCmd;
 
 //------------------------------------------------------------------------------
 
+template<>
+class Cmd <class ParallelSimd> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class ParallelSimd> ParallelSimdCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class StreamThreshold> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class StreamThreshold> StreamThresholdCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class PrefetchDistance> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class PrefetchDistance> PrefetchDistanceCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class FPModel> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class FPModel> FPModelCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class TimePasses> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class TimePasses> TimePassesCmd;
+
+//------------------------------------------------------------------------------
+
+template<>
+class Cmd <class TimePassesJSON> : public CmdBase
+{
+public:
+
+    Cmd(CmdLineParser& clp);
+
+    virtual void execute();
+};
+
+typedef Cmd<class TimePassesJSON> TimePassesJSONCmd;
+
+//------------------------------------------------------------------------------
+
 
 
 std::string CmdLineParser::usage_ = std::string("Usage: swiftc [options] file");
@@ -120,35 +331,65 @@ CmdLineParser::CmdLineParser(int argc, char** argv)
     : argc_(argc)
     , argv_(argv)
     , filename_(0)
+    , source_(0)
     , result_(true)
     , dump_(false)
     , cleanDump_(false)
+    , run_(false)
+    , emitObj_(false)
+    , emitListings_(false)
+    , cpu_("")
+    , features_("")
+    , codeGenThreads_(1)
+    , cacheDir_( getenv("SWIFT_CACHE_DIR") )
+    , cacheSize_(256ull << 20)
     , optSize_(false)
     , unroolLoops_(false)
     , unitAtATime_(false)
     , simplifyLibCalls_(true)
+    , parallelSimd_(false)
+    , streamThreshold_(1 << 20)
+    , prefetchDistance_(8)
+    , fpModel_(Context::FP_CONTRACT)
+    , timePasses_(false)
+    , timePassesJSON_(0)
     , optLevel_(0)
     , inlinePass_(0)
 {
     // create command data structure
+    cmds_["-e"] = new SourceCmd(*this);
     cmds_["--dump"] = new DumpCmd(*this);
     cmds_["--clean-dump"] = new CleanDumpCmd(*this);
+    cmds_["--run"] = new RunCmd(*this);
+    cmds_["-emit-obj"] = new EmitObjCmd(*this);
+    cmds_["-emit-listings"] = new EmitListingsCmd(*this);
+    cmds_["-mcpu"] = new CpuCmd(*this);
+    cmds_["-mattr"] = new FeaturesCmd(*this);
+    cmds_["-codegen-threads"] = new CodeGenThreadsCmd(*this);
+    cmds_["-cache-dir"] = new CacheDirCmd(*this);
+    cmds_["-cache-size"] = new CacheSizeCmd(*this);
     cmds_["-Os"] = new OptSizeCmd(*this);
     cmds_["-O0"] = new OptLevelCmd(*this, 0);
     cmds_["-O1"] = new OptLevelCmd(*this, 1);
     cmds_["-O2"] = new OptLevelCmd(*this, 2);
     cmds_["-O3"] = new OptLevelCmd(*this, 3);
+    cmds_["-parallel-simd"] = new ParallelSimdCmd(*this);
+    cmds_["-stream-threshold"] = new StreamThresholdCmd(*this);
+    cmds_["-prefetch-distance"] = new PrefetchDistanceCmd(*this);
+    cmds_["-fp-model"] = new FPModelCmd(*this);
+    cmds_["-time-passes"] = new TimePassesCmd(*this);
+    cmds_["-time-passes-json"] = new TimePassesJSONCmd(*this);
 
     // for each argument except the first one which is the program name
-    for (int i = 1; i < argc_; ++i)
+    for (current_ = 1; current_ < argc_; ++current_)
     {
-        Cmds::iterator iter = cmds_.find(argv_[i]);
+        Cmds::iterator iter = cmds_.find(argv_[current_]);
         if ( iter != cmds_.end() )
             iter->second->execute();
         else
         {
             if (!filename_)
-                filename_ = argv_[i];
+                filename_ = argv_[current_];
             else
             {
                 std::cerr << "error: multiple filenames given" << std::endl;
@@ -158,6 +399,10 @@ CmdLineParser::CmdLineParser(int argc, char** argv)
         }
     }
 
+    // a source given via -e needs a name for diagnostics and output files only
+    if (source_ && filename_ == 0)
+        filename_ = "a.swift";
+
     if (filename_ == 0)
         result_ = false;
 }
@@ -173,6 +418,11 @@ const char* CmdLineParser::getFilename() const
     return filename_;
 }
 
+const char* CmdLineParser::source() const
+{
+    return source_;
+}
+
 bool CmdLineParser::result() const
 {
     return result_;
@@ -188,6 +438,46 @@ bool CmdLineParser::cleanDump() const
     return cleanDump_;
 }
 
+bool CmdLineParser::run() const
+{
+    return run_;
+}
+
+bool CmdLineParser::emitObj() const
+{
+    return emitObj_;
+}
+
+bool CmdLineParser::emitListings() const
+{
+    return emitListings_;
+}
+
+const char* CmdLineParser::cpu() const
+{
+    return cpu_;
+}
+
+const char* CmdLineParser::features() const
+{
+    return features_;
+}
+
+unsigned CmdLineParser::codeGenThreads() const
+{
+    return codeGenThreads_;
+}
+
+const char* CmdLineParser::cacheDir() const
+{
+    return cacheDir_;
+}
+
+uint64_t CmdLineParser::cacheSize() const
+{
+    return cacheSize_;
+}
+
 bool CmdLineParser::optSize() const
 {
     return optSize_;
@@ -208,6 +498,36 @@ bool CmdLineParser::simplifyLibCalls() const
     return unitAtATime_;
 }
 
+bool CmdLineParser::parallelSimd() const
+{
+    return parallelSimd_;
+}
+
+uint64_t CmdLineParser::streamThreshold() const
+{
+    return streamThreshold_;
+}
+
+unsigned CmdLineParser::prefetchDistance() const
+{
+    return prefetchDistance_;
+}
+
+Context::FPModel CmdLineParser::fpModel() const
+{
+    return fpModel_;
+}
+
+bool CmdLineParser::timePasses() const
+{
+    return timePasses_;
+}
+
+const char* CmdLineParser::timePassesJSON() const
+{
+    return timePassesJSON_;
+}
+
 unsigned CmdLineParser::optLevel() const
 {
     return optLevel_;
@@ -218,6 +538,18 @@ llvm::Pass* CmdLineParser::inlinePass() const
     return inlinePass_;
 }
 
+const char* CmdLineParser::nextArg()
+{
+    if (current_ + 1 >= argc_)
+    {
+        std::cerr << "error: option '" << argv_[current_] << "' expects an argument" << std::endl;
+        result_ = false;
+        return 0;
+    }
+
+    return argv_[++current_];
+}
+
 //------------------------------------------------------------------------------
 
 CmdBase::CmdBase(CmdLineParser& clp)
@@ -226,6 +558,22 @@ CmdBase::CmdBase(CmdLineParser& clp)
 
 //------------------------------------------------------------------------------
 
+SourceCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * compiles the given source text instead of reading the file; a file name may
+ * still be given to name the diagnostics and outputs, it defaults to a.swift
+ */
+void SourceCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+        clp_.source_ = arg;
+}
+
+//------------------------------------------------------------------------------
+
 DumpCmd::Cmd(CmdLineParser& clp)
     : CmdBase(clp)
 {}
@@ -248,6 +596,131 @@ void CleanDumpCmd::execute()
 
 //------------------------------------------------------------------------------
 
+RunCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * JIT-compiles the program and runs it instead of writing a bitcode file
+ */
+void RunCmd::execute()
+{
+    clp_.run_ = true;
+}
+
+//------------------------------------------------------------------------------
+
+EmitObjCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * writes native object files instead of a bitcode file
+ */
+void EmitObjCmd::execute()
+{
+    clp_.emitObj_ = true;
+}
+
+//------------------------------------------------------------------------------
+
+EmitListingsCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * writes the native assembly (.s) and the llvm assembly (.ll) of the
+ * optimized module
+ */
+void EmitListingsCmd::execute()
+{
+    clp_.emitListings_ = true;
+}
+
+//------------------------------------------------------------------------------
+
+CpuCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * target cpu of the code generator, e.g. core2
+ */
+void CpuCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+        clp_.cpu_ = arg;
+}
+
+//------------------------------------------------------------------------------
+
+FeaturesCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * target features of the code generator, e.g. +sse41,-ssse3
+ */
+void FeaturesCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+        clp_.features_ = arg;
+}
+
+//------------------------------------------------------------------------------
+
+CodeGenThreadsCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * number of threads used by -emit-obj; the module is split into as many
+ * object files
+ */
+void CodeGenThreadsCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+    {
+        clp_.codeGenThreads_ = strtoul(arg, 0, 10);
+
+        if (clp_.codeGenThreads_ == 0)
+            clp_.codeGenThreads_ = 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+CacheDirCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * caches the outputs in this directory; defaults to $SWIFT_CACHE_DIR, the
+ * cache is disabled if neither is given
+ */
+void CacheDirCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+        clp_.cacheDir_ = arg;
+}
+
+//------------------------------------------------------------------------------
+
+CacheSizeCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * maximal size of the cache in MiB
+ */
+void CacheSizeCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+        clp_.cacheSize_ = strtoull(arg, 0, 10) << 20;
+}
+
+//------------------------------------------------------------------------------
+
 OptLevelCmd::Cmd(CmdLineParser& clp, unsigned optLevel)
     : CmdBase(clp)
     , optLevel_(optLevel)
@@ -280,5 +753,112 @@ void OptSizeCmd::execute()
 
 //------------------------------------------------------------------------------
 
+ParallelSimdCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+void ParallelSimdCmd::execute()
+{
+    clp_.parallelSimd_ = true;
+}
+
+//------------------------------------------------------------------------------
+
+StreamThresholdCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * simd loops with at least this number of iterations use non-temporal stores
+ * and prefetches; 0 disables streaming
+ */
+void StreamThresholdCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+        clp_.streamThreshold_ = strtoull(arg, 0, 10);
+}
+
+//------------------------------------------------------------------------------
+
+PrefetchDistanceCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * number of simd steps to prefetch ahead in streaming simd loops; 0 disables
+ * prefetching
+ */
+void PrefetchDistanceCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+        clp_.prefetchDistance_ = strtoul(arg, 0, 10);
+}
+
+//------------------------------------------------------------------------------
+
+FPModelCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * strict:   IEEE 754 semantics
+ * contract: allow fused multiply-adds and per lane float reductions (default)
+ * fast:     assume finite values and reassociate freely
+ */
+void FPModelCmd::execute()
+{
+    const char* arg = clp_.nextArg();
+    if (!arg)
+        return;
+
+    std::string model = arg;
+
+    if (model == "strict")
+        clp_.fpModel_ = Context::FP_STRICT;
+    else if (model == "contract")
+        clp_.fpModel_ = Context::FP_CONTRACT;
+    else if (model == "fast")
+        clp_.fpModel_ = Context::FP_FAST;
+    else
+    {
+        std::cerr << "error: unknown floating point model '" << arg << "'" << std::endl;
+        clp_.result_ = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+TimePassesCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * prints the time and memory spent in each phase and LLVM pass to stderr
+ */
+void TimePassesCmd::execute()
+{
+    clp_.timePasses_ = true;
+}
+
+//------------------------------------------------------------------------------
+
+TimePassesJSONCmd::Cmd(CmdLineParser& clp)
+    : CmdBase(clp)
+{}
+
+/*
+ * like -time-passes but writes the front-end report as JSON to the given file
+ */
+void TimePassesJSONCmd::execute()
+{
+    if ( const char* arg = clp_.nextArg() )
+    {
+        clp_.timePasses_ = true;
+        clp_.timePassesJSON_ = arg;
+    }
+}
+
+//------------------------------------------------------------------------------
+
 
 } // namespace swift
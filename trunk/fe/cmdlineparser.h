@@ -23,6 +23,10 @@
 #include <map>
 #include <string>
 
+#include "utils/types.h"
+
+#include "fe/context.h"
+
 namespace llvm {
     class Pass;
 }
@@ -41,13 +45,28 @@ public:
     ~CmdLineParser();
 
     const char* getFilename() const;
+    const char* source() const;
     bool result() const;
     bool dump() const;
     bool cleanDump() const;
+    bool run() const;
+    bool emitObj() const;
+    bool emitListings() const;
+    const char* cpu() const;
+    const char* features() const;
+    unsigned codeGenThreads() const;
+    const char* cacheDir() const;
+    uint64_t cacheSize() const;
     bool optSize() const;
     bool unroolLoops() const;
     bool unitAtATime() const;
     bool simplifyLibCalls() const;
+    bool parallelSimd() const;
+    uint64_t streamThreshold() const;
+    unsigned prefetchDistance() const;
+    Context::FPModel fpModel() const;
+    bool timePasses() const;
+    const char* timePassesJSON() const;
     unsigned optLevel() const;
     llvm::Pass* inlinePass() const;
 
@@ -56,17 +75,37 @@ private:
     int argc_;
     char** argv_;
     const char* filename_;
+    const char* source_;
     bool result_;
 
     bool dump_;
     bool cleanDump_;
+    bool run_;
+    bool emitObj_;
+    bool emitListings_;
+    const char* cpu_;
+    const char* features_;
+    unsigned codeGenThreads_;
+    const char* cacheDir_;
+    uint64_t cacheSize_;
     bool optSize_;
     bool unroolLoops_;
     bool unitAtATime_;
     bool simplifyLibCalls_;
+    bool parallelSimd_;
+    uint64_t streamThreshold_;
+    unsigned prefetchDistance_;
+    Context::FPModel fpModel_;
+    bool timePasses_;
+    const char* timePassesJSON_;
     unsigned optLevel_;
     llvm::Pass* inlinePass_;
 
+    int current_; ///< Index of the argument which is currently parsed.
+
+    /// Consumes the argument of the current option.
+    const char* nextArg();
+
     typedef std::map<std::string, CmdBase*> Cmds;
     static Cmds cmds_;
     static std::string usage_;
@@ -0,0 +1,255 @@
+#include "fe/compilecache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+namespace swift {
+
+// bump this if the layout of the cache changes
+static const char* CACHE_VERSION = "swift-cache-1";
+
+static const uint64_t FNV_PRIME = 1099511628211ull;
+
+CompileCache::CompileCache(const std::string& dir, uint64_t maxSize)
+    : dir_(dir)
+    , maxSize_(maxSize)
+    , hash1_(14695981039346656037ull)
+    , hash2_(0x84222325cbf29ce4ull)
+{}
+
+bool CompileCache::computeKey(int argc, char** argv, const char* filename, const std::vector<const char*>& builtin)
+{
+    hash( CACHE_VERSION, strlen(CACHE_VERSION) + 1 );
+
+    // any rebuild of the compiler invalidates all entries
+    if ( !hashFile("/proc/self/exe") )
+        return false;
+
+    // all options -- the name of the input file itself does not matter
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i] != filename)
+            hash( argv[i], strlen(argv[i]) + 1 );
+    }
+
+    for (size_t i = 0; i < builtin.size(); ++i)
+    {
+        if ( !hashFile(builtin[i]) )
+            return false;
+    }
+
+    return hashFile(filename);
+}
+
+bool CompileCache::lookup(const std::string& filename)
+{
+    std::string entry = entryDir();
+    DIR* dir = opendir( entry.c_str() );
+
+    if (!dir)
+        return false;
+
+    bool result = true;
+
+    while ( struct dirent* d = readdir(dir) )
+    {
+        std::string suffix = d->d_name;
+        if (suffix == "." || suffix == "..")
+            continue;
+
+        result &= copyFile(entry + "/" + suffix, filename + suffix);
+    }
+
+    closedir(dir);
+
+    // mark as recently used
+    if (result)
+        utime( entry.c_str(), 0 );
+
+    return result;
+}
+
+void CompileCache::store(const std::string& filename, const std::vector<std::string>& suffixes)
+{
+    if ( !makeDirs(dir_) )
+        return;
+
+    // fill a temporary dir first and rename it as a whole
+    std::ostringstream oss;
+    oss << entryDir() << ".tmp." << getpid();
+    std::string tmp = oss.str();
+
+    if ( mkdir(tmp.c_str(), 0755) != 0 )
+        return;
+
+    for (size_t i = 0; i < suffixes.size(); ++i)
+    {
+        if ( !copyFile(filename + suffixes[i], tmp + "/" + suffixes[i]) )
+        {
+            removeDir(tmp);
+            return;
+        }
+    }
+
+    // another process may have stored the same entry in the meantime
+    if ( rename(tmp.c_str(), entryDir().c_str()) != 0 )
+        removeDir(tmp);
+
+    evict();
+}
+
+std::string CompileCache::entryDir() const
+{
+    char buffer[33];
+    snprintf( buffer, sizeof(buffer), "%016llx%016llx", 
+            (unsigned long long) hash1_, (unsigned long long) hash2_ );
+
+    return dir_ + "/" + buffer;
+}
+
+void CompileCache::hash(const char* data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash1_ = (hash1_ ^ (unsigned char) data[i]) * FNV_PRIME;
+        hash2_ = (hash2_ ^ (unsigned char) data[i]) * FNV_PRIME;
+    }
+}
+
+bool CompileCache::hashFile(const char* filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+        return false;
+
+    char buffer[4096];
+    while (in)
+    {
+        in.read( buffer, sizeof(buffer) );
+        hash( buffer, in.gcount() );
+    }
+
+    // separate the files
+    hash("", 1);
+
+    return true;
+}
+
+/*
+ * Removes the entries with the oldest modification time until the cache fits
+ * into maxSize_.
+ */
+void CompileCache::evict()
+{
+    typedef std::pair<time_t, std::string> Entry;
+    std::vector<Entry> entries;
+    std::vector<uint64_t> sizes;
+    uint64_t total = 0;
+
+    DIR* dir = opendir( dir_.c_str() );
+    if (!dir)
+        return;
+
+    while ( struct dirent* d = readdir(dir) )
+    {
+        std::string name = d->d_name;
+        // skip . and .. as well as entries currently written
+        if ( name[0] == '.' || name.find(".tmp.") != std::string::npos )
+            continue;
+
+        std::string path = dir_ + "/" + name;
+        struct stat st;
+        if ( stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) )
+            continue;
+
+        entries.push_back( Entry(st.st_mtime, path) );
+    }
+
+    closedir(dir);
+
+    std::sort( entries.begin(), entries.end() );
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        uint64_t size = 0;
+
+        if ( DIR* entry = opendir(entries[i].second.c_str()) )
+        {
+            while ( struct dirent* d = readdir(entry) )
+            {
+                struct stat st;
+                std::string path = entries[i].second + "/" + d->d_name;
+
+                if ( stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) )
+                    size += st.st_size;
+            }
+
+            closedir(entry);
+        }
+
+        sizes.push_back(size);
+        total += size;
+    }
+
+    for (size_t i = 0; i < entries.size() && total > maxSize_; ++i)
+    {
+        removeDir(entries[i].second);
+        total -= sizes[i];
+    }
+}
+
+bool CompileCache::copyFile(const std::string& from, const std::string& to)
+{
+    std::ifstream in(from.c_str(), std::ios::binary);
+    std::ofstream out(to.c_str(), std::ios::binary);
+
+    if (!in || !out)
+        return false;
+
+    out << in.rdbuf();
+
+    return out.good();
+}
+
+void CompileCache::removeDir(const std::string& path)
+{
+    if ( DIR* dir = opendir(path.c_str()) )
+    {
+        while ( struct dirent* d = readdir(dir) )
+        {
+            std::string name = d->d_name;
+            if (name != "." && name != "..")
+                unlink( (path + "/" + name).c_str() );
+        }
+
+        closedir(dir);
+    }
+
+    rmdir( path.c_str() );
+}
+
+bool CompileCache::makeDirs(const std::string& dir)
+{
+    for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1))
+    {
+        std::string prefix = dir.substr(0, pos);
+
+        if ( mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST )
+            return false;
+
+        if (pos == std::string::npos)
+            return true;
+    }
+}
+
+} // namespace swift
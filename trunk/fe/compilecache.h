@@ -0,0 +1,65 @@
+#ifndef SWIFT_COMPILECACHE_H
+#define SWIFT_COMPILECACHE_H
+
+#include <string>
+#include <vector>
+
+#include "utils/types.h"
+
+namespace swift {
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Cache of compiler outputs in a local directory.
+ *
+ * An entry is keyed on a hash of the input file, the builtin library files,
+ * the command line options and the compiler binary itself. It is a directory holding
+ * the output files by suffix, e.g. ".bc" or ".o" for x.swift.bc or x.swift.o.
+ *
+ * The total size of the cache is bounded; the least recently used entries are
+ * evicted first. The modification time of an entry is its time of last use.
+ */
+class CompileCache
+{
+public:
+
+    CompileCache(const std::string& dir, uint64_t maxSize);
+
+    /**
+     * Computes the key of this compilation. 
+     *
+     * @return false if one of the files could not be read
+     */
+    bool computeKey(int argc, char** argv, const char* filename, const std::vector<const char*>& builtin);
+
+    /// Copies the outputs of a hit next to \p filename and returns true.
+    bool lookup(const std::string& filename);
+
+    /// Stores the files filename + suffixes[i] and evicts old entries.
+    void store(const std::string& filename, const std::vector<std::string>& suffixes);
+
+private:
+
+    std::string entryDir() const;
+    void hash(const char* data, size_t size);
+    bool hashFile(const char* filename);
+    void evict();
+
+    static bool copyFile(const std::string& from, const std::string& to);
+    static void removeDir(const std::string& dir);
+    static bool makeDirs(const std::string& dir);
+
+    std::string dir_;
+    uint64_t maxSize_;
+
+    // two FNV-1a hashes with different offset bases
+    uint64_t hash1_;
+    uint64_t hash2_;
+};
+
+//------------------------------------------------------------------------------
+
+} // namespace swift
+
+#endif // SWIFT_COMPILECACHE_H
@@ -0,0 +1,458 @@
+#include "fe/constfold.h"
+
+#include <cmath>
+
+#include "utils/assert.h"
+
+#include "fe/type.h"
+
+namespace swift {
+
+/*
+ * helpers
+ */
+
+static int numBits(const ScalarType* type)
+{
+    return type->sizeOf() * 8;
+}
+
+static uint64_t mask(const ScalarType* type, uint64_t val)
+{
+    int bits = numBits(type);
+    return bits == 64 ? val : val & ((1ull << bits) - 1ull);
+}
+
+static int64_t getSigned(const ScalarType* type, Box box)
+{
+    int bits = numBits(type);
+    uint64_t val = mask(type, box.uint64_);
+
+    if ( bits != 64 && (val & (1ull << (bits - 1))) )
+        val |= ~((1ull << bits) - 1ull); // sign-extend
+
+    return int64_t(val);
+}
+
+static uint64_t getUnsigned(const ScalarType* type, Box box)
+{
+    return mask(type, box.uint64_);
+}
+
+static int64_t minSigned(const ScalarType* type)
+{
+    return -int64_t( 1ull << (numBits(type) - 1) );
+}
+
+static int64_t maxSigned(const ScalarType* type)
+{
+    return int64_t( (1ull << (numBits(type) - 1)) - 1ull );
+}
+
+static uint64_t maxUnsigned(const ScalarType* type)
+{
+    return mask(type, ~0ull);
+}
+
+static Box makeInt(const ScalarType* type, uint64_t val)
+{
+    Box box;
+    box.uint64_ = mask(type, val);
+    return box;
+}
+
+static Box makeBool(bool val)
+{
+    Box box;
+    box.bool_ = val;
+    return box;
+}
+
+static double getFloat(const ScalarType* type, Box box)
+{
+    return type->sizeOf() == 8 ? box.double_ : box.float_;
+}
+
+static Box makeFloat(const ScalarType* type, double val)
+{
+    Box box;
+    if ( type->sizeOf() == 8 )
+        box.double_ = val;
+    else
+        box.float_ = float(val);
+
+    return box;
+}
+
+/// Clamps \p val of the signed 64 bit intermediate result to the range of \p type.
+static Box clamp(const ScalarType* type, int64_t val)
+{
+    if ( type->isSigned() )
+    {
+        if ( val < minSigned(type) )
+            val = minSigned(type);
+        else if ( val > maxSigned(type) )
+            val = maxSigned(type);
+    }
+    else
+    {
+        if (val < 0)
+            val = 0;
+        else if ( uint64_t(val) > maxUnsigned(type) )
+            val = maxUnsigned(type);
+    }
+
+    return makeInt( type, uint64_t(val) );
+}
+
+//------------------------------------------------------------------------------
+
+TokenType scalar2LiteralToken(const ScalarType* type)
+{
+    const std::string& id = *type->id();
+
+    if (id == "index")  return Token::L_INDEX;
+
+    if (id == "int")    return Token::L_INT;
+    if (id == "int8")   return Token::L_INT8;
+    if (id == "int16")  return Token::L_INT16;
+    if (id == "int32")  return Token::L_INT32;
+    if (id == "int64")  return Token::L_INT64;
+    if (id == "sat8")   return Token::L_SAT8;
+    if (id == "sat16")  return Token::L_SAT16;
+
+    if (id == "uint")   return Token::L_UINT;
+    if (id == "uint8")  return Token::L_UINT8;
+    if (id == "uint16") return Token::L_UINT16;
+    if (id == "uint32") return Token::L_UINT32;
+    if (id == "uint64") return Token::L_UINT64;
+    if (id == "usat8")  return Token::L_USAT8;
+    if (id == "usat16") return Token::L_USAT16;
+
+    if (id == "real")   return Token::L_REAL;
+    if (id == "real32") return Token::L_REAL32;
+    if (id == "real64") return Token::L_REAL64;
+
+    swiftAssert(id == "bool", "illegal scalar type");
+    return Token::L_BOOL;
+}
+
+bool foldBinOp(const std::string& op, const ScalarType* type, Box op1, Box op2, Box& result)
+{
+    /*
+     * bools
+     */
+
+    if ( type->isBool() )
+    {
+        bool b1 = op1.bool_;
+        bool b2 = op2.bool_;
+
+        if      (op == "&")  result = makeBool(b1 & b2);
+        else if (op == "|")  result = makeBool(b1 | b2);
+        else if (op == "^")  result = makeBool(b1 ^ b2);
+        else if (op == "==") result = makeBool(b1 == b2);
+        else if (op == "!=") result = makeBool(b1 != b2);
+        else
+            return false;
+
+        return true;
+    }
+
+    /*
+     * floats -- computed in the precision of the type
+     */
+
+    if ( type->isFloat() )
+    {
+        double d1 = getFloat(type, op1);
+        double d2 = getFloat(type, op2);
+        bool isDouble = type->sizeOf() == 8;
+        float f1 = float(d1);
+        float f2 = float(d2);
+
+        if      (op == "+")  result = isDouble ? makeFloat(type, d1 + d2) : makeFloat(type, f1 + f2);
+        else if (op == "-")  result = isDouble ? makeFloat(type, d1 - d2) : makeFloat(type, f1 - f2);
+        else if (op == "*")  result = isDouble ? makeFloat(type, d1 * d2) : makeFloat(type, f1 * f2);
+        else if (op == "/")  result = isDouble ? makeFloat(type, d1 / d2) : makeFloat(type, f1 / f2);
+        else if (op == "**") result = isDouble ? makeFloat(type, std::pow(d1, d2)) : makeFloat(type, std::pow(f1, f2));
+        // ordered comparisons just like the generated fcmps
+        else if (op == "==") result = makeBool(d1 == d2);
+        else if (op == "!=") result = makeBool(d1 < d2 || d1 > d2);
+        else if (op == "<")  result = makeBool(d1 <  d2);
+        else if (op == ">")  result = makeBool(d1 >  d2);
+        else if (op == "<=") result = makeBool(d1 <= d2);
+        else if (op == ">=") result = makeBool(d1 >= d2);
+        else
+            return false;
+
+        return true;
+    }
+
+    /*
+     * integers
+     */
+
+    if ( !type->isInteger() )
+        return false;
+
+    bool isSigned = type->isSigned();
+    int64_t  s1 = getSigned(type, op1);
+    int64_t  s2 = getSigned(type, op2);
+    uint64_t u1 = getUnsigned(type, op1);
+    uint64_t u2 = getUnsigned(type, op2);
+
+    if ( type->isSaturating() && (op == "+" || op == "-" || op == "*" || op == "/") )
+    {
+        // sat8 and sat16 fit into 64 bits even when multiplied
+        int64_t w1 = isSigned ? s1 : int64_t(u1);
+        int64_t w2 = isSigned ? s2 : int64_t(u2);
+
+        if      (op == "+") result = clamp(type, w1 + w2);
+        else if (op == "-") result = clamp(type, w1 - w2);
+        else if (op == "*") result = clamp(type, w1 * w2);
+        else
+        {
+            if (w2 == 0)
+                return false;
+
+            result = clamp(type, w1 / w2);
+        }
+
+        return true;
+    }
+
+    if      (op == "+") result = makeInt(type, u1 + u2);
+    else if (op == "-") result = makeInt(type, u1 - u2);
+    else if (op == "*") result = makeInt(type, u1 * u2);
+    else if (op == "/")
+    {
+        if (u2 == 0)
+            return false;
+
+        if (isSigned)
+        {
+            // overflows
+            if ( s1 == minSigned(type) && s2 == -1 )
+                return false;
+
+            result = makeInt( type, uint64_t(s1 / s2) );
+        }
+        else
+            result = makeInt(type, u1 / u2);
+    }
+    else if (op == "&") result = makeInt(type, u1 & u2);
+    else if (op == "|") result = makeInt(type, u1 | u2);
+    else if (op == "^") result = makeInt(type, u1 ^ u2);
+    else if (op == "<<" || op == ">>")
+    {
+        // shifting by the bit width or more is undefined
+        if ( u2 >= uint64_t(numBits(type)) )
+            return false;
+
+        if (op == "<<")
+            result = makeInt(type, u1 << u2);
+        else if (isSigned)
+            result = makeInt( type, uint64_t(s1 >> s2) );
+        else
+            result = makeInt(type, u1 >> u2);
+    }
+    else if (op == "==") result = makeBool(u1 == u2);
+    else if (op == "!=") result = makeBool(u1 != u2);
+    else if (op == "<")  result = makeBool(isSigned ? s1 <  s2 : u1 <  u2);
+    else if (op == ">")  result = makeBool(isSigned ? s1 >  s2 : u1 >  u2);
+    else if (op == "<=") result = makeBool(isSigned ? s1 <= s2 : u1 <= u2);
+    else if (op == ">=") result = makeBool(isSigned ? s1 >= s2 : u1 >= u2);
+    else
+        return false;
+
+    return true;
+}
+
+bool foldUnOp(const std::string& op, const ScalarType* type, Box op1, Box& result)
+{
+    if ( type->isBool() )
+    {
+        if (op == "!" || op == "~")
+        {
+            result = makeBool(!op1.bool_);
+            return true;
+        }
+
+        return false;
+    }
+
+    if ( type->isFloat() )
+    {
+        if (op == "+")
+            result = op1;
+        else if (op == "-")
+            result = makeFloat( type, -getFloat(type, op1) );
+        else
+            return false;
+
+        return true;
+    }
+
+    if ( !type->isInteger() )
+        return false;
+
+    if (op == "+")
+        result = makeInt( type, getUnsigned(type, op1) );
+    else if (op == "-")
+    {
+        if ( type->isSaturating() )
+        {
+            int64_t val = type->isSigned() ? getSigned(type, op1) : int64_t( getUnsigned(type, op1) );
+            result = clamp(type, -val);
+        }
+        else
+            result = makeInt( type, 0ull - getUnsigned(type, op1) );
+    }
+    else if (op == "!" || op == "~")
+        result = makeInt( type, ~getUnsigned(type, op1) );
+    else
+        return false;
+
+    return true;
+}
+
+bool foldMethod(const std::string& id, const ScalarType* from, const ScalarType* to, Box val, Box arg, Box& result)
+{
+    if ( from->isBool() || to->isBool() )
+        return false;
+
+    if ( id.find("bitcast") != std::string::npos )
+    {
+        if ( from->sizeOf() != to->sizeOf() )
+            return false;
+
+        result = val;
+        if ( to->isInteger() )
+            result = makeInt( to, getUnsigned(from, val) );
+
+        return true;
+    }
+
+    if (id == "sqrt")
+    {
+        if ( !from->isFloat() )
+            return false;
+
+        double d = getFloat(from, val);
+        if (d < 0.0)
+            return false;
+
+        result = from->sizeOf() == 8 ? makeFloat( from, std::sqrt(d) ) : makeFloat( from, std::sqrt(float(d)) );
+        return true;
+    }
+
+    if (id == "min" || id == "max")
+    {
+        bool isMax = id == "max";
+        bool cond;
+
+        // same selection as the generated code
+        if ( from->isFloat() )
+        {
+            double d1 = getFloat(from, val);
+            double d2 = getFloat(from, arg);
+            cond = isMax ? d1 > d2 : d1 < d2;
+        }
+        else if ( from->isSigned() )
+        {
+            int64_t s1 = getSigned(from, val);
+            int64_t s2 = getSigned(from, arg);
+            cond = isMax ? s1 > s2 : s1 < s2;
+        }
+        else
+        {
+            uint64_t u1 = getUnsigned(from, val);
+            uint64_t u2 = getUnsigned(from, arg);
+            cond = isMax ? u1 > u2 : u1 < u2;
+        }
+
+        result = cond ? val : arg;
+        return true;
+    }
+
+    /*
+     * casts
+     */
+
+    if ( from->isInteger() && to->isInteger() )
+    {
+        // clamping is a no-op if the range of from is contained in the one of to
+        if ( to->isSaturating() )
+        {
+            if ( from->isSigned() )
+                result = clamp( to, getSigned(from, val) );
+            else
+            {
+                uint64_t u = getUnsigned(from, val);
+                result = clamp( to, u > maxUnsigned(to) ? int64_t(maxUnsigned(to)) : int64_t(u) );
+            }
+        }
+        else if ( from->sizeOf() == to->sizeOf() )
+            result = makeInt( to, getUnsigned(from, val) );
+        else if ( from->isUnsigned() )
+            result = makeInt( to, getUnsigned(from, val) );
+        else
+            result = makeInt( to, uint64_t(getSigned(from, val)) );
+
+        return true;
+    }
+
+    if ( from->isFloat() && to->isInteger() )
+    {
+        double d = getFloat(from, val);
+
+        // out of range conversions are undefined
+        if ( to->isSigned() )
+        {
+            if ( !(d > double(minSigned(to)) - 1.0 && d < -double(minSigned(to))) )
+                return false;
+
+            result = makeInt( to, uint64_t(int64_t(d)) );
+        }
+        else
+        {
+            if ( !(d > -1.0 && d < double(maxUnsigned(to)) + 1.0) )
+                return false;
+
+            result = makeInt( to, uint64_t(d) );
+        }
+
+        return true;
+    }
+
+    if ( from->isInteger() && to->isFloat() )
+    {
+        if ( to->sizeOf() == 8 )
+        {
+            if ( from->isSigned() )
+                result = makeFloat( to, double(getSigned(from, val)) );
+            else
+                result = makeFloat( to, double(getUnsigned(from, val)) );
+        }
+        else
+        {
+            // convert directly to float in order to round only once
+            Box box;
+            box.float_ = from->isSigned() ? float(getSigned(from, val)) : float(getUnsigned(from, val));
+            result = box;
+        }
+
+        return true;
+    }
+
+    if ( from->isFloat() && to->isFloat() )
+    {
+        result = makeFloat( to, getFloat(from, val) );
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace swift
@@ -0,0 +1,37 @@
+#ifndef SWIFT_CONSTFOLD_H
+#define SWIFT_CONSTFOLD_H
+
+#include <string>
+
+#include "utils/box.h"
+
+#include "fe/token.h"
+
+namespace swift {
+
+class ScalarType;
+
+/*
+ * Compile time evaluation of the builtin operations on scalar types.
+ *
+ * Integers are kept zero-extended in Box::uint64_, real and real32 in
+ * Box::float_ and real64 in Box::double_ -- just like the lexer does. All
+ * functions return false if the result is not defined at compile time, e.g.
+ * on a division by zero; the operation is then left to run time.
+ */
+
+/// Returns the literal token of \p type.
+TokenType scalar2LiteralToken(const ScalarType* type);
+
+/// Evaluates \p op1 \p op \p op2; comparisons yield a bool.
+bool foldBinOp(const std::string& op, const ScalarType* type, Box op1, Box op2, Box& result);
+
+/// Evaluates \p op \p op1.
+bool foldUnOp(const std::string& op, const ScalarType* type, Box op1, Box& result);
+
+/// Evaluates the builtin method \p id of \p from with \p arg as argument if needed.
+bool foldMethod(const std::string& id, const ScalarType* from, const ScalarType* to, Box val, Box arg, Box& result);
+
+} // namespace swift
+
+#endif // SWIFT_CONSTFOLD_H
@@ -19,10 +19,18 @@ namespace swift {
 Context::Context(Module* module)
     : result_(true)
     , module_(module)
+    , class_(0)
+    , memberFct_(0)
     , tuple_( new TNList() )
     , builder_( LLVMBuilder(*module->lctxt_) )
     , simdIndex_(0)
+    , parallelSimd_(false)
+    , streamThreshold_(0)
+    , prefetchDistance_(0)
+    , streaming_(false)
+    , fpModel_(FP_CONTRACT)
     , currentLoop_(0)
+    , currentSimdLoop_(0)
 {}
 
 Context::~Context()
@@ -1,6 +1,7 @@
 #ifndef SWIFT_CONTEXT_H
 #define SWIFT_CONTEXT_H
 
+#include <map>
 #include <stack>
 #include <vector>
 
@@ -20,8 +21,10 @@ class LoopStmnt;
 class MemberFct;
 class Module;
 class Scope;
+class SimdLoop;
 class Stmnt;
 class TNList;
+class Var;
 
 class Context
 {
@@ -32,6 +35,19 @@ public:
         SIMD_WIDTH = 16
     };
 
+    /// How strictly floating point operations follow IEEE 754.
+    enum FPModel
+    {
+        FP_STRICT,   ///< No contraction, no reassociation.
+        /**
+         * a*b + c may become a fused multiply-add and float reductions of
+         * simd loops accumulate per lane and combine the lanes at the end;
+         * otherwise like FP_STRICT.
+         */
+        FP_CONTRACT,
+        FP_FAST      ///< Assume finite values and reassociate freely.
+    };
+
     Context(Module* module);
     ~Context();
 
@@ -64,8 +80,17 @@ public:
     llvm::Module* lmodule();
 
     llvm::Value* simdIndex_;
+    bool parallelSimd_; ///< Outline simd loops and run them on all cores.
+    uint64_t streamThreshold_; ///< Minimal trip count of streaming simd loops.
+    unsigned prefetchDistance_; ///< In simd steps.
+    bool streaming_; ///< Is the current simd loop a streaming one?
+    FPModel fpModel_;
 
     LoopStmnt* currentLoop_;
+    SimdLoop* currentSimdLoop_;
+
+    /// Number of uses of each variable.
+    std::map<Var*, size_t> varUses_;
 
 private:
 
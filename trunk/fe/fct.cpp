@@ -2,6 +2,9 @@
 
 #include "utils/cast.h"
 #include "utils/llvmplace.h"
+#include "utils/stringhelper.h"
+
+#include "vec/vectype.h"
 
 #include "fe/class.h"
 #include "fe/context.h"
@@ -12,6 +15,7 @@
 #include "fe/typenodecodegen.h"
 
 #include <llvm/Support/IRBuilder.h>
+#include <llvm/DerivedTypes.h>
 #include <llvm/Function.h>
 
 using llvm::Value;
@@ -20,6 +24,11 @@ static void copy(LLVMBuilder& builder, Place* lPlace, Place* rPlace)
 {
     Value* lvalue = lPlace->getAddr(builder);
     Value* rvalue = rPlace->getScalar(builder);
+
+    // vectorized bools are stored as masks
+    if ( vec::isPredicate(rvalue->getType()) )
+        rvalue = vec::toMask( builder, rvalue, cast<llvm::PointerType>(lvalue->getType())->getElementType() );
+
     builder.CreateStore(rvalue, lvalue);
     lPlace->writeBack(builder);
 }
@@ -74,14 +83,16 @@ inline bool AssignCreate::isPairwise() const
 
 void AssignCreate::check()
 {
-    std::string name = isDecl_ ? "create"      : *id_;
-    std::string kind = isDecl_ ? "constructor" : "assignment";
+    static const std::string* create = intern("create");
+
+    const std::string* name = isDecl_ ? create        : id_;
+    std::string kind        = isDecl_ ? "constructor" : "assignment";
 
     info_ = lType_->hasMemberFct(name, rTypes_, ctxt_->module_);
 
     if ( info_.kind_ == MemberFctInfo::FALSE )
     {
-        missingMemberFctError( loc_, kind, name, rTypes_, lType_->toString().c_str() );
+        missingMemberFctError( loc_, kind, *name, rTypes_, lType_->toString().c_str() );
         ctxt_->result_ = false;
         return;
     }
@@ -198,6 +209,9 @@ void AssignCreate::genCode()
             args.push_back( lPlace->getAddr(builder) );
             rhs_->getArgs(builder, args, rBegin_, rEnd_);
 
+            if ( lType_->isSimd() )
+                memFct->prepareSimdArgs(builder, args);
+
             // create call
             appendCall( builder, llvmFct, args.begin(), args.end() );
 
@@ -17,22 +17,21 @@ FctVectorizer::FctVectorizer(Context* ctxt)
     : ctxt_(ctxt)
     //, packetizer_( Packetizer::getPacketizer(true, false) ) // TODO use cmdline switch for sse 4.1 selection
 {
-    typedef Module::ClassMap::const_iterator CIter;
-    const Module::ClassMap& classes = ctxt_->module_->classes();
+    const Module::Classes& classes = ctxt_->module_->classes();
 
     // for each class
-    for (CIter iter = classes.begin(); iter != classes.end(); ++iter)
+    for (size_t i = 0; i < classes.size(); ++i)
     {
-        Class* c = iter->second;
+        Class* c = classes[i];
 
         // skip builtin types
         if ( ScalarType::isScalar(c->id()) )
             continue;
 
         // for each member fct
-        for (size_t i = 0, end = c->memberFcts().size(); i < end; ++i)
+        for (size_t j = 0, end = c->memberFcts().size(); j < end; ++j)
         {
-            MemberFct* m = c->memberFcts()[i];
+            MemberFct* m = c->memberFcts()[j];
 
             if ( m->isSimd() && !m->isAutoGenerated() )
                 process(c, m);
@@ -40,17 +39,6 @@ FctVectorizer::FctVectorizer(Context* ctxt)
     }
 
 
-    using namespace llvm::Intrinsic;
-    const llvm::Type* llvmTypes[1];
-    llvmTypes[0] = llvm::VectorType::get(
-        llvm::TypeBuilder<llvm::types::ieee_float,  true>::get(ctxt_->lctxt()), 4); // HACK
-
-    llvm::Function* powFct = getDeclaration(
-            ctxt_->lmodule(), llvm::Intrinsic::pow, llvmTypes, 1);
-
-    //Packetizer::addNativeFunctionToPacketizer(
-            //packetizer_, "llvm.pow.f32", -1, powFct, false);
-
     //Packetizer::runPacketizer( packetizer_, ctxt_->lmodule() );
 }
 
@@ -0,0 +1,112 @@
+#include "fe/jit.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <llvm/Module.h>
+#include <llvm/ModuleProvider.h>
+#include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/JIT.h>
+#include <llvm/Target/TargetSelect.h>
+
+#include "utils/types.h"
+
+/*
+ * test/lib.c and test/parallel.c
+ */
+
+extern "C" {
+
+void start_timer();
+void stop_timer();
+void bench_begin();
+void bench_end();
+float rand_float();
+void println();
+void print_int(int n);
+void print_uint(int n);
+void print_byte(int n);
+void print_float(float f);
+void print_hexfloat(float f);
+void print_double(double d);
+
+void swift_parallel_for(void (*fct)(void*, int64_t, int64_t), void* env, int64_t lower, int64_t upper, int64_t step);
+void swift_parallel_lock();
+void swift_parallel_unlock();
+
+}
+
+namespace swift {
+
+struct RuntimeSymbol
+{
+    const char* name_;
+    void* addr_;
+};
+
+static RuntimeSymbol runtimeSymbols[] = {
+    { "start_timer",           (void*) start_timer },
+    { "stop_timer",            (void*) stop_timer },
+    { "bench_begin",           (void*) bench_begin },
+    { "bench_end",             (void*) bench_end },
+    { "rand_float",            (void*) rand_float },
+    { "println",               (void*) println },
+    { "print_int",             (void*) print_int },
+    { "print_uint",            (void*) print_uint },
+    { "print_byte",            (void*) print_byte },
+    { "print_float",           (void*) print_float },
+    { "print_hexfloat",        (void*) print_hexfloat },
+    { "print_double",          (void*) print_double },
+    { "swift_parallel_for",    (void*) swift_parallel_for },
+    { "swift_parallel_lock",   (void*) swift_parallel_lock },
+    { "swift_parallel_unlock", (void*) swift_parallel_unlock },
+    { 0, 0 }
+};
+
+int runJIT(llvm::Module* m, const char* filename)
+{
+    llvm::InitializeNativeTarget();
+
+    llvm::ExistingModuleProvider* mp = new llvm::ExistingModuleProvider(m);
+    std::string error;
+    llvm::ExecutionEngine* ee = llvm::ExecutionEngine::create(mp, false, &error);
+
+    if (!ee)
+    {
+        std::cerr << "error: failed to create JIT: " << error << std::endl;
+        mp->releaseModule();
+        delete mp;
+        return -1;
+    }
+
+    // only map what is actually used
+    for (RuntimeSymbol* sym = runtimeSymbols; sym->name_; ++sym)
+    {
+        if ( llvm::Function* fct = m->getFunction(sym->name_) )
+            ee->addGlobalMapping(fct, sym->addr_);
+    }
+
+    int result = -1;
+
+    if ( llvm::Function* mainFct = m->getFunction("main") )
+    {
+        std::vector<std::string> args;
+        args.push_back(filename);
+
+        ee->runStaticConstructorsDestructors(false);
+        result = ee->runFunctionAsMain(mainFct, args, 0);
+        ee->runStaticConstructorsDestructors(true);
+    }
+    else
+        std::cerr << "error: there is no main routine to run" << std::endl;
+
+    // hand m back to the caller
+    ee->removeModuleProvider(mp);
+    delete ee;
+    delete mp;
+
+    return result;
+}
+
+} // namespace swift
@@ -0,0 +1,24 @@
+#ifndef SWIFT_JIT_H
+#define SWIFT_JIT_H
+
+namespace llvm {
+    class Module;
+}
+
+namespace swift {
+
+/**
+ * JIT-compiles \p m in-process and runs its main function. 
+ *
+ * The support functions of test/lib.c and the runtime of parallel simd loops
+ * in test/parallel.c are linked into the compiler and mapped to their
+ * declarations in \p m. Everything else is looked up in the running process,
+ * e.g. libm. \p m is still owned by the caller afterwards.
+ *
+ * @return the result of main or -1 if the JIT could not be created
+ */
+int runJIT(llvm::Module* m, const char* filename);
+
+} // namespace swift
+
+#endif // SWIFT_JIT_H
@@ -15,25 +15,70 @@
 
 namespace swift {
 
+/*
+ * Vector registers available for the arguments and the return values of a
+ * simd routine -- xmm0-7 and xmm0-3 on x86-64.
+ */
+static const unsigned SIMD_ARG_REGS = 8;
+static const unsigned SIMD_RET_REGS = 4;
+
+/// Returns the number of vector registers a value of \p type occupies.
+static unsigned numVecRegs(const llvm::Type* type)
+{
+    if ( const llvm::StructType* st = dynamic<llvm::StructType>(type) )
+    {
+        unsigned result = 0;
+        for (unsigned i = 0; i < st->getNumElements(); ++i)
+            result += numVecRegs( st->getElementType(i) );
+
+        return result;
+    }
+
+    if ( const llvm::VectorType* vt = dynamic<llvm::VectorType>(type) )
+    {
+        unsigned bits = Context::SIMD_WIDTH * 8;
+        return (vt->getBitWidth() + bits - 1) / bits;
+    }
+
+    return 1;
+}
+
+/*
+ * Returns the aggregate \p type points to if it fits into the remaining
+ * \p regs and 0 otherwise.
+ */
+static const llvm::Type* byValue(const llvm::Type* type, unsigned& regs)
+{
+    const llvm::PointerType* ptr = dynamic<llvm::PointerType>(type);
+    if ( !ptr || !dynamic<llvm::StructType>(ptr->getElementType()) )
+        return 0;
+
+    unsigned num = numVecRegs( ptr->getElementType() );
+    if (num > regs)
+        return 0;
+
+    regs -= num;
+    return ptr->getElementType();
+}
+
 LLVMFctDeclarer::LLVMFctDeclarer(Context* ctxt)
     : ctxt_(ctxt)
 {
-    typedef Module::ClassMap::const_iterator CIter;
-    const Module::ClassMap& classes = ctxt_->module_->classes();
+    const Module::Classes& classes = ctxt_->module_->classes();
 
     // for each class
-    for (CIter iter = classes.begin(); iter != classes.end(); ++iter)
+    for (size_t i = 0; i < classes.size(); ++i)
     {
-        Class* c = iter->second;
+        Class* c = classes[i];
 
         // skip builtin types
         if ( ScalarType::isScalar(c->id()) )
             continue;
 
         // for each member fct
-        for (size_t i = 0; i < c->memberFcts().size(); ++i)
+        for (size_t j = 0; j < c->memberFcts().size(); ++j)
         {
-            MemberFct* m = c->memberFcts()[i];
+            MemberFct* m = c->memberFcts()[j];
 
             if ( !m->isAutoGenerated() )
                 process(c, m);
@@ -112,6 +157,16 @@ void LLVMFctDeclarer::process(Class* c, MemberFct* m)
     bool simd = m->isSimd();
     LLVMTypes simdParams;
 
+    /*
+     * Aggregates which are not written by the callee travel by value in
+     * vector registers in the simd version as long as there are registers
+     * left. This holds for a const 'this', const params and per-ref return
+     * values.
+     */
+
+    unsigned argRegs = SIMD_ARG_REGS;
+    unsigned retRegs = SIMD_RET_REGS;
+
     /*
      * create llvm function type
      */
@@ -122,7 +177,16 @@ void LLVMFctDeclarer::process(Class* c, MemberFct* m)
         m->params_.push_back( llvm::PointerType::getUnqual(c->getLLVMType()) );
 
         if (simd)
-            simdParams.push_back( llvm::PointerType::getUnqual(c->getVecType()) );
+        {
+            const llvm::Type* thisType = llvm::PointerType::getUnqual( c->getVecType() );
+            const llvm::Type* val = 0;
+
+            if ( !m->constructor_ && m->getVarOrConst() == Token::CONST )
+                val = byValue(thisType, argRegs);
+
+            simdParams.push_back(val ? val : thisType);
+            m->simdByValue_.push_back(val != 0);
+        }
     }
 
     const llvm::Type* simdRetType;
@@ -162,7 +226,18 @@ void LLVMFctDeclarer::process(Class* c, MemberFct* m)
                 m->realIn_.push_back(retval);
 
                 if (simd)
-                    simdParams.push_back(simdType);
+                {
+                    const llvm::Type* val = byValue(simdType, retRegs);
+                    m->simdRetByValue_.push_back(val != 0);
+
+                    if (val)
+                        simdRetTypes.push_back(val);
+                    else
+                    {
+                        simdParams.push_back(simdType);
+                        m->simdByValue_.push_back(false);
+                    }
+                }
             }
             else
             {
@@ -175,17 +250,15 @@ void LLVMFctDeclarer::process(Class* c, MemberFct* m)
         }
 
         if ( m->realOut_.empty() )
-        {
             m->retType_ = createVoid(lctxt);
-
-            if (simd)
-                simdRetType = createVoid(lctxt);
-        }
         else
-        {
             m->retType_ = llvm::StructType::get(lctxt, retTypes);
 
-            if (simd)
+        if (simd)
+        {
+            if ( simdRetTypes.empty() )
+                simdRetType = createVoid(lctxt);
+            else
                 simdRetType = llvm::StructType::get(lctxt, simdRetTypes);
         }
     }
@@ -200,7 +273,14 @@ void LLVMFctDeclarer::process(Class* c, MemberFct* m)
         if (simd)
         {
             int simdLength;
-            simdParams.push_back( io->getType()->getVecLLVMType(module, simdLength) );
+            const llvm::Type* simdType = io->getType()->getVecLLVMType(module, simdLength);
+            const llvm::Type* val = 0;
+
+            if ( !io->getType()->isVar() )
+                val = byValue(simdType, argRegs);
+
+            simdParams.push_back(val ? val : simdType);
+            m->simdByValue_.push_back(val != 0);
         }
     }
 
@@ -251,24 +331,30 @@ void LLVMFctDeclarer::process(Class* c, MemberFct* m)
         fct->setCallingConv(llvm::CallingConv::Fast);
 
         if (simd)
+        {
+            m->simdFct_->setCallingConv(llvm::CallingConv::Fast);
             m->simdFct_->addFnAttr(llvm::Attribute::NoUnwind);
+        }
     }
     else
         fct->addFnAttr(llvm::Attribute::NoUnwind);
 
     // add noalias for all pointer args
+    addNoAlias(fct);
+
+    if (simd)
+        addNoAlias(m->simdFct_);
+}
+
+void LLVMFctDeclarer::addNoAlias(llvm::Function* fct)
+{
     unsigned index = 1;
     llvm::Function::arg_iterator iter = fct->arg_begin();
     while ( iter != fct->arg_end() )
     {
         if ( dynamic<llvm::PointerType>(iter->getType()) )
-        {
             fct->addAttribute(index, llvm::Attribute::NoAlias);
 
-            if (simd)
-                m->simdFct_->addAttribute(index, llvm::Attribute::NoAlias);
-        }
-
         ++iter;
         ++index;
     }
@@ -1,6 +1,10 @@
 #ifndef SWIFT_LLVM_FCT_DECLARER_H
 #define SWIFT_LLVM_FCT_DECLARER_H
 
+namespace llvm {
+    class Function;
+}
+
 namespace swift {
 
 class Context;
@@ -16,6 +20,7 @@ public:
 private:
 
     void process(Class* c, MemberFct* m);
+    void addNoAlias(llvm::Function* fct);
 
     Context* ctxt_;
 };
@@ -15,18 +15,16 @@ using llvm::StructType;
 
 namespace swift {
 
-typedef Module::ClassMap::const_iterator CIter;
-
 LLVMTypebuilder::LLVMTypebuilder(Context* ctxt)
     : ctxt_(ctxt)
 {
-    const Module::ClassMap& classes = ctxt_->module_->classes();
+    const Module::Classes& classes = ctxt_->module_->classes();
     Module* m = ctxt_->module_;
     llvm::Module* lm = ctxt_->lmodule();
 
-    for (CIter iter = classes.begin(); iter != classes.end(); ++iter)
+    for (size_t i = 0; i < classes.size(); ++i)
     {
-        Class* c = iter->second;
+        Class* c = classes[i];
 
         // skip builtin types
         if ( ScalarType::isScalar(c->id()) )
@@ -63,9 +61,9 @@ LLVMTypebuilder::LLVMTypebuilder(Context* ctxt)
      * now vectorize types
      */
 
-    for (CIter iter = classes.begin(); iter != classes.end(); ++iter)
+    for (size_t i = 0; i < classes.size(); ++i)
     {
-        Class* c = iter->second;
+        Class* c = classes[i];
 
         // skip builtin types
         if ( ScalarType::isScalar(c->id()) )
@@ -18,6 +18,7 @@
  */
 
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -26,21 +27,32 @@
 #include <sstream>
 
 #include <llvm/Module.h>
+#include <llvm/Pass.h>
 #include <llvm/PassManager.h>
 #include <llvm/Bitcode/ReaderWriter.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/StandardPasses.h>
 #include <llvm/Target/TargetData.h>
+#include <llvm/Target/TargetOptions.h>
 
+#include "utils/llvmplace.h"
 #include "utils/memmgr.h"
 #include "utils/set.h"
 #include "utils/stringhelper.h"
 
+#include "vec/vectype.h"
+
+#include "fe/class.h"
 #include "fe/cmdlineparser.h"
+#include "fe/compilecache.h"
 #include "fe/context.h"
 #include "fe/error.h"
+#include "fe/jit.h"
+#include "fe/nativeemitter.h"
 #include "fe/location.h"
 #include "fe/parser.h"
+#include "fe/stmnt.h"
+#include "fe/timereport.h"
 #include "fe/type.h"
 #include "fe/typenode.h"
 
@@ -48,12 +60,17 @@
 
 // forward declarations
 
-static void readBuiltinTypes(swift::Context* ctxt);
+static void getBuiltinFiles(std::vector<const char*>& builtin);
+static bool readBuiltinTypes(swift::Context* ctxt);
 static int start(int argc, char** argv);
 static void writeBCFile(const llvm::Module* m, const char* filename);
+static void writeTimeReport(swift::TimeReport& report, swift::Module* module, const char* json);
+static void getOutputSuffixes(const swift::CmdLineParser& clp, std::vector<std::string>& suffixes);
 
 namespace swift {
-FILE* lexer_init(const char* filename);
+bool lexer_init(const char* filename);
+bool lexer_init_string(const char* name, const char* src, size_t len);
+void lexer_finish();
 extern std::string* g_lexer_filename;
 }
 
@@ -87,6 +104,46 @@ static int start(int argc, char** argv)
     if ( !clp.result() )
         return EXIT_FAILURE;
 
+    swift::TimeReport report( clp.timePasses() );
+    int exitCode = EXIT_SUCCESS;
+
+    /*
+     * try the cache first -- nothing to cache if the input or the output is
+     * not a file
+     */
+
+    std::auto_ptr<swift::CompileCache> cache;
+
+    if ( clp.cacheDir() && !clp.source() && !clp.run() && !clp.dump() && !clp.cleanDump() )
+    {
+        std::vector<const char*> builtin;
+        getBuiltinFiles(builtin);
+
+        report.start("cache lookup");
+        cache.reset( new swift::CompileCache(clp.cacheDir(), clp.cacheSize()) );
+
+        bool hit = false;
+        if ( cache->computeKey(argc, argv, clp.getFilename(), builtin) )
+            hit = cache->lookup( clp.getFilename() );
+        else
+            cache.reset(); // let the compiler complain about missing files
+
+        report.stop();
+
+        if (hit)
+        {
+            if ( clp.timePassesJSON() )
+            {
+                std::ofstream out( clp.timePassesJSON() );
+                report.printJSON(out);
+            }
+            else if ( report.enabled() )
+                report.print(std::cerr);
+
+            return EXIT_SUCCESS;
+        }
+    }
+
     /*
      * init globals
      */
@@ -96,17 +153,22 @@ static int start(int argc, char** argv)
     swift::BaseType::initTypeMap(module->lctxt_);
 
     // populate data structures with builtin types
-    readBuiltinTypes(module->ctxt_);
+    report.start("parse builtins");
+    if ( !readBuiltinTypes(module->ctxt_) )
+        return EXIT_FAILURE;
+    report.stop();
 
     // try to open the input file and init the lexer
-    FILE* file = swift::lexer_init( clp.getFilename() );
-    if (!file)
+    if ( clp.source() )
+        swift::lexer_init_string( clp.getFilename(), clp.source(), strlen(clp.source()) );
+    else if ( !swift::lexer_init(clp.getFilename()) )
     {
         std::cerr << "error: failed to open input file" << std::endl;
         return EXIT_FAILURE;
     }
     //build_token_stream();
 
+    report.start("parse");
     swift::Parser parser(module);
 #if 0
     parser.set_debug_level(1);
@@ -114,18 +176,42 @@ static int start(int argc, char** argv)
 #endif
     parser.parse();
 
-    fclose(file);
+    swift::lexer_finish();
+    report.stop();
+
+    module->ctxt_->parallelSimd_ = clp.parallelSimd();
+    module->ctxt_->streamThreshold_ = clp.streamThreshold();
+    module->ctxt_->prefetchDistance_ = clp.prefetchDistance();
+    module->ctxt_->fpModel_ = clp.fpModel();
+
+    // targets with mask registers keep vectorized bools as predicates
+    if ( strstr(clp.features(), "avx512") )
+        vec::setMaskKind(vec::PREDICATE_MASK);
 
     if (module->ctxt_->result_)
+    {
+        report.start("build llvm types");
         module->buildLLVMTypes();
+        report.stop();
+    }
 
+    report.start("analyze");
     module->analyze();
+    report.stop();
 
     if (module->ctxt_->result_)
     {
+        report.start("declare functions");
         module->declareFcts();
+        report.stop();
+
+        report.start("code generation");
         module->codeGen();
+        report.stop();
+
+        report.start("vectorize functions");
         module->vectorizeFcts();
+        report.stop();
     }
 
     if ( clp.cleanDump() )
@@ -133,7 +219,17 @@ static int start(int argc, char** argv)
 
     if (module->ctxt_->result_)
     {
+        report.start("verify");
         module->verify();
+        report.stop();
+
+        // LLVM prints its own report of each pass to stderr
+        llvm::TimePassesIsEnabled = clp.timePasses();
+
+        // LLVM has no per instruction flags -- the model applies to all passes and the code generator
+        llvm::NoExcessFPPrecision    = clp.fpModel() == swift::Context::FP_STRICT;
+        llvm::UnsafeFPMath           = clp.fpModel() == swift::Context::FP_FAST;
+        llvm::FiniteOnlyFPMathOption = clp.fpModel() == swift::Context::FP_FAST;
 
         llvm::PassManager pm;
 
@@ -149,14 +245,58 @@ static int start(int argc, char** argv)
                 clp.simplifyLibCalls(), // simplify lib calls
                 false,                  // have exceptions
                 clp.inlinePass() );     // inline pass
+
+        report.start("llvm passes");
         pm.run( *module->getLLVMModule() );
+        report.stop();
 
         if ( clp.dump() )
             module->llvmDump();
 
-        writeBCFile( module->getLLVMModule(), clp.getFilename() );
+        if ( clp.run() )
+        {
+            report.start("run");
+            exitCode = swift::runJIT( module->getLLVMModule(), clp.getFilename() );
+            report.stop();
+        }
+        else
+        {
+            swift::NativeEmitter emitter( clp.cpu(), clp.features(), clp.optLevel(), clp.codeGenThreads() );
+
+            if ( clp.emitListings() )
+            {
+                report.start("write listings");
+                emitter.emitLLListing( module->getLLVMModule(), clp.getFilename() );
+                emitter.emitAsmListing( module->getLLVMModule(), clp.getFilename() );
+                report.stop();
+            }
+
+            if ( clp.emitObj() )
+            {
+                report.start("emit objects");
+                if ( !emitter.emitObjects(module->getLLVMModule(), clp.getFilename()) )
+                    exitCode = EXIT_FAILURE;
+                report.stop();
+            }
+            else
+            {
+                report.start("write bitcode");
+                writeBCFile( module->getLLVMModule(), clp.getFilename() );
+                report.stop();
+            }
+        }
+    }
+
+    if ( cache.get() && module->ctxt_->result_ && exitCode == EXIT_SUCCESS )
+    {
+        std::vector<std::string> suffixes;
+        getOutputSuffixes(clp, suffixes);
+        cache->store(clp.getFilename(), suffixes);
     }
 
+    if ( report.enabled() )
+        writeTimeReport( report, module, clp.timePassesJSON() );
+
     /*
      * clean up
      */
@@ -167,16 +307,18 @@ static int start(int argc, char** argv)
     delete swift::g_lexer_filename;
     delete module;
 
+    // the destructors have run -- now free the memory in bulk
+    swift::Node::arena().release();
+    Place::arena().release();
+
     if (!result)
         return EXIT_FAILURE; // abort on error
 
-    return EXIT_SUCCESS;
+    return exitCode;
 }
 
-static void readBuiltinTypes(swift::Context* ctxt)
+static void getBuiltinFiles(std::vector<const char*>& builtin)
 {
-    std::vector<const char*> builtin;
-
     //builtin.push_back("fe/builtin/int.swift");
     //builtin.push_back("fe/builtin/int8.swift");
     //builtin.push_back("fe/builtin/int16.swift");
@@ -203,16 +345,26 @@ static void readBuiltinTypes(swift::Context* ctxt)
 
     //builtin.push_back("fe/builtin/bool.swift");
 
+    // the math library is always available
+    builtin.push_back("lib/math.swift");
+
     // library HACK
-    //builtin.push_back("lib/math.swift");
     //builtin.push_back("lib/vec.swift");
     //builtin.push_back("lib/mat.swift");
+}
 
-    FILE* file;
+static bool readBuiltinTypes(swift::Context* ctxt)
+{
+    std::vector<const char*> builtin;
+    getBuiltinFiles(builtin);
 
     for (size_t i = 0; i < builtin.size(); ++i)
     {
-        file = swift::lexer_init(builtin[i]);
+        if ( !swift::lexer_init(builtin[i]) )
+        {
+            std::cerr << "error: failed to open builtin file '" << builtin[i] << "'" << std::endl;
+            return false;
+        }
         //build_token_stream();
 
         swift::Parser parser(ctxt->module_);
@@ -222,8 +374,10 @@ static void readBuiltinTypes(swift::Context* ctxt)
 #endif
         parser.parse();
 
-        fclose(file);
+        swift::lexer_finish();
     }
+
+    return true;
 }
 
 static void writeBCFile(const llvm::Module* m, const char* filename) 
@@ -252,3 +406,63 @@ static void writeBCFile(const llvm::Module* m, const char* filename)
 
     llvm::WriteBitcodeToFile(m, *outStream);
 }
+
+static void writeTimeReport(swift::TimeReport& report, swift::Module* module, const char* json)
+{
+    size_t numFcts = 0;
+    llvm::Module* lmodule = module->getLLVMModule();
+    for (llvm::Module::iterator iter = lmodule->begin(); iter != lmodule->end(); ++iter)
+    {
+        if ( !iter->isDeclaration() )
+            ++numFcts;
+    }
+
+    report.addCount( "classes", module->classes().size() );
+    report.addCount( "ast nodes", swift::Node::numCreated_ );
+    report.addCount( "statements", swift::Stmnt::numCreated_ );
+    report.addCount( "expressions", swift::TypeNode::numCreated_ );
+    report.addCount( "node arena bytes", swift::Node::arena().size() );
+    report.addCount( "place arena bytes", Place::arena().size() );
+    report.addCount( "llvm functions", numFcts );
+    report.addCount( "member function lookups", swift::Class::numFctLookups_ );
+    report.addCount( "member function cache hits", swift::Class::numFctCacheHits_ );
+    report.addCount( "member function cache hit rate (%)", swift::Class::numFctLookups_ 
+            ? 100 * swift::Class::numFctCacheHits_ / swift::Class::numFctLookups_ : 0 );
+
+    if (json)
+    {
+        std::ofstream out(json);
+        if (!out)
+        {
+            std::cerr << "error: failed to open '" << json << "'" << std::endl;
+            return;
+        }
+
+        report.printJSON(out);
+    }
+    else
+        report.print(std::cerr);
+}
+
+static void getOutputSuffixes(const swift::CmdLineParser& clp, std::vector<std::string>& suffixes)
+{
+    if ( clp.emitListings() )
+    {
+        suffixes.push_back(".ll");
+        suffixes.push_back(".s");
+    }
+
+    if ( !clp.emitObj() )
+        suffixes.push_back(".bc");
+    else if ( clp.codeGenThreads() == 1 )
+        suffixes.push_back(".o");
+    else
+    {
+        for (unsigned i = 0; i < clp.codeGenThreads(); ++i)
+        {
+            std::ostringstream oss;
+            oss << '.' << i << ".o";
+            suffixes.push_back( oss.str() );
+        }
+    }
+}
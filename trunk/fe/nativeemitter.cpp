@@ -0,0 +1,375 @@
+#include "fe/nativeemitter.h"
+
+#include <cctype>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+
+#include <pthread.h>
+
+#include <llvm/LLVMContext.h>
+#include <llvm/Module.h>
+#include <llvm/ModuleProvider.h>
+#include <llvm/PassManager.h>
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/CodeGen/FileWriters.h>
+#include <llvm/CodeGen/ObjectCodeEmitter.h>
+#include <llvm/Support/FormattedStream.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/System/Threading.h>
+#include <llvm/Target/SubtargetFeature.h>
+#include <llvm/Target/TargetData.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetRegistry.h>
+#include <llvm/Target/TargetSelect.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+extern "C" void LLVMInitializeX86AsmPrinter();
+
+namespace swift {
+
+NativeEmitter::NativeEmitter(const std::string& cpu, const std::string& features, unsigned optLevel, unsigned numThreads)
+    : cpu_(cpu)
+    , features_(features)
+    , optLevel_(optLevel)
+    , numThreads_(numThreads ? numThreads : 1)
+{
+    llvm::InitializeNativeTarget();
+    LLVMInitializeX86AsmPrinter();
+}
+
+struct EmitJob
+{
+    const NativeEmitter* emitter_;
+    std::string bitcode_;
+    std::string outfile_;
+    bool result_;
+};
+
+/*
+ * An LLVMContext must not be shared between threads. So each partition is
+ * handed over as bitcode and read back into a context of its own.
+ */
+void* NativeEmitter::threadMain(void* arg)
+{
+    EmitJob* job = (EmitJob*) arg;
+    job->result_ = false;
+
+    llvm::LLVMContext lctxt;
+    std::auto_ptr<llvm::MemoryBuffer> buffer( llvm::MemoryBuffer::getMemBuffer(
+            job->bitcode_.c_str(), job->bitcode_.c_str() + job->bitcode_.size()) );
+
+    std::string error;
+    std::auto_ptr<llvm::Module> m( llvm::ParseBitcodeFile(buffer.get(), lctxt, &error) );
+
+    if ( !m.get() )
+    {
+        std::cerr << "error: " << error << std::endl;
+        return 0;
+    }
+
+    job->result_ = job->emitter_->emitFile(m.get(), job->outfile_, false);
+
+    return 0;
+}
+
+bool NativeEmitter::emitObjects(llvm::Module* m, const std::string& filename)
+{
+    if (numThreads_ == 1)
+        return emitFile(m, filename + ".o", false);
+
+    std::vector<unsigned> parts;
+    partition(m, parts);
+    promoteShared(m, parts, filename);
+
+    // clone on this thread -- the threads only read their bitcode
+    std::vector<EmitJob> jobs(numThreads_);
+    for (unsigned p = 0; p < numThreads_; ++p)
+    {
+        std::ostringstream oss;
+        oss << filename << '.' << p << ".o";
+
+        jobs[p].emitter_ = this;
+        jobs[p].outfile_ = oss.str();
+        jobs[p].result_ = false;
+
+        std::auto_ptr<llvm::Module> clone( extractPartition(m, parts, p) );
+        llvm::raw_string_ostream out(jobs[p].bitcode_);
+        llvm::WriteBitcodeToFile(clone.get(), out);
+        out.flush();
+    }
+
+    llvm::llvm_start_multithreaded();
+
+    std::vector<pthread_t> threads(numThreads_);
+    for (unsigned p = 1; p < numThreads_; ++p)
+        pthread_create(&threads[p], 0, threadMain, &jobs[p]);
+
+    threadMain(&jobs[0]);
+
+    for (unsigned p = 1; p < numThreads_; ++p)
+        pthread_join(threads[p], 0);
+
+    llvm::llvm_stop_multithreaded();
+
+    bool result = true;
+    for (unsigned p = 0; p < numThreads_; ++p)
+        result &= jobs[p].result_;
+
+    return result;
+}
+
+bool NativeEmitter::emitAsmListing(llvm::Module* m, const std::string& filename)
+{
+    return emitFile(m, filename + ".s", true);
+}
+
+bool NativeEmitter::emitLLListing(llvm::Module* m, const std::string& filename)
+{
+    std::string outfile = filename + ".ll";
+    std::string errorInfo;
+    llvm::raw_fd_ostream out( outfile.c_str(), errorInfo );
+
+    if ( !errorInfo.empty() )
+    {
+        std::cerr << errorInfo << std::endl;
+        return false;
+    }
+
+    m->print(out, 0);
+
+    return true;
+}
+
+bool NativeEmitter::emitFile(llvm::Module* m, const std::string& outfile, bool asmFile) const
+{
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget( m->getTargetTriple(), error );
+
+    if (!target)
+    {
+        std::cerr << "error: " << error << std::endl;
+        return false;
+    }
+
+    llvm::SubtargetFeatures features(features_);
+    features.setCPU(cpu_);
+
+    std::auto_ptr<llvm::TargetMachine> tm( 
+            target->createTargetMachine(m->getTargetTriple(), features.getString()) );
+
+    std::auto_ptr<llvm::raw_fd_ostream> fdOut( 
+            new llvm::raw_fd_ostream(outfile.c_str(), error, llvm::raw_fd_ostream::F_Binary) );
+
+    if ( !error.empty() )
+    {
+        std::cerr << error << std::endl;
+        return false;
+    }
+
+    llvm::CodeGenOpt::Level level;
+    switch (optLevel_)
+    {
+        case 0:  level = llvm::CodeGenOpt::None;       break;
+        case 1:  level = llvm::CodeGenOpt::Less;       break;
+        case 2:  level = llvm::CodeGenOpt::Default;    break;
+        default: level = llvm::CodeGenOpt::Aggressive; break;
+    }
+
+    bool result = true;
+
+    {
+        llvm::formatted_raw_ostream out(*fdOut);
+        llvm::ExistingModuleProvider mp(m);
+        llvm::FunctionPassManager fpm(&mp);
+        fpm.add( new llvm::TargetData(*tm->getTargetData()) );
+
+        llvm::ObjectCodeEmitter* oce = 0;
+
+        switch ( tm->addPassesToEmitFile(fpm, out, 
+                    asmFile ? llvm::TargetMachine::AssemblyFile : llvm::TargetMachine::ObjectFile, level) )
+        {
+            case llvm::FileModel::AsmFile:
+                break;
+            case llvm::FileModel::ElfFile:
+                oce = llvm::AddELFWriter(fpm, out, *tm);
+                break;
+            default:
+                std::cerr << "error: target does not support generation of this file type" << std::endl;
+                result = false;
+        }
+
+        if ( result && tm->addPassesToEmitFileFinish(fpm, oce, level) )
+        {
+            std::cerr << "error: target does not support generation of this file type" << std::endl;
+            result = false;
+        }
+
+        if (result)
+        {
+            fpm.doInitialization();
+
+            for (llvm::Module::iterator iter = m->begin(); iter != m->end(); ++iter)
+            {
+                if ( !iter->isDeclaration() )
+                    fpm.run(*iter);
+            }
+
+            fpm.doFinalization();
+        }
+
+        // m is still owned by the caller
+        mp.releaseModule();
+    }
+
+    return result;
+}
+
+/*
+ * Greedily assigns each defined function to the partition with the least
+ * number of instructions so far; parts[i] is the partition of the i-th
+ * function of m.
+ */
+void NativeEmitter::partition(llvm::Module* m, std::vector<unsigned>& parts) const
+{
+    std::vector<size_t> sizes(numThreads_, 0);
+
+    for (llvm::Module::iterator iter = m->begin(); iter != m->end(); ++iter)
+    {
+        if ( iter->isDeclaration() )
+        {
+            parts.push_back(0);
+            continue;
+        }
+
+        size_t size = 0;
+        for (llvm::Function::iterator bb = iter->begin(); bb != iter->end(); ++bb)
+            size += bb->size();
+
+        unsigned min = 0;
+        for (unsigned p = 1; p < numThreads_; ++p)
+        {
+            if (sizes[p] < sizes[min])
+                min = p;
+        }
+
+        sizes[min] += size;
+        parts.push_back(min);
+    }
+}
+
+static void collectGlobals(llvm::User* user, std::set<llvm::GlobalValue*>& globals)
+{
+    for (llvm::User::op_iterator op = user->op_begin(); op != user->op_end(); ++op)
+    {
+        if ( llvm::GlobalValue* gv = llvm::dyn_cast<llvm::GlobalValue>(*op) )
+            globals.insert(gv);
+        else if ( llvm::Constant* c = llvm::dyn_cast<llvm::Constant>(*op) )
+            collectGlobals(c, globals);
+    }
+}
+
+/*
+ * Local symbols which are referenced from another partition than the one
+ * defining them become hidden external symbols. They are prefixed with the
+ * name of the output file in order to avoid clashes with other modules.
+ * Global variables are defined in partition 0.
+ */
+void NativeEmitter::promoteShared(llvm::Module* m, const std::vector<unsigned>& parts, const std::string& filename) const
+{
+    std::map<llvm::GlobalValue*, unsigned> owner;
+    std::set<llvm::GlobalValue*> shared;
+
+    size_t i = 0;
+    for (llvm::Module::iterator iter = m->begin(); iter != m->end(); ++iter, ++i)
+        owner[iter] = parts[i];
+
+    for (llvm::Module::global_iterator iter = m->global_begin(); iter != m->global_end(); ++iter)
+        owner[iter] = 0;
+
+    // references from function bodies
+    i = 0;
+    for (llvm::Module::iterator iter = m->begin(); iter != m->end(); ++iter, ++i)
+    {
+        std::set<llvm::GlobalValue*> globals;
+
+        for (llvm::Function::iterator bb = iter->begin(); bb != iter->end(); ++bb)
+        {
+            for (llvm::BasicBlock::iterator inst = bb->begin(); inst != bb->end(); ++inst)
+                collectGlobals(inst, globals);
+        }
+
+        for (std::set<llvm::GlobalValue*>::iterator gv = globals.begin(); gv != globals.end(); ++gv)
+        {
+            if ( (*gv)->hasLocalLinkage() && owner[*gv] != parts[i] )
+                shared.insert(*gv);
+        }
+    }
+
+    // references from initializers of global variables
+    for (llvm::Module::global_iterator iter = m->global_begin(); iter != m->global_end(); ++iter)
+    {
+        if ( !iter->hasInitializer() )
+            continue;
+
+        std::set<llvm::GlobalValue*> globals;
+        if ( llvm::GlobalValue* gv = llvm::dyn_cast<llvm::GlobalValue>(iter->getInitializer()) )
+            globals.insert(gv);
+        else
+            collectGlobals(iter->getInitializer(), globals);
+
+        for (std::set<llvm::GlobalValue*>::iterator gv = globals.begin(); gv != globals.end(); ++gv)
+        {
+            if ( (*gv)->hasLocalLinkage() && owner[*gv] != 0 )
+                shared.insert(*gv);
+        }
+    }
+
+    std::string prefix = "__swift_";
+    for (size_t c = 0; c < filename.size(); ++c)
+        prefix += isalnum(filename[c]) ? filename[c] : '_';
+    prefix += '_';
+
+    for (std::set<llvm::GlobalValue*>::iterator iter = shared.begin(); iter != shared.end(); ++iter)
+    {
+        llvm::GlobalValue* gv = *iter;
+        gv->setName( prefix + gv->getNameStr() );
+        gv->setLinkage(llvm::GlobalValue::ExternalLinkage);
+        gv->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    }
+}
+
+/*
+ * The clone keeps the bodies of the functions of partition p only. Global
+ * variables are defined in partition 0 and declared in the others.
+ */
+llvm::Module* NativeEmitter::extractPartition(llvm::Module* m, const std::vector<unsigned>& parts, unsigned p) const
+{
+    llvm::Module* clone = llvm::CloneModule(m);
+
+    size_t i = 0;
+    for (llvm::Module::iterator iter = clone->begin(); iter != clone->end(); ++iter, ++i)
+    {
+        if ( !iter->isDeclaration() && parts[i] != p )
+            iter->deleteBody();
+    }
+
+    if (p != 0)
+    {
+        for (llvm::Module::global_iterator iter = clone->global_begin(); iter != clone->global_end(); ++iter)
+        {
+            if ( iter->hasInitializer() )
+            {
+                iter->setInitializer(0);
+                iter->setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+    }
+
+    return clone;
+}
+
+} // namespace swift
@@ -0,0 +1,64 @@
+#ifndef SWIFT_NATIVEEMITTER_H
+#define SWIFT_NATIVEEMITTER_H
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+    class Module;
+}
+
+namespace swift {
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Emits native code of an llvm::Module via the target machine of its
+ * target triple -- no llc or llvm-ld needed.
+ */
+class NativeEmitter
+{
+public:
+
+    /**
+     * @param cpu e.g. "core2"; empty for the generic cpu
+     * @param features comma separated list like "+sse41,-ssse3"
+     * @param optLevel optimization level of the code generator: 0 - 3
+     * @param numThreads the module is split into this many partitions which
+     *      are compiled concurrently
+     */
+    NativeEmitter(const std::string& cpu, const std::string& features, unsigned optLevel, unsigned numThreads);
+
+    /**
+     * Writes filename.o if one thread is used and filename.0.o, filename.1.o,
+     * ... otherwise. Internal symbols of \p m which are referenced across
+     * partitions become hidden external symbols.
+     */
+    bool emitObjects(llvm::Module* m, const std::string& filename);
+
+    /// Writes the native assembly listing to filename.s.
+    bool emitAsmListing(llvm::Module* m, const std::string& filename);
+
+    /// Writes the llvm assembly listing to filename.ll.
+    bool emitLLListing(llvm::Module* m, const std::string& filename);
+
+private:
+
+    bool emitFile(llvm::Module* m, const std::string& outfile, bool asmFile) const;
+    void partition(llvm::Module* m, std::vector<unsigned>& parts) const;
+    void promoteShared(llvm::Module* m, const std::vector<unsigned>& parts, const std::string& filename) const;
+    llvm::Module* extractPartition(llvm::Module* m, const std::vector<unsigned>& parts, unsigned p) const;
+
+    static void* threadMain(void* arg);
+
+    std::string cpu_;
+    std::string features_;
+    unsigned optLevel_;
+    unsigned numThreads_;
+};
+
+//------------------------------------------------------------------------------
+
+} // namespace swift
+
+#endif // SWIFT_NATIVEEMITTER_H
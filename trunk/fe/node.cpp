@@ -21,10 +21,14 @@ namespace swift {
 
 //------------------------------------------------------------------------------
 
+size_t Node::numCreated_ = 0;
+
 Node::Node(const Location& loc, Node* parent /*= 0*/)
     : loc_(loc)
     , parent_(parent)
-{}
+{
+    ++numCreated_;
+}
 
 const Location& Node::loc() const
 {
@@ -35,7 +39,7 @@ const Location& Node::loc() const
 
 Module::Module(const Location& loc, std::string* id)
     : Node(loc)
-    , id_(id)
+    , id_( intern(id) )
     //, lctxt_( new llvm::LLVMContext() )
     , lctxt_( &llvm::getGlobalContext() )
     , llvmModule_( new llvm::Module( llvm::StringRef("default"), *lctxt_) )
@@ -49,11 +53,10 @@ Module::Module(const Location& loc, std::string* id)
 
 Module::~Module()
 {
-    delete id_;
     delete ctxt_;
 
-    for (ClassMap::iterator iter = classes_.begin(); iter != classes_.end(); ++iter)
-        delete iter->second;
+    for (size_t i = 0; i < classes_.size(); ++i)
+        delete classes_[i];
 
     delete llvmModule_;
     delete lctxt_;
@@ -61,10 +64,9 @@ Module::~Module()
 
 void Module::insert(Class* c)
 {
-    ClassMap::iterator iter = classes_.find( c->id() );
-
+    ClassMap::iterator iter = classMap_.find( c->id() );
 
-    if (iter != classes_.end())
+    if (iter != classMap_.end())
     {
         errorf(c->loc(), "there is already a class '%s' defined in module '%s'", c->cid(), cid());
         SWIFT_PREV_ERROR(iter->second->loc());
@@ -73,7 +75,8 @@ void Module::insert(Class* c)
         return;
     }
 
-    classes_[c->id()] = c;
+    classMap_[c->id()] = c;
+    classes_.push_back(c);
     ctxt_->class_ = c;
 
     return;
@@ -81,9 +84,9 @@ void Module::insert(Class* c)
 
 Class* Module::lookupClass(const std::string* id)
 {
-    ClassMap::iterator iter = classes_.find(id);
+    ClassMap::iterator iter = classMap_.find(id);
 
-    if (iter == classes_.end())
+    if (iter == classMap_.end())
         return 0;
 
     return iter->second;
@@ -101,14 +104,15 @@ const char* Module::cid() const
 
 void Module::accept(ClassVisitorBase* c)
 {
-    for (ClassMap::iterator iter = classes_.begin(); iter != classes_.end(); ++iter)
-        iter->second->accept(c);
+    for (size_t i = 0; i < classes_.size(); ++i)
+        classes_[i]->accept(c);
 }
 
 void Module::analyze()
 {
     ClassAnalyzer classAnalyzer(ctxt_);
     accept(&classAnalyzer);
+    classAnalyzer.fuseSimdLoops();
 }
 
 void Module::buildLLVMTypes()
@@ -153,7 +157,7 @@ llvm::Module* Module::getLLVMModule() const
     return llvmModule_;
 }
 
-const Module::ClassMap& Module::classes() const
+const Module::Classes& Module::classes() const
 {
     return classes_;
 }
@@ -1,6 +1,9 @@
 #ifndef SWIFT_NODE_H
 #define SWIFT_NODE_H
 
+#include <tr1/unordered_map>
+
+#include "utils/arena.h"
 #include "utils/cast.h"
 #include "utils/map.h"
 #include "utils/stringhelper.h"
@@ -25,7 +28,8 @@ class TypeNode;
 
 //------------------------------------------------------------------------------
 
-class Node
+/// All nodes live in one arena which is released after the module is deleted.
+class Node : public ArenaObject<Node>
 {
 public:
 
@@ -57,6 +61,8 @@ public:
         return 0;
     }
 
+    static size_t numCreated_; ///< number of nodes created so far
+
 protected:
 
     Location loc_;
@@ -73,7 +79,10 @@ public:
     virtual ~Module();
 
     void insert(Class* c); 
+
+    /// \p id must be a symbol -- see \a intern.
     Class* lookupClass(const std::string* id);
+
     const std::string* id() const;
     const char* cid() const;
     void analyze();
@@ -86,13 +95,18 @@ public:
     void accept(ClassVisitorBase* c);
     void llvmDump();
 
-    typedef std::map<const std::string*, Class*, StringPtrCmp> ClassMap;
-    const ClassMap& classes() const;
+    typedef std::vector<Class*> Classes;
+
+    /// All classes in the order of their declaration.
+    const Classes& classes() const;
 
 private:
 
-    std::string* id_;
-    ClassMap classes_;
+    const std::string* id_;
+    Classes classes_;
+
+    typedef std::tr1::unordered_map<const std::string*, Class*, SymbolHash> ClassMap;
+    ClassMap classMap_;
 
 public:
 
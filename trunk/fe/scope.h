@@ -23,6 +23,7 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <tr1/unordered_map>
 
 #include "utils/stringhelper.h"
 
@@ -42,9 +43,12 @@ class Scope : public Node
 {
 public:
 
+    typedef std::vector<Stmnt*> Stmnts;
+
     Scope(const Location& loc, Node* parent, Scope* pScope);
     ~Scope();
 
+    /// \p id must be a symbol -- see \a intern.
     Var* lookupVarOneLevelOnly(const std::string* id);
     Var* lookupVar(const std::string* id);
 
@@ -52,6 +56,7 @@ public:
     void appendStmnt(Stmnt* stmnt);
     void accept(StmntVisitorBase* s);
     bool isEmpty() const;
+    Stmnts& getStmnts() { return stmnts_; }
 
     void setParentNode(Node* parent) { parent_ = parent; }
 
@@ -59,10 +64,9 @@ private:
 
     Scope* pScope_;
 
-    typedef std::map<const std::string*, Var*, StringPtrCmp> VarMap;
+    typedef std::tr1::unordered_map<const std::string*, Var*, SymbolHash> VarMap;
     VarMap vars_;
 
-    typedef std::vector<Stmnt*> Stmnts;
     Stmnts stmnts_;
 };
 
@@ -20,6 +20,7 @@
 #include "fe/sig.h"
 
 #include <sstream>
+#include <tr1/functional>
 
 #include "utils/assert.h"
 
@@ -33,6 +34,11 @@ namespace swift {
 
 //------------------------------------------------------------------------------
 
+Sig::Sig()
+    : inHash_( std::tr1::hash<std::string>()(std::string()) )
+    , inError_(false)
+{}
+
 Sig::~Sig()
 {
     for (size_t i = 0; i < in_.size(); ++i)
@@ -82,6 +88,9 @@ void Sig::buildTypeLists()
 
     for (size_t i = 0; i < out_.size(); ++i)
         outTypes_.push_back( out_[i]->getType() );
+
+    inHash_ = std::tr1::hash<std::string>()( inTypes_.key() );
+    inError_ = inTypes_.hasError();
 }
 
 //------------------------------------------------------------------------------
@@ -43,6 +43,7 @@ class Sig
 {
 public:
 
+    Sig();
     ~Sig();
 
     void setInList(Context* ctxt);
@@ -58,6 +59,8 @@ public:
     RetVals out_;
     TypeList inTypes_;
     TypeList outTypes_;
+    size_t inHash_; ///< hash of inTypes_.key()
+    bool inError_;  ///< inTypes_ contains an ErrorType
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,330 @@
+#include "fe/simdloopfuser.h"
+
+#include <algorithm>
+
+#include "utils/cast.h"
+
+#include "fe/context.h"
+#include "fe/scope.h"
+#include "fe/tnlist.h"
+#include "fe/type.h"
+#include "fe/typenode.h"
+#include "fe/var.h"
+
+namespace swift {
+
+SimdLoopFuser::StmntVisitor(Context* ctxt)
+    : StmntVisitorBase(ctxt)
+{}
+
+void SimdLoopFuser::visit(ErrorStmnt* s) {}
+void SimdLoopFuser::visit(CFStmnt* s) {}
+void SimdLoopFuser::visit(DeclStmnt* s) {}
+void SimdLoopFuser::visit(AssignStmnt* s) {}
+void SimdLoopFuser::visit(ExprStmnt* s) {}
+
+void SimdLoopFuser::visit(IfElStmnt* s)
+{
+    fuse(s->ifScope_);
+
+    if (s->elScope_)
+        fuse(s->elScope_);
+}
+
+void SimdLoopFuser::visit(RepeatUntilLoop* l)
+{
+    fuse(l->scope_);
+}
+
+void SimdLoopFuser::visit(WhileLoop* l)
+{
+    fuse(l->scope_);
+}
+
+void SimdLoopFuser::visit(SimdLoop* l)
+{
+    fuse(l->scope_);
+}
+
+void SimdLoopFuser::visit(ScopeStmnt* s)
+{
+    fuse(s->scope_);
+}
+
+void SimdLoopFuser::fuse(Scope* scope)
+{
+    Scope::Stmnts& stmnts = scope->getStmnts();
+
+    for (size_t i = 0; i < stmnts.size(); ++i)
+        stmnts[i]->accept(this);
+
+    Scope::Stmnts result;
+    SimdLoop::SimdLoops heads;
+    SimdLoop* head = 0;
+
+    for (size_t i = 0; i < stmnts.size(); ++i)
+    {
+        SimdLoop* l = dynamic<SimdLoop>(stmnts[i]);
+
+        if ( head && l && canFuse(scope, head, l) )
+        {
+            merge(head, l);
+            continue;
+        }
+
+        if (l)
+            heads.push_back(l);
+
+        head = l;
+        result.push_back(stmnts[i]);
+    }
+
+    stmnts.swap(result);
+
+    for (size_t i = 0; i < heads.size(); ++i)
+    {
+        if ( !heads[i]->fused_.empty() )
+            elideContainers(scope, heads[i]);
+    }
+}
+
+bool SimdLoopFuser::canFuse(Scope* scope, SimdLoop* head, SimdLoop* l)
+{
+    // fusing would interleave impure calls and stores through references
+    if ( head->hasSideEffects() || l->hasSideEffects() )
+        return false;
+
+    SimdLoop::SimdLoops group;
+    getGroup(head, group);
+
+    if (   !sameBound(scope, head->lExpr_, l->lExpr_, group)
+        || !sameBound(scope, head->rExpr_, l->rExpr_, group) )
+    {
+        return false;
+    }
+
+    // each variable used in l and in the group must only be accessed via a@
+    for (SimdLoop::VarUses::iterator iter = l->varUses_.begin(); iter != l->varUses_.end(); ++iter)
+    {
+        Var* var = iter->first;
+
+        for (size_t i = 0; i < group.size(); ++i)
+        {
+            if ( isUsed(group[i], var) && (!onlySimdAccesses(group[i], var) || !onlySimdAccesses(l, var)) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void SimdLoopFuser::merge(SimdLoop* head, SimdLoop* l)
+{
+    SimdLoop::SimdLoops group;
+    getGroup(head, group);
+
+    // a@ read in another loop is not write-only anymore
+    for (size_t i = 0; i < group.size(); ++i)
+    {
+        for (size_t j = 0; j < group[i]->simdStores_.size(); ++j)
+        {
+            if ( isUsed(l, group[i]->simdStores_[j].first) )
+                group[i]->simdStores_[j].second->setStream(false);
+        }
+
+        for (size_t j = 0; j < l->simdStores_.size(); ++j)
+        {
+            if ( isUsed(group[i], l->simdStores_[j].first) )
+                l->simdStores_[j].second->setStream(false);
+        }
+    }
+
+    // the accumulators are handled by the head
+    head->reductions_.insert( head->reductions_.end(), l->reductions_.begin(), l->reductions_.end() );
+    l->reductions_.clear();
+
+    head->fused_.push_back(l);
+}
+
+void SimdLoopFuser::elideContainers(Scope* scope, SimdLoop* head)
+{
+    SimdLoop::SimdLoops group;
+    getGroup(head, group);
+
+    for (size_t k = 0; k < group.size(); ++k)
+    {
+        SimdLoop* l = group[k];
+
+        for (size_t i = 0; i < l->simdStores_.size(); ++i)
+        {
+            Local* local = dynamic<Local>(l->simdStores_[i].first);
+            if ( !local || !local->getType()->cast<Simd>() )
+                continue;
+
+            // already elided?
+            if ( std::find(head->registers_.begin(), head->registers_.end(), local) != head->registers_.end() )
+                continue;
+
+            /*
+             * check that the container is completely written in l before and
+             * only read in the following loops of the group
+             */
+
+            size_t numUses = 0;
+            bool ok = true;
+
+            for (size_t j = 0; j < group.size() && ok; ++j)
+            {
+                SimdLoop* g = group[j];
+
+                if ( !isUsed(g, local) )
+                    continue;
+
+                numUses += g->varUses_[local];
+                ok = onlySimdAccesses(g, local);
+
+                if (j < k)
+                    ok = false;
+                else if (j == k)
+                    ok &= numAccesses(g->simdStores_, local) == numAccesses(g->simdAccesses_, local);
+                else
+                    ok &= numAccesses(g->simdStores_, local) == 0;
+            }
+
+            // must not be used anywhere else
+            if ( !ok || ctxt_->varUses_[local] != numUses )
+                continue;
+
+            size_t index;
+            Stmnt* decl = findDecl(scope, local, index);
+            if (!decl)
+                continue;
+
+            /*
+             * elide
+             */
+
+            scope->getStmnts().erase( scope->getStmnts().begin() + index );
+            head->elided_.push_back(decl);
+            head->registers_.push_back(local);
+
+            for (size_t j = 0; j < group.size(); ++j)
+            {
+                SimdLoop::SimdAccesses& accesses = group[j]->simdAccesses_;
+
+                for (size_t a = 0; a < accesses.size(); ++a)
+                {
+                    if (accesses[a].first == local)
+                        accesses[a].second->setRegister(true);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Bounds are equal if they are the same literal or the same variable which is
+ * not used within the loops.
+ */
+bool SimdLoopFuser::sameBound(Scope* scope, Expr* e1, Expr* e2, const SimdLoop::SimdLoops& group)
+{
+    if ( Literal* l1 = dynamic<Literal>(e1) )
+    {
+        Literal* l2 = dynamic<Literal>(e2);
+        return l2 && l1->getToken() == l2->getToken() && l1->getBox().uint64_ == l2->getBox().uint64_;
+    }
+
+    Id* id1 = dynamic<Id>(e1);
+    Id* id2 = dynamic<Id>(e2);
+
+    if ( !id1 || !id2 || *id1->id() != *id2->id() )
+        return false;
+
+    Var* var = scope->lookupVar( id1->id() );
+
+    for (size_t i = 0; i < group.size(); ++i)
+    {
+        if ( isUsed(group[i], var) )
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Finds either
+ *
+ *     simd{T} a
+ *
+ * or
+ *
+ *     simd{T} a = n
+ *
+ * where n is a literal or a variable.
+ */
+Stmnt* SimdLoopFuser::findDecl(Scope* scope, Local* local, size_t& index)
+{
+    Scope::Stmnts& stmnts = scope->getStmnts();
+
+    for (index = 0; index < stmnts.size(); ++index)
+    {
+        if ( DeclStmnt* d = dynamic<DeclStmnt>(stmnts[index]) )
+        {
+            if (d->decl_->getLocal() == local)
+                return d;
+        }
+        else if ( AssignStmnt* a = dynamic<AssignStmnt>(stmnts[index]) )
+        {
+            if ( a->tuple_->numTypeNodes() != 1 )
+                continue;
+
+            Decl* decl = dynamic<Decl>( a->tuple_->getTypeNode(0) );
+            if ( !decl || decl->getLocal() != local )
+                continue;
+
+            for (size_t i = 0; i < a->exprList_->numTypeNodes(); ++i)
+            {
+                TypeNode* tn = a->exprList_->getTypeNode(i);
+                if ( !dynamic<Literal>(tn) && !dynamic<Id>(tn) )
+                    return 0; // may have side effects
+            }
+
+            return a;
+        }
+    }
+
+    return 0;
+}
+
+void SimdLoopFuser::getGroup(SimdLoop* head, SimdLoop::SimdLoops& group)
+{
+    group.push_back(head);
+    group.insert( group.end(), head->fused_.begin(), head->fused_.end() );
+}
+
+size_t SimdLoopFuser::numAccesses(const SimdLoop::SimdAccesses& accesses, Var* var)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < accesses.size(); ++i)
+    {
+        if (accesses[i].first == var)
+            ++result;
+    }
+
+    return result;
+}
+
+bool SimdLoopFuser::onlySimdAccesses(SimdLoop* l, Var* var)
+{
+    SimdLoop::VarUses::iterator iter = l->varUses_.find(var);
+    size_t numUses = iter == l->varUses_.end() ? 0 : iter->second;
+
+    return numAccesses(l->simdAccesses_, var) == numUses;
+}
+
+bool SimdLoopFuser::isUsed(SimdLoop* l, Var* var)
+{
+    return l->varUses_.find(var) != l->varUses_.end();
+}
+
+} // namespace swift
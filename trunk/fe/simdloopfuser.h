@@ -0,0 +1,68 @@
+#ifndef SWIFT_SIMDLOOPFUSER_H
+#define SWIFT_SIMDLOOPFUSER_H
+
+#include "fe/stmnt.h"
+
+namespace swift {
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Fuses directly following simd loops with the same bounds.
+ *
+ * Two loops are fused if each variable used in both loops is only accessed
+ * via a@. Then iteration i of the second loop only depends on iteration i of
+ * the first one. Loops containing c_calls, calls of impure member functions
+ * or stores through references are never fused as this would interleave
+ * their side effects -- see \a MemberFct::isPure. The fused loops are
+ * appended to SimdLoop::fused_ of the first loop and removed from the scope.
+ *
+ * A simd container which is written in one loop of a fused group, read in
+ * the following ones and used nowhere else becomes a value per iteration;
+ * its declaration is removed so it is never allocated.
+ *
+ * This pass must run after the \a StmntAnalyzer has analyzed all member
+ * functions.
+ */
+template <>
+class StmntVisitor<class Fuser> : public StmntVisitorBase
+{
+public:
+
+    StmntVisitor(Context* ctxt);
+
+    virtual void visit(ErrorStmnt* s);
+    virtual void visit(CFStmnt* s);
+    virtual void visit(DeclStmnt* s);
+    virtual void visit(IfElStmnt* s);
+    virtual void visit(WhileLoop* l);
+    virtual void visit(RepeatUntilLoop* l);
+    virtual void visit(SimdLoop* l);
+    virtual void visit(ScopeStmnt* s);
+    virtual void visit(AssignStmnt* s);
+    virtual void visit(ExprStmnt* s);
+
+    void fuse(Scope* scope);
+
+private:
+
+    bool canFuse(Scope* scope, SimdLoop* head, SimdLoop* l);
+    void merge(SimdLoop* head, SimdLoop* l);
+    void elideContainers(Scope* scope, SimdLoop* head);
+
+    bool sameBound(Scope* scope, Expr* e1, Expr* e2, const SimdLoop::SimdLoops& group);
+    Stmnt* findDecl(Scope* scope, Local* local, size_t& index);
+
+    static void getGroup(SimdLoop* head, SimdLoop::SimdLoops& group);
+    static size_t numAccesses(const SimdLoop::SimdAccesses& accesses, Var* var);
+    static bool onlySimdAccesses(SimdLoop* l, Var* var);
+    static bool isUsed(SimdLoop* l, Var* var);
+};
+
+typedef StmntVisitor<class Fuser> SimdLoopFuser;
+
+//------------------------------------------------------------------------------
+
+} // namespace swift
+
+#endif // SWIFT_SIMDLOOPFUSER_H
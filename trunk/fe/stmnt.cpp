@@ -22,6 +22,8 @@
 #include <sstream>
 #include <typeinfo>
 
+#include "utils/stringhelper.h"
+
 #include "fe/class.h"
 #include "fe/context.h"
 #include "fe/error.h"
@@ -37,9 +39,13 @@ namespace swift {
 
 //------------------------------------------------------------------------------
 
+size_t Stmnt::numCreated_ = 0;
+
 Stmnt::Stmnt(const Location& loc, Scope* parent)
     : Node(loc, parent)
-{}
+{
+    ++numCreated_;
+}
 
 //------------------------------------------------------------------------------
 
@@ -95,14 +101,15 @@ AssignStmnt::AssignStmnt(
         TNList* tuple, 
         TNList* exprList)
     : Stmnt(loc, parent)
-    , id_(id)
+    , id_( intern(id) )
     , tuple_(tuple)
     , exprList_(exprList)
+    , reduction_(0)
+    , reductionExpr_(0)
 {}
 
 AssignStmnt::~AssignStmnt()
 {
-    delete id_;
     delete tuple_;
     delete exprList_;
 }
@@ -160,18 +167,40 @@ void RepeatUntilLoop::accept(StmntVisitorBase* s)
 
 //------------------------------------------------------------------------------
 
+SimdLoop::Reduction::Reduction(Var* var, const ScalarType* scalar, Op op)
+    : var_(var)
+    , scalar_(scalar)
+    , op_(op)
+    , numUpdates_(0)
+    , ordered_(false)
+    , current_(0)
+{
+    for (size_t i = 0; i < NUM_ACCS; ++i)
+        accs_[i] = 0;
+}
+
 SimdLoop::SimdLoop(const Location& loc, Scope* parent, std::string* id, Expr* lExpr, Expr* rExpr)
     : LoopStmnt(loc, parent)
-    , id_(id)
+    , id_( intern(id) )
     , lExpr_(lExpr)
     , rExpr_(rExpr)
+    , index_(0)
+    , sideEffects_(false)
 {}
 
 SimdLoop::~SimdLoop()
 {
-    delete id_;
     delete lExpr_;
     delete rExpr_;
+
+    for (size_t i = 0; i < reductions_.size(); ++i)
+        delete reductions_[i];
+
+    for (size_t i = 0; i < fused_.size(); ++i)
+        delete fused_[i];
+
+    for (size_t i = 0; i < elided_.size(); ++i)
+        delete elided_[i];
 }
 
 void SimdLoop::accept(StmntVisitorBase* s)
@@ -179,6 +208,40 @@ void SimdLoop::accept(StmntVisitorBase* s)
     s->visit(this);
 }
 
+void SimdLoop::addUse(Var* var)
+{
+    ++varUses_[var];
+}
+
+void SimdLoop::addSimdAccess(Var* var, SimdIndexExpr* s)
+{
+    simdAccesses_.push_back( std::make_pair(var, s) );
+}
+
+void SimdLoop::addCall(MemberFct* fct)
+{
+    calls_.push_back(fct);
+}
+
+void SimdLoop::setSideEffects()
+{
+    sideEffects_ = true;
+}
+
+bool SimdLoop::hasSideEffects() const
+{
+    if (sideEffects_)
+        return true;
+
+    for (size_t i = 0; i < calls_.size(); ++i)
+    {
+        if ( !calls_[i]->isPure() )
+            return true;
+    }
+
+    return false;
+}
+
 //------------------------------------------------------------------------------
 
 ScopeStmnt::ScopeStmnt(const Location& loc, Scope* parent)
@@ -20,6 +20,8 @@
 #ifndef SWIFT_STATEMENT_H
 #define SWIFT_STATEMENT_H
 
+#include <map>
+
 #include "utils/assert.h"
 
 #include "fe/fct.h"
@@ -27,6 +29,7 @@
 #include "fe/typelist.h"
 
 namespace llvm {
+    class AllocaInst;
     class BasicBlock;
     class Function;
 }
@@ -38,9 +41,13 @@ namespace swift {
 class Decl;
 class Expr;
 class Local;
+class MemberFct;
+class ScalarType;
 class Scope;
+class SimdIndexExpr;
 class StmntVisitorBase;
 class TNList;
+class Var;
 
 //------------------------------------------------------------------------------
 
@@ -51,6 +58,8 @@ public:
     Stmnt(const Location& loc, Scope* parent);
 
     virtual void accept(StmntVisitorBase* s) = 0;
+
+    static size_t numCreated_; ///< number of statements created so far
 };
 
 //------------------------------------------------------------------------------
@@ -202,18 +211,104 @@ class SimdLoop : public LoopStmnt
 {
 public:
 
+    enum
+    {
+        /// Number of elements the simd index advances per iteration.
+        SIMD_STEP = 4, // HACK
+
+        /// Number of independent vector accumulators per reduction.
+        NUM_ACCS = 4
+    };
+
+    /**
+     * @brief A scalar variable of the enclosing scope which is accumulated
+     * within the loop.
+     *
+     * Each accumulator holds one partial result per lane. The loop is
+     * unrolled \a NUM_ACCS times and each copy of the body updates its own
+     * accumulator so the updates do not depend on each other. After the loop
+     * all accumulators and lanes are combined as a tree. Ordered reductions
+     * instead start with the value of the variable and add one lane after
+     * the other.
+     */
+    struct Reduction
+    {
+        enum Op
+        {
+            ADD, MUL, AND, OR, MIN, MAX
+        };
+
+        Reduction(Var* var, const ScalarType* scalar, Op op);
+
+        Var* var_;
+        const ScalarType* scalar_;
+        Op op_;
+        size_t numUpdates_; ///< Number of statements accumulating var_.
+
+        /// Accumulates lane by lane in source order into a scalar.
+        bool ordered_;
+
+        llvm::AllocaInst* accs_[NUM_ACCS];
+        llvm::AllocaInst* current_; ///< The accumulator of the current copy.
+    };
+
     SimdLoop(const Location& loc, Scope* parent, std::string* id, Expr* lExpr, Expr* rExpr);
     virtual ~SimdLoop();
 
     virtual void accept(StmntVisitorBase* s);
 
+    /// Notes a use of \a var within the loop.
+    void addUse(Var* var);
+
+    /// Notes an access of the form var@ within the loop.
+    void addSimdAccess(Var* var, SimdIndexExpr* s);
+
+    /// Notes a call of \p fct within the loop.
+    void addCall(MemberFct* fct);
+
+    /// The body contains c_calls or stores through references.
+    void setSideEffects();
+
+    /// Also true if an impure member function is called -- see \a MemberFct::isPure.
+    bool hasSideEffects() const;
+
 protected:
 
-    std::string* id_;
+    const std::string* id_;
     Expr* lExpr_;
     Expr* rExpr_;
     Local* index_;
 
+    typedef std::vector<Reduction*> Reductions;
+    Reductions reductions_;
+
+    /// Number of uses of each variable within the loop.
+    typedef std::map<Var*, size_t> VarUses;
+    VarUses varUses_;
+
+    typedef std::vector< std::pair<Var*, SimdIndexExpr*> > SimdAccesses;
+
+    /// All accesses of the form a@ within the loop.
+    SimdAccesses simdAccesses_;
+
+    /// All stores of the form a@ = ... within the loop.
+    SimdAccesses simdStores_;
+
+    /// Directly following simd loops which have been fused into this one.
+    typedef std::vector<SimdLoop*> SimdLoops;
+    SimdLoops fused_;
+
+    /// Simd containers which have been replaced by a value per iteration.
+    std::vector<Local*> registers_;
+
+    /// The removed declarations of \a registers_.
+    std::vector<Stmnt*> elided_;
+
+    /// All member functions called within the loop.
+    std::vector<MemberFct*> calls_;
+
+    bool sideEffects_;
+
     friend class Parser;
     template<class T> friend class StmntVisitor;
 };
@@ -249,7 +344,7 @@ public:
 
 protected:
 
-    std::string* id_;
+    const std::string* id_;
 
     TNList* tuple_;    ///< The lvalues.
     TNList* exprList_; ///< The rvalues.
@@ -264,6 +359,12 @@ protected:
 
     std::vector<AssignCreate> acs_;
 
+    /*
+     * acc = acc op reductionExpr_ within a simd loop
+     */
+    SimdLoop::Reduction* reduction_;
+    Expr* reductionExpr_;
+
     template<class T> friend class StmntVisitor;
 };
 
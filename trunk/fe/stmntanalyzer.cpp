@@ -1,5 +1,6 @@
 #include "fe/stmntanalyzer.h"
 
+#include <map>
 #include <typeinfo>
 
 #include "utils/cast.h"
@@ -11,7 +12,9 @@
 #include "fe/tnlist.h"
 #include "fe/scope.h"
 #include "fe/type.h"
+#include "fe/typenode.h"
 #include "fe/typenodeanalyzer.h"
+#include "fe/var.h"
 
 namespace swift {
 
@@ -39,6 +42,12 @@ void StmntAnalyzer::visit(CFStmnt* s)
         errorf(s->loc(), "'continue' may only be used within loops");
         ctxt_->result_ = false;
     }
+    else if (ctxt_->parallelSimd_ && ctxt_->simdIndex_)
+    {
+        // the body of a parallel simd loop is outlined into its own function
+        errorf(s->loc(), "control flow may not leave a parallel simd loop");
+        ctxt_->result_ = false;
+    }
 }
 
 void StmntAnalyzer::visit(DeclStmnt* s)
@@ -126,9 +135,42 @@ void StmntAnalyzer::visit(SimdLoop* l)
     }
 
     // mark context as "within simd loop"
+    SimdLoop* oldSimdLoop = ctxt_->currentSimdLoop_;
+    ctxt_->currentSimdLoop_ = l;
     ctxt_->simdIndex_ = (llvm::Value*) 1;
     l->scope_->accept(this);
     ctxt_->simdIndex_ = 0;
+    ctxt_->currentSimdLoop_ = oldSimdLoop;
+
+    // the partial results are only combined after the loop
+    for (size_t i = 0; i < l->reductions_.size(); ++i)
+    {
+        SimdLoop::Reduction* r = l->reductions_[i];
+
+        if ( l->varUses_[r->var_] != r->numUpdates_ )
+        {
+            errorf( l->loc(), "'%s' is reduced within this simd loop "
+                    "and must not be used otherwise", r->var_->cid() );
+            ctxt_->result_ = false;
+        }
+    }
+
+    /*
+     * a simd container which is only used by stores of the form a@ = ... is
+     * write-only within this loop
+     */
+
+    std::map<Var*, size_t> numStores;
+    for (size_t i = 0; i < l->simdStores_.size(); ++i)
+        ++numStores[ l->simdStores_[i].first ];
+
+    for (size_t i = 0; i < l->simdStores_.size(); ++i)
+    {
+        Var* var = l->simdStores_[i].first;
+
+        if ( l->varUses_[var] == numStores[var] )
+            l->simdStores_[i].second->setStream(true);
+    }
 }
 
 void StmntAnalyzer::visit(ScopeStmnt* s) 
@@ -164,6 +206,9 @@ void StmntAnalyzer::visit(AssignStmnt* s)
      *      order set l.
      */
 
+    if ( ctxt_->currentSimdLoop_ && analyzeReduction(s) )
+        return;
+
     TNList* lhs = s->tuple_;
     TNList* rhs = s->exprList_;
 
@@ -171,6 +216,28 @@ void StmntAnalyzer::visit(AssignStmnt* s)
     rhs->accept(tna_);
     lhs->accept(tna_);
 
+    // only stores to variables can be tracked within simd loops
+    if (ctxt_->currentSimdLoop_)
+    {
+        for (size_t i = 0; i < lhs->numTypeNodes(); ++i)
+        {
+            TypeNode* tn = lhs->getTypeNode(i);
+
+            if ( !dynamic<Decl>(tn) && !dynamic<Id>(tn) && !dynamic<SimdIndexExpr>(tn) )
+                ctxt_->currentSimdLoop_->setSideEffects();
+        }
+    }
+
+    // stores through references make the current member function impure
+    if (ctxt_->memberFct_)
+    {
+        for (size_t i = 0; i < lhs->numTypeNodes(); ++i)
+        {
+            if ( !isLocalStore(lhs->getTypeNode(i)) )
+                ctxt_->memberFct_->setSideEffects();
+        }
+    }
+
     swiftAssert( lhs->numTypeNodes() != 0 && rhs->numTypeNodes() != 0,
             "there must be at least one item on the left- "
             "and one on the right-hand side" );
@@ -233,6 +300,235 @@ void StmntAnalyzer::visit(AssignStmnt* s)
     // finally check each constructor/assign call
     for (size_t i = 0; i < s->acs_.size(); ++i)
         s->acs_[i].check();
+
+    if ( ctxt_->currentSimdLoop_ && numLhs == 1 )
+        registerSimdStore( lhs->getTypeNode(0) );
+}
+
+void StmntAnalyzer::registerSimdStore(TypeNode* lhs)
+{
+    SimdIndexExpr* s = dynamic<SimdIndexExpr>(lhs);
+    if (!s)
+        return;
+
+    Id* id = dynamic<Id>( s->getPrefixExpr() );
+    if ( !id || !id->get().type_->cast<Simd>() )
+        return; // elements of arrays may be unaligned
+
+    Var* var = ctxt_->scope()->lookupVar( id->id() );
+    ctxt_->currentSimdLoop_->simdStores_.push_back( std::make_pair(var, s) );
+}
+
+/*
+ * Stores to locals and return values and to their members stay within the
+ * current member function. Everything else, like stores via an index, through
+ * a pointer, to a param or to a member of this, is a store through a
+ * reference.
+ */
+bool StmntAnalyzer::isLocalStore(TypeNode* lhs)
+{
+    if ( dynamic<Decl>(lhs) )
+        return true;
+
+    while ( MemberAccess* m = dynamic<MemberAccess>(lhs) )
+    {
+        Expr* prefix = m->getPrefixExpr();
+
+        if ( !prefix || prefix->numResults() != 1 || prefix->get().type_->cast<Ptr>() )
+            return false;
+
+        lhs = prefix;
+    }
+
+    Id* id = dynamic<Id>(lhs);
+    if (!id)
+        return false;
+
+    Var* var = ctxt_->scope()->lookupVar( id->id() );
+
+    return var && !dynamic<Param>(var);
+}
+
+/*
+ * Within a simd loop
+ *
+ *     acc = acc + expr     (likewise *, & and |)
+ *     acc = acc.min(expr)  (likewise max)
+ *
+ * is a reduction if acc is a scalar variable of the enclosing scope. This is
+ * decided by the shape of the statement alone; expr must then be a simd
+ * expression of the same type and acc must not be used otherwise within the
+ * loop.
+ */
+bool StmntAnalyzer::analyzeReduction(AssignStmnt* s)
+{
+    typedef SimdLoop::Reduction Reduction;
+
+    if ( s->tuple_->numTypeNodes() != 1 || s->exprList_->numTypeNodes() != 1 )
+        return false;
+
+    Id* lhs = dynamic<Id>( s->tuple_->getTypeNode(0) );
+    if (!lhs)
+        return false;
+
+    SimdLoop* l = ctxt_->currentSimdLoop_;
+    Var* var = ctxt_->scope()->lookupVar( lhs->id() );
+
+    // must not be shadowed by a variable of the loop
+    if ( !var || l->parent<Scope>()->lookupVar( lhs->id() ) != var )
+        return false;
+
+    const ScalarType* scalar = var->getType()->cast<ScalarType>();
+    if ( !scalar || scalar->isSimd() )
+        return false;
+
+    /*
+     * match the right-hand side
+     */
+
+    TypeNode* rhs = s->exprList_->getTypeNode(0);
+    Id* acc = 0;
+    Expr* expr = 0;
+    Reduction::Op op;
+
+    if ( BinExpr* b = dynamic<BinExpr>(rhs) )
+    {
+        acc = dynamic<Id>( b->getOp1() );
+        expr = b->getOp2();
+
+        const std::string& id = *b->id();
+        if (id == "+")
+            op = Reduction::ADD;
+        else if (id == "*")
+            op = Reduction::MUL;
+        else if (id == "&")
+            op = Reduction::AND;
+        else if (id == "|")
+            op = Reduction::OR;
+        else
+            return false;
+    }
+    else if ( MethodCall* m = dynamic<MethodCall>(rhs) )
+    {
+        if ( m->getExprList()->numTypeNodes() != 1 )
+            return false;
+
+        acc = dynamic<Id>( m->getExpr() );
+        expr = dynamic<Expr>( m->getExprList()->getTypeNode(0) );
+
+        const std::string& id = *m->id();
+        if (id == "min")
+            op = Reduction::MIN;
+        else if (id == "max")
+            op = Reduction::MAX;
+        else
+            return false;
+    }
+    else
+        return false;
+
+    if ( !acc || !expr || *acc->id() != *lhs->id() )
+        return false;
+
+    /*
+     * check the accumulated expression -- it is analyzed here only
+     */
+
+    bool oldResult = ctxt_->result_;
+    ctxt_->result_ = true;
+    expr->accept(tna_);
+    bool exprResult = ctxt_->result_;
+    ctxt_->result_ &= oldResult;
+
+    if (!exprResult)
+        return true; // error already reported
+
+    Type* simdType = scalar->simdClone();
+    bool typesMatch = expr->numResults() == 1 && expr->get().type_->check(simdType, ctxt_->module_);
+    delete simdType;
+
+    if (!typesMatch)
+    {
+        if ( expr->numResults() == 1 )
+        {
+            errorf( expr->loc(), "the reduced expression must be of type 'simd %s' "
+                    "but type '%s' is given", 
+                    scalar->toString().c_str(),
+                    expr->get().type_->toString().c_str() );
+        }
+        else
+        {
+            errorf( expr->loc(), "the reduced expression must be of type 'simd %s'", 
+                    scalar->toString().c_str() );
+        }
+
+        ctxt_->result_ = false;
+        return true;
+    }
+
+    bool ok;
+    switch (op)
+    {
+        case Reduction::ADD:
+        case Reduction::MUL: ok = !scalar->isBool() && !scalar->isSaturating(); break;
+        case Reduction::AND:
+        case Reduction::OR:  ok = !scalar->isFloat(); break;
+        default:             ok = !scalar->isBool(); break;
+    }
+
+    if (!ok)
+    {
+        errorf( s->loc(), "this reduction is not supported for type '%s'", 
+                scalar->toString().c_str() );
+        ctxt_->result_ = false;
+        return true;
+    }
+
+    // -fp-model strict keeps the source order which parallel chunks do not
+    bool ordered = ctxt_->fpModel_ == Context::FP_STRICT && scalar->isFloat();
+
+    if (ordered && ctxt_->parallelSimd_)
+    {
+        errorf( s->loc(), "floating point reductions cannot run in parallel "
+                "with -fp-model strict" );
+        ctxt_->result_ = false;
+        return true;
+    }
+
+    /*
+     * register reduction
+     */
+
+    Reduction* reduction = 0;
+
+    for (size_t i = 0; i < l->reductions_.size(); ++i)
+    {
+        if (l->reductions_[i]->var_ == var)
+            reduction = l->reductions_[i];
+    }
+
+    if (!reduction)
+    {
+        reduction = new Reduction(var, scalar, op);
+        reduction->ordered_ = ordered;
+        l->reductions_.push_back(reduction);
+    }
+    else if (reduction->op_ != op)
+    {
+        errorf( s->loc(), "'%s' is reduced with different operations within "
+                "this simd loop", lhs->cid() );
+        ctxt_->result_ = false;
+        return true;
+    }
+
+    ++ctxt_->varUses_[var];
+    ++l->varUses_[var];
+    ++reduction->numUpdates_;
+
+    s->reduction_ = reduction;
+    s->reductionExpr_ = expr;
+
+    return true;
 }
 
 void StmntAnalyzer::visit(ExprStmnt* s)
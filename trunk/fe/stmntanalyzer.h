@@ -40,6 +40,10 @@ private:
                            size_t r_begin, 
                            size_t r_end);
 
+    bool analyzeReduction(AssignStmnt* s);
+    void registerSimdStore(TypeNode* lhs);
+    bool isLocalStore(TypeNode* lhs);
+
     TypeNodeAnalyzer* tna_;
 };
 
@@ -1,13 +1,21 @@
 #include "fe/stmntcodegen.h"
 
+#include <limits>
+#include <map>
 #include <typeinfo>
+#include <vector>
 
 #include <llvm/BasicBlock.h>
+#include <llvm/Constants.h>
+#include <llvm/DerivedTypes.h>
 #include <llvm/Function.h>
 #include <llvm/LLVMContext.h>
 #include <llvm/Module.h>
 
 #include "utils/cast.h"
+#include "utils/llvmplace.h"
+
+#include "vec/vectype.h"
 
 #include "fe/context.h"
 #include "fe/class.h"
@@ -15,6 +23,7 @@
 #include "fe/scope.h"
 #include "fe/type.h"
 #include "fe/typenodecodegen.h"
+#include "fe/var.h"
 
 using llvm::Value;
 
@@ -209,33 +218,152 @@ void StmntCodeGen::visit(WhileLoop* l)
 
 void StmntCodeGen::visit(SimdLoop* l)
 {
-    llvm::Function* llvmFct = ctxt_->llvmFct_;
-
     /*
-     * create new basic blocks
+     * evaluate bounds
      */
 
-    llvm::BasicBlock* headerBB = llvm::BasicBlock::Create(lctxt_, "simd-header");
-    l->loopBB_ = llvm::BasicBlock::Create(lctxt_, "simd");
-    l->outBB_  = llvm::BasicBlock::Create(lctxt_, "simd-out");
+    l->lExpr_->accept(tncg_);
+    Value* lower = l->lExpr_->get().place_->getScalar(builder_);
+
+    l->rExpr_->accept(tncg_);
+    Value* upper = l->rExpr_->get().place_->getScalar(builder_);
+
+    if (ctxt_->streamThreshold_ == 0)
+    {
+        emitSimdLoopVariant(l, lower, upper, false);
+        return;
+    }
+
+    Value* tripCount = builder_.CreateSub(upper, lower);
+
+    // known trip count -> decide now
+    if ( llvm::ConstantInt* c = llvm::dyn_cast<llvm::ConstantInt>(tripCount) )
+    {
+        emitSimdLoopVariant(l, lower, upper, c->getSExtValue() >= (int64_t) ctxt_->streamThreshold_);
+        return;
+    }
 
     /*
-     * close current bb
+     * otherwise emit both variants and decide at run time
      */
 
+    llvm::Function* llvmFct = ctxt_->llvmFct_;
+
+    typedef llvm::BasicBlock BB;
+    BB* streamBB = llvm::BasicBlock::Create(lctxt_, "simd-stream");
+    BB* cachedBB = llvm::BasicBlock::Create(lctxt_, "simd-cached");
+    BB* mergeBB  = llvm::BasicBlock::Create(lctxt_, "simd-merge");
+
+    Value* cond = builder_.CreateICmpSGE( tripCount, createInt64(lctxt_, ctxt_->streamThreshold_) );
+    builder_.CreateCondBr(cond, streamBB, cachedBB);
+
+    llvmFct->getBasicBlockList().push_back(streamBB);
+    builder_.SetInsertPoint(streamBB);
+    emitSimdLoopVariant(l, lower, upper, true);
+    builder_.CreateBr(mergeBB);
+
+    llvmFct->getBasicBlockList().push_back(cachedBB);
+    builder_.SetInsertPoint(cachedBB);
+    emitSimdLoopVariant(l, lower, upper, false);
+    builder_.CreateBr(mergeBB);
+
+    llvmFct->getBasicBlockList().push_back(mergeBB);
+    builder_.SetInsertPoint(mergeBB);
+}
+
+/*
+ * Streaming loops use non-temporal stores for write-only simd containers and
+ * prefetch all other simd accesses. The stores are fenced at the end of each
+ * loop -- in the case of a parallel loop within each worker.
+ */
+void StmntCodeGen::emitSimdLoopVariant(SimdLoop* l, Value* lower, Value* upper, bool streaming)
+{
+    ctxt_->streaming_ = streaming;
+
+    if (ctxt_->parallelSimd_)
+        emitParallelSimdLoop(l, lower, upper);
+    else
+        emitSimdLoop(l, lower, upper);
+
+    ctxt_->streaming_ = false;
+}
+
+void StmntCodeGen::emitSimdLoop(SimdLoop* l, Value* lower, Value* upper)
+{
     // init loop index
     ctxt_->simdIndex_ = createEntryAlloca( 
             builder_, 
             llvm::IntegerType::getInt64Ty(lctxt_), 
             l->id_ ? l->id_->c_str() : "simdindex" );
-    l->index_->setAlloca( cast<llvm::AllocaInst>(ctxt_->simdIndex_) );
 
-    l->lExpr_->accept(tncg_);
-    builder_.CreateStore( l->lExpr_->get().place_->getScalar(builder_), ctxt_->simdIndex_ );
+    if (l->index_)
+        l->index_->setAlloca( cast<llvm::AllocaInst>(ctxt_->simdIndex_) );
 
-    l->rExpr_->accept(tncg_);
-    Value* upper = l->rExpr_->get().place_->getScalar(builder_);
+    builder_.CreateStore(lower, ctxt_->simdIndex_);
+
+    for (size_t i = 0; i < l->fused_.size(); ++i)
+    {
+        if (l->fused_[i]->index_)
+            l->fused_[i]->index_->setAlloca( cast<llvm::AllocaInst>(ctxt_->simdIndex_) );
+    }
+
+    // elided simd containers only hold the value of the current iteration
+    for (size_t i = 0; i < l->registers_.size(); ++i)
+    {
+        Local* local = l->registers_[i];
+        const Type* inner = cast<Simd>( local->getType() )->getInnerType();
+
+        int simdLength;
+        const llvm::Type* vecType = inner->getVecLLVMType(ctxt_->module_, simdLength);
+        local->setAlloca( createEntryAlloca(builder_, vecType, local->cid()) );
+    }
+
+    if ( l->reductions_.empty() )
+    {
+        emitSimdLoopCopies(l, upper, 1);
+
+        if (ctxt_->streaming_)
+            createStoreFence(builder_);
+
+        return;
+    }
+
+    /*
+     * each of the NUM_ACCS copies of the body updates its own accumulators;
+     * a second loop with a single copy runs the remaining iterations -- this
+     * reassociates floating point reductions across copies so it needs
+     * -fp-model fast; -fp-model contract only reassociates across the lanes
+     * of one accumulator and -fp-model strict keeps the order of the lanes
+     */
+
+    initReductions(l);
+
+    if ( ctxt_->fpModel_ == Context::FP_FAST || !hasFloatReduction(l) )
+        emitSimdLoopCopies(l, upper, SimdLoop::NUM_ACCS);
+
+    emitSimdLoopCopies(l, upper, 1);
+
+    if (ctxt_->streaming_)
+        createStoreFence(builder_);
+
+    exitReductions(l);
+}
+
+void StmntCodeGen::emitSimdLoopCopies(SimdLoop* l, Value* upper, size_t numCopies)
+{
+    llvm::Function* llvmFct = ctxt_->llvmFct_;
+
+    /*
+     * create new basic blocks
+     */
 
+    llvm::BasicBlock* headerBB = llvm::BasicBlock::Create(lctxt_, "simd-header");
+    l->loopBB_ = llvm::BasicBlock::Create(lctxt_, "simd");
+    l->outBB_  = llvm::BasicBlock::Create(lctxt_, "simd-out");
+
+    /*
+     * close current bb
+     */
 
     builder_.CreateBr(headerBB);
 
@@ -246,9 +374,13 @@ void StmntCodeGen::visit(SimdLoop* l)
     llvmFct->getBasicBlockList().push_back(headerBB);
     builder_.SetInsertPoint(headerBB);
 
-    Value* lower = builder_.CreateLoad(ctxt_->simdIndex_);
+    Value* index = builder_.CreateLoad(ctxt_->simdIndex_);
+
+    // the last copy must still be in range
+    if (numCopies > 1)
+        index = builder_.CreateAdd( index, ::createInt64(lctxt_, (numCopies-1) * SimdLoop::SIMD_STEP) );
 
-    Value* cond = builder_.CreateICmpULT(lower, upper);
+    Value* cond = builder_.CreateICmpULT(index, upper);
     builder_.CreateCondBr(cond, l->loopBB_, l->outBB_);
 
     /*
@@ -257,11 +389,22 @@ void StmntCodeGen::visit(SimdLoop* l)
 
     llvmFct->getBasicBlockList().push_back(l->loopBB_);
     builder_.SetInsertPoint(l->loopBB_);
-    l->scope_->accept(this);
 
-    builder_.CreateStore( 
-            builder_.CreateAdd( builder_.CreateLoad(ctxt_->simdIndex_), 
-            ::createInt64(lctxt_, 4) ), ctxt_->simdIndex_ ); // HACK
+    for (size_t i = 0; i < numCopies; ++i)
+    {
+        for (size_t j = 0; j < l->reductions_.size(); ++j)
+            l->reductions_[j]->current_ = l->reductions_[j]->accs_[i];
+
+        l->scope_->accept(this);
+
+        for (size_t j = 0; j < l->fused_.size(); ++j)
+            l->fused_[j]->scope_->accept(this);
+
+        builder_.CreateStore( 
+                builder_.CreateAdd( builder_.CreateLoad(ctxt_->simdIndex_), 
+                ::createInt64(lctxt_, SimdLoop::SIMD_STEP) ), ctxt_->simdIndex_ );
+    }
+
     builder_.CreateBr(headerBB);
 
     /*
@@ -272,6 +415,374 @@ void StmntCodeGen::visit(SimdLoop* l)
     builder_.SetInsertPoint(l->outBB_);
 }
 
+bool StmntCodeGen::hasFloatReduction(SimdLoop* l)
+{
+    for (size_t i = 0; i < l->reductions_.size(); ++i)
+    {
+        if ( l->reductions_[i]->scalar_->isFloat() )
+            return true;
+    }
+
+    return false;
+}
+
+void StmntCodeGen::initReductions(SimdLoop* l)
+{
+    for (size_t i = 0; i < l->reductions_.size(); ++i)
+    {
+        SimdLoop::Reduction* r = l->reductions_[i];
+
+        // the same type the reduced simd expressions yield
+        int simdLength;
+        const llvm::Type* type = r->scalar_->getVecLLVMType(ctxt_->module_, simdLength);
+        Value* init;
+
+        if (r->ordered_)
+        {
+            type = r->scalar_->getLLVMType(ctxt_->module_);
+            init = builder_.CreateLoad( r->var_->getAddr(builder_) );
+        }
+        else
+            init = createNeutral(r, type);
+
+        // these allocas are promoted to registers later on
+        for (size_t j = 0; j < SimdLoop::NUM_ACCS; ++j)
+        {
+            r->accs_[j] = createEntryAlloca(builder_, type, *r->var_->id() + ".acc");
+            builder_.CreateStore(init, r->accs_[j]);
+        }
+    }
+}
+
+void StmntCodeGen::exitReductions(SimdLoop* l)
+{
+    std::vector<Value*> partials;
+
+    for (size_t i = 0; i < l->reductions_.size(); ++i)
+    {
+        SimdLoop::Reduction* r = l->reductions_[i];
+
+        // only a single copy of the loop has been emitted
+        if (r->ordered_)
+        {
+            partials.push_back( builder_.CreateLoad(r->accs_[0]) );
+            continue;
+        }
+
+        Value* accs[SimdLoop::NUM_ACCS];
+        for (size_t j = 0; j < SimdLoop::NUM_ACCS; ++j)
+            accs[j] = builder_.CreateLoad(r->accs_[j]);
+
+        // combine the accumulators as a tree
+        for (size_t stride = 1; stride < SimdLoop::NUM_ACCS; stride *= 2)
+        {
+            for (size_t j = 0; j + stride < SimdLoop::NUM_ACCS; j += 2*stride)
+                accs[j] = emitReductionOp(r, accs[j], accs[j + stride]);
+        }
+
+        // combine the upper half of the lanes with the lower one until one is left
+        Value* vec = accs[0];
+        const llvm::Type* int32Type = llvm::IntegerType::getInt32Ty(lctxt_);
+        size_t simdLength = cast<llvm::VectorType>( vec->getType() )->getNumElements();
+
+        for (size_t n = simdLength / 2; n >= 1; n /= 2)
+        {
+            std::vector<llvm::Constant*> mask;
+            for (size_t j = 0; j < simdLength; ++j)
+            {
+                mask.push_back( j < n 
+                        ? (llvm::Constant*) ::createInt32(lctxt_, j + n) 
+                        : (llvm::Constant*) llvm::UndefValue::get(int32Type) );
+            }
+
+            Value* upperHalf = builder_.CreateShuffleVector( 
+                    vec, llvm::UndefValue::get( vec->getType() ), llvm::ConstantVector::get(mask) );
+            vec = emitReductionOp(r, vec, upperHalf);
+        }
+
+        // bool accumulators are masks but the variable holds a single i1
+        if ( r->scalar_->isBool() )
+            vec = vec::toPredicate(builder_, vec);
+
+        partials.push_back( builder_.CreateExtractElement(vec, ::createInt32(lctxt_, 0)) );
+    }
+
+    /*
+     * update the variables -- other chunks of a parallel simd loop may do the
+     * same concurrently
+     */
+
+    if (ctxt_->parallelSimd_)
+        emitRuntimeCall("swift_parallel_lock");
+
+    for (size_t i = 0; i < l->reductions_.size(); ++i)
+    {
+        SimdLoop::Reduction* r = l->reductions_[i];
+        Value* addr = r->var_->getAddr(builder_);
+
+        // an ordered accumulator already includes the old value
+        if (r->ordered_)
+            builder_.CreateStore(partials[i], addr);
+        else
+            builder_.CreateStore( emitReductionOp(r, builder_.CreateLoad(addr), partials[i]), addr );
+    }
+
+    if (ctxt_->parallelSimd_)
+        emitRuntimeCall("swift_parallel_unlock");
+}
+
+Value* StmntCodeGen::emitReductionOp(SimdLoop::Reduction* r, Value* v1, Value* v2)
+{
+    switch (r->op_)
+    {
+        case SimdLoop::Reduction::ADD: return builder_.CreateAdd(v1, v2);
+        case SimdLoop::Reduction::MUL: return builder_.CreateMul(v1, v2);
+        case SimdLoop::Reduction::AND: return builder_.CreateAnd(v1, v2);
+        case SimdLoop::Reduction::OR:  return builder_.CreateOr (v1, v2);
+        case SimdLoop::Reduction::MIN: return tncg_->emitMinMax(r->scalar_, v1, v2, false);
+        case SimdLoop::Reduction::MAX: return tncg_->emitMinMax(r->scalar_, v1, v2, true);
+    }
+
+    swiftAssert(false, "unreachable");
+    return 0;
+}
+
+Value* StmntCodeGen::createNeutral(SimdLoop::Reduction* r, const llvm::Type* type)
+{
+    const ScalarType* scalar = r->scalar_;
+    const llvm::Type* elemType = scalar->getLLVMType(ctxt_->module_);
+    llvm::Constant* neutral;
+
+    switch (r->op_)
+    {
+        case SimdLoop::Reduction::ADD:
+        case SimdLoop::Reduction::OR:
+            return llvm::Constant::getNullValue(type);
+
+        case SimdLoop::Reduction::AND:
+            return llvm::Constant::getAllOnesValue(type);
+
+        case SimdLoop::Reduction::MUL:
+            neutral = scalar->isFloat() 
+                    ? llvm::ConstantFP::get(elemType, 1.0) 
+                    : (llvm::Constant*) llvm::ConstantInt::get(elemType, 1);
+            break;
+
+        case SimdLoop::Reduction::MIN:
+        case SimdLoop::Reduction::MAX:
+        {
+            bool isMax = r->op_ == SimdLoop::Reduction::MAX;
+
+            if ( scalar->isFloat() )
+            {
+                double inf = std::numeric_limits<double>::infinity();
+                neutral = llvm::ConstantFP::get(elemType, isMax ? -inf : inf);
+            }
+            else
+            {
+                unsigned bits = elemType->getPrimitiveSizeInBits();
+                llvm::APInt val = scalar->isSigned()
+                    ? (isMax ? llvm::APInt::getSignedMinValue(bits) : llvm::APInt::getSignedMaxValue(bits))
+                    : (isMax ? llvm::APInt::getMinValue(bits)       : llvm::APInt::getMaxValue(bits));
+                neutral = llvm::ConstantInt::get(lctxt_, val);
+            }
+            break;
+        }
+
+        default:
+            swiftAssert(false, "unreachable");
+            return 0;
+    }
+
+    std::vector<llvm::Constant*> elems( cast<llvm::VectorType>(type)->getNumElements(), neutral );
+    return llvm::ConstantVector::get(elems);
+}
+
+void StmntCodeGen::emitRuntimeCall(const char* name)
+{
+    llvm::Constant* fct = ctxt_->lmodule()->getOrInsertFunction( name, 
+            llvm::FunctionType::get( createVoid(lctxt_), std::vector<const llvm::Type*>(), false ) );
+    builder_.CreateCall(fct);
+}
+
+/*
+ * The loop is outlined into
+ *
+ *     void fct.simd(i8* env, i64 lo, i64 hi)
+ *
+ * which runs the iterations [lo, hi). All values of the enclosing function the
+ * body refers to are passed in the env struct. Allocas are passed by address
+ * so the body works on the very same variables. The runtime function
+ *
+ *     swift_parallel_for(fct.simd, env, lower, upper, step)
+ *
+ * (see test/parallel.c) splits [lower, upper) into multiples of step and
+ * distributes these chunks among its worker threads.
+ */
+void StmntCodeGen::emitParallelSimdLoop(SimdLoop* l, Value* lower, Value* upper)
+{
+    llvm::Function* outerFct = ctxt_->llvmFct_;
+    llvm::BasicBlock* outerBB = builder_.GetInsertBlock();
+
+    const llvm::Type* int64Type = llvm::IntegerType::getInt64Ty(lctxt_);
+    const llvm::PointerType* envPtrType = 
+        llvm::PointerType::getUnqual( llvm::IntegerType::getInt8Ty(lctxt_) );
+
+    /*
+     * create chunk function
+     */
+
+    std::vector<const llvm::Type*> params;
+    params.push_back(envPtrType);
+    params.push_back(int64Type);
+    params.push_back(int64Type);
+
+    const llvm::FunctionType* chunkType = 
+        llvm::FunctionType::get( createVoid(lctxt_), params, false );
+    llvm::Function* chunkFct = llvm::Function::Create(
+            chunkType, 
+            llvm::GlobalValue::InternalLinkage, 
+            outerFct->getNameStr() + ".simd", 
+            ctxt_->lmodule() );
+
+    llvm::Function::arg_iterator argIter = chunkFct->arg_begin();
+    Value* env = argIter++;
+    Value* lo  = argIter++;
+    Value* hi  = argIter;
+    env->setName("env");
+    lo->setName("lo");
+    hi->setName("hi");
+
+    /*
+     * emit loop into chunk function
+     */
+
+    llvm::BasicBlock* entryBB = llvm::BasicBlock::Create(lctxt_, "entry", chunkFct);
+    ctxt_->llvmFct_ = chunkFct;
+    builder_.SetInsertPoint(entryBB);
+
+    emitSimdLoop(l, lo, hi);
+    builder_.CreateRetVoid();
+
+    ctxt_->llvmFct_ = outerFct;
+    builder_.SetInsertPoint(outerBB);
+
+    /*
+     * find all values of the enclosing function used in the chunk function
+     */
+
+    typedef std::map<Value*, size_t> Captures;
+    Captures captures;
+    std::vector<Value*> captured;
+    std::vector<const llvm::Type*> envTypes;
+
+    for (llvm::Function::iterator bb = chunkFct->begin(); bb != chunkFct->end(); ++bb)
+    {
+        for (llvm::BasicBlock::iterator i = bb->begin(); i != bb->end(); ++i)
+        {
+            for (unsigned op = 0; op < i->getNumOperands(); ++op)
+            {
+                Value* val = i->getOperand(op);
+
+                swiftAssert( !dynamic<llvm::BasicBlock>(val) 
+                        || cast<llvm::BasicBlock>(val)->getParent() == chunkFct,
+                        "control flow must not leave the chunk function" );
+
+                if ( !isCaptured(val, chunkFct) )
+                    continue;
+
+                if ( captures.insert( std::make_pair(val, captured.size()) ).second )
+                {
+                    captured.push_back(val);
+                    envTypes.push_back( val->getType() );
+                }
+            }
+        }
+    }
+
+    Value* envArg = llvm::ConstantPointerNull::get(envPtrType);
+
+    if ( !captured.empty() )
+    {
+        const llvm::StructType* envType = llvm::StructType::get(lctxt_, envTypes);
+
+        /*
+         * unpack env in the entry of the chunk function and substitute
+         */
+
+        LLVMBuilder tmpBuilder( entryBB, 
+                llvm::BasicBlock::iterator(entryBB->getTerminator()) );
+        Value* envPtr = tmpBuilder.CreateBitCast( 
+                env, llvm::PointerType::getUnqual(envType) );
+
+        std::vector<Value*> unpacked;
+        for (size_t i = 0; i < captured.size(); ++i)
+        {
+            unpacked.push_back( tmpBuilder.CreateLoad(
+                        tmpBuilder.CreateStructGEP(envPtr, i), 
+                        captured[i]->getName() ) );
+        }
+
+        for (llvm::Function::iterator bb = chunkFct->begin(); bb != chunkFct->end(); ++bb)
+        {
+            for (llvm::BasicBlock::iterator i = bb->begin(); i != bb->end(); ++i)
+            {
+                for (unsigned op = 0; op < i->getNumOperands(); ++op)
+                {
+                    Captures::iterator iter = captures.find( i->getOperand(op) );
+                    if ( iter != captures.end() )
+                        i->setOperand( op, unpacked[iter->second] );
+                }
+            }
+        }
+
+        /*
+         * pack env in the enclosing function
+         */
+
+        Value* envAlloca = createEntryAlloca(builder_, envType, "simd-env");
+        for (size_t i = 0; i < captured.size(); ++i)
+            builder_.CreateStore( captured[i], builder_.CreateStructGEP(envAlloca, i) );
+
+        envArg = builder_.CreateBitCast(envAlloca, envPtrType);
+    }
+
+    /*
+     * hand over to the runtime
+     */
+
+    std::vector<const llvm::Type*> forParams;
+    forParams.push_back( llvm::PointerType::getUnqual(chunkType) );
+    forParams.push_back(envPtrType);
+    forParams.push_back(int64Type);
+    forParams.push_back(int64Type);
+    forParams.push_back(int64Type);
+
+    llvm::Constant* parallelFor = ctxt_->lmodule()->getOrInsertFunction(
+            "swift_parallel_for",
+            llvm::FunctionType::get( createVoid(lctxt_), forParams, false ) );
+
+    std::vector<Value*> args;
+    args.push_back(chunkFct);
+    args.push_back(envArg);
+    args.push_back(lower);
+    args.push_back(upper);
+    args.push_back( ::createInt64(lctxt_, SimdLoop::SIMD_STEP) );
+
+    builder_.CreateCall( parallelFor, args.begin(), args.end() );
+}
+
+bool StmntCodeGen::isCaptured(Value* val, llvm::Function* fct)
+{
+    if ( llvm::Instruction* inst = dynamic<llvm::Instruction>(val) )
+        return inst->getParent()->getParent() != fct;
+
+    if ( llvm::Argument* arg = dynamic<llvm::Argument>(val) )
+        return arg->getParent() != fct;
+
+    return false;
+}
+
 void StmntCodeGen::visit(ScopeStmnt* s) 
 {
     s->scope_->accept(this);
@@ -279,6 +790,37 @@ void StmntCodeGen::visit(ScopeStmnt* s)
 
 void StmntCodeGen::visit(AssignStmnt* s)
 {
+    if (s->reduction_)
+    {
+        // accumulate into the vector accumulator of the current copy
+        s->reductionExpr_->accept(tncg_);
+        Value* val = s->reductionExpr_->get().place_->getScalar(builder_);
+        llvm::AllocaInst* acc = s->reduction_->current_;
+
+        // bool accumulators are masks
+        if ( vec::isPredicate(val->getType()) )
+            val = vec::toMask( builder_, val, acc->getAllocatedType() );
+
+        if (s->reduction_->ordered_)
+        {
+            // one lane after the other just like the scalar loop
+            Value* result = builder_.CreateLoad(acc);
+            size_t simdLength = cast<llvm::VectorType>( val->getType() )->getNumElements();
+
+            for (size_t i = 0; i < simdLength; ++i)
+            {
+                result = emitReductionOp( s->reduction_, result, 
+                        builder_.CreateExtractElement(val, ::createInt32(lctxt_, i)) );
+            }
+
+            builder_.CreateStore(result, acc);
+        }
+        else
+            builder_.CreateStore( emitReductionOp(s->reduction_, builder_.CreateLoad(acc), val), acc );
+
+        return;
+    }
+
     s->tuple_->accept(tncg_);
 
     switch (s->kind_)
@@ -291,38 +833,95 @@ void StmntCodeGen::visit(AssignStmnt* s)
         }
         case AssignStmnt::PAIRWISE:
         {
-            // propagate inits for return value optimization
-            size_t left = 0; // iterates over rTN's corresponding lhs items
-            // for each rhs TypeNode
-            for (size_t i = 0; i < s->exprList_->numTypeNodes(); ++i)
+            if ( s->acs_.size() == 1 )
             {
-                TypeNode* rTN = s->exprList_->getTypeNode(i);
-
+                Place* lPlace = s->tuple_->getTypeNode(0)->get().place_;
 
-                Places places;
-                // for each result of rTN
-                for (size_t j = 0; j < rTN->numResults(); ++j, ++left)
+                if ( GatherAddr* scatter = dynamic<GatherAddr>(lPlace) )
                 {
-                    TypeNode* lTN = s->tuple_->getTypeNode(left);
-
-                    Place* place = s->acs_[left].initsRhs() ? lTN->get().place_ : 0;
-                    places.push_back(place);
+                    emitScatter(s, scatter);
+                    return;
                 }
-
-                if ( MemberFctCall* call = dynamic<MemberFctCall>(rTN) )
-                    call->initPlaces_ = &places;
-                    
-                rTN->accept(tncg_);
             }
 
-            for (size_t i = 0; i < s->acs_.size(); ++i)
-                s->acs_[i].genCode();
-
+            emitPairwise(s);
             return;
         }
     }
 }
 
+void StmntCodeGen::emitPairwise(AssignStmnt* s)
+{
+    // propagate inits for return value optimization
+    size_t left = 0; // iterates over rTN's corresponding lhs items
+    // for each rhs TypeNode
+    for (size_t i = 0; i < s->exprList_->numTypeNodes(); ++i)
+    {
+        TypeNode* rTN = s->exprList_->getTypeNode(i);
+
+        Places places;
+        // for each result of rTN
+        for (size_t j = 0; j < rTN->numResults(); ++j, ++left)
+        {
+            TypeNode* lTN = s->tuple_->getTypeNode(left);
+
+            Place* place = s->acs_[left].initsRhs() ? lTN->get().place_ : 0;
+            places.push_back(place);
+        }
+
+        if ( MemberFctCall* call = dynamic<MemberFctCall>(rTN) )
+            call->initPlaces_ = &places;
+            
+        rTN->accept(tncg_);
+    }
+
+    for (size_t i = 0; i < s->acs_.size(); ++i)
+        s->acs_[i].genCode();
+}
+
+/*
+ * Something like
+ *
+ *     a[idx] = a[idx] + 1
+ *
+ * must see the stores of the lower lanes if several lanes of idx are equal.
+ * If so, the rhs is evaluated and scattered once for each lane -- i.e. the
+ * read-modify-write runs serially just like the scalar loop.
+ */
+void StmntCodeGen::emitScatter(AssignStmnt* s, GatherAddr* scatter)
+{
+    llvm::Function* llvmFct = builder_.GetInsertBlock()->getParent();
+
+    typedef llvm::BasicBlock BB;
+    BB* vecBB    = llvm::BasicBlock::Create(lctxt_, "scatter-vec");
+    BB* serialBB = llvm::BasicBlock::Create(lctxt_, "scatter-serial");
+    BB* mergeBB  = llvm::BasicBlock::Create(lctxt_, "scatter-merge");
+
+    builder_.CreateCondBr( scatter->emitConflictCheck(builder_), serialBB, vecBB );
+
+    // no conflicts -> scatter all lanes at once
+    llvmFct->getBasicBlockList().push_back(vecBB);
+    builder_.SetInsertPoint(vecBB);
+    emitPairwise(s);
+    builder_.CreateBr(mergeBB);
+
+    // conflicts -> one lane after the other
+    llvmFct->getBasicBlockList().push_back(serialBB);
+    builder_.SetInsertPoint(serialBB);
+
+    for (size_t lane = 0; lane < scatter->numLanes(); ++lane)
+    {
+        scatter->setLane(lane);
+        emitPairwise(s);
+    }
+
+    scatter->setLane(-1);
+    builder_.CreateBr(mergeBB);
+
+    llvmFct->getBasicBlockList().push_back(mergeBB);
+    builder_.SetInsertPoint(mergeBB);
+}
+
 void StmntCodeGen::visit(ExprStmnt* s)
 {
     s->expr_->accept(tncg_);
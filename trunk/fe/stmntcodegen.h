@@ -7,6 +7,8 @@
 
 #include "fe/stmnt.h"
 
+class GatherAddr;
+
 namespace swift {
 
 //------------------------------------------------------------------------------
@@ -36,6 +38,27 @@ public:
 
 private:
 
+    void emitSimdLoopVariant(SimdLoop* l, llvm::Value* lower, llvm::Value* upper, bool streaming);
+    void emitSimdLoop(SimdLoop* l, llvm::Value* lower, llvm::Value* upper);
+    void emitSimdLoopCopies(SimdLoop* l, llvm::Value* upper, size_t numCopies);
+    void emitParallelSimdLoop(SimdLoop* l, llvm::Value* lower, llvm::Value* upper);
+
+    bool hasFloatReduction(SimdLoop* l);
+    void initReductions(SimdLoop* l);
+    void exitReductions(SimdLoop* l);
+    llvm::Value* emitReductionOp(SimdLoop::Reduction* r, llvm::Value* v1, llvm::Value* v2);
+
+    /// Returns a vector of \p type with the neutral element of \p r in each lane.
+    llvm::Value* createNeutral(SimdLoop::Reduction* r, const llvm::Type* type);
+
+    void emitRuntimeCall(const char* name);
+
+    void emitPairwise(AssignStmnt* s);
+    void emitScatter(AssignStmnt* s, GatherAddr* scatter);
+
+    /// Is \p val defined outside of \p fct?
+    static bool isCaptured(llvm::Value* val, llvm::Function* fct);
+
     LLVMBuilder& builder_;
     llvm::LLVMContext& lctxt_;
     TypeNodeCodeGen* tncg_;
@@ -0,0 +1,133 @@
+#include "fe/timereport.h"
+
+#include <cstdio>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include "utils/assert.h"
+
+namespace swift {
+
+TimeReport::TimeReport(bool enabled)
+    : enabled_(enabled)
+    , wallStart_(0.0)
+    , userStart_(0.0)
+{}
+
+bool TimeReport::enabled() const
+{
+    return enabled_;
+}
+
+void TimeReport::start(const char* phase)
+{
+    if (!enabled_)
+        return;
+
+    Phase p;
+    p.name_ = phase;
+    p.wall_ = 0.0;
+    p.user_ = 0.0;
+    p.peakRSS_ = 0;
+    phases_.push_back(p);
+
+    wallStart_ = wallTime();
+    userStart_ = userTime();
+}
+
+void TimeReport::stop()
+{
+    if (!enabled_)
+        return;
+
+    swiftAssert( !phases_.empty(), "no phase started" );
+    Phase& p = phases_.back();
+
+    p.wall_ = wallTime() - wallStart_;
+    p.user_ = userTime() - userStart_;
+    p.peakRSS_ = peakRSS();
+}
+
+void TimeReport::addCount(const char* name, size_t count)
+{
+    if (enabled_)
+        counts_.push_back( std::make_pair(std::string(name), count) );
+}
+
+void TimeReport::print(std::ostream& out) const
+{
+    double wall = 0.0;
+    double user = 0.0;
+    char buffer[128];
+
+    out << "===-------------------------------------------------------------------------===" << std::endl;
+    out << "                        swift front-end time report" << std::endl;
+    out << "===-------------------------------------------------------------------------===" << std::endl;
+    out << "   wall (s)    user (s)  peak RSS (KiB)  phase" << std::endl;
+
+    for (size_t i = 0; i < phases_.size(); ++i)
+    {
+        const Phase& p = phases_[i];
+        snprintf(buffer, sizeof(buffer), "%11.4f %11.4f %15ld  ", p.wall_, p.user_, p.peakRSS_);
+        out << buffer << p.name_ << std::endl;
+
+        wall += p.wall_;
+        user += p.user_;
+    }
+
+    snprintf(buffer, sizeof(buffer), "%11.4f %11.4f %15ld  ", wall, user, peakRSS());
+    out << buffer << "total" << std::endl << std::endl;
+
+    for (size_t i = 0; i < counts_.size(); ++i)
+        out << "    " << counts_[i].second << " " << counts_[i].first << std::endl;
+
+    out << std::endl;
+}
+
+void TimeReport::printJSON(std::ostream& out) const
+{
+    out << "{\n    \"phases\": [";
+
+    for (size_t i = 0; i < phases_.size(); ++i)
+    {
+        const Phase& p = phases_[i];
+        out << (i ? "," : "") << "\n        {\"name\": \"" << p.name_ 
+            << "\", \"wall_s\": " << p.wall_ 
+            << ", \"user_s\": " << p.user_ 
+            << ", \"peak_rss_kib\": " << p.peakRSS_ << "}";
+    }
+
+    out << "\n    ],\n    \"counts\": {";
+
+    for (size_t i = 0; i < counts_.size(); ++i)
+        out << (i ? ", " : "") << "\"" << counts_[i].first << "\": " << counts_[i].second;
+
+    out << "},\n    \"peak_rss_kib\": " << peakRSS() << "\n}" << std::endl;
+}
+
+double TimeReport::wallTime()
+{
+    struct timeval t;
+    gettimeofday(&t, 0);
+
+    return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+double TimeReport::userTime()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6;
+}
+
+long TimeReport::peakRSS()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_maxrss; // KiB on Linux
+}
+
+} // namespace swift
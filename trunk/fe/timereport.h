@@ -0,0 +1,63 @@
+#ifndef SWIFT_TIMEREPORT_H
+#define SWIFT_TIMEREPORT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils/types.h"
+
+namespace swift {
+
+//------------------------------------------------------------------------------
+
+/**
+ * @brief Collects the wall and user time and the peak RSS of each compiler
+ * phase and arbitrary counters for -time-passes.
+ *
+ * Phases are enclosed by start/stop. Nothing is measured if the report is
+ * disabled.
+ */
+class TimeReport
+{
+public:
+
+    TimeReport(bool enabled);
+
+    bool enabled() const;
+    void start(const char* phase);
+    void stop();
+    void addCount(const char* name, size_t count);
+
+    void print(std::ostream& out) const;
+    void printJSON(std::ostream& out) const;
+
+private:
+
+    static double wallTime();
+    static double userTime();
+    static long peakRSS();
+
+    struct Phase
+    {
+        std::string name_;
+        double wall_; ///< in seconds
+        double user_; ///< in seconds
+        long peakRSS_; ///< in KiB after this phase
+    };
+
+    typedef std::vector<Phase> Phases;
+    typedef std::vector< std::pair<std::string, size_t> > Counts;
+
+    bool enabled_;
+    Phases phases_;
+    Counts counts_;
+    double wallStart_;
+    double userStart_;
+};
+
+//------------------------------------------------------------------------------
+
+} // namespace swift
+
+#endif // SWIFT_TIMEREPORT_H
@@ -32,6 +32,7 @@
 #include "utils/assert.h"
 #include "utils/cast.h"
 #include "utils/llvmhelper.h"
+#include "utils/stringhelper.h"
 
 #include "vec/vectype.h"
 
@@ -98,11 +99,6 @@ const llvm::Type* Type::getVecLLVMType(Module* m, int& simdLength) const
         return llvmType;
 }
 
-MemberFctInfo Type::hasMemberFct(const std::string& id, const TypeList& in, Module* m) const
-{
-    return hasMemberFct(&id, in, m);
-}
-
 //------------------------------------------------------------------------------
 
 ErrorType::ErrorType(bool isSimd /*= false*/)
@@ -172,7 +168,8 @@ BaseType::SizeMap* BaseType::sizeMap_ = 0;
 
 BaseType::BaseType(const Location& loc, TokenType modifier, std::string* id, bool isInOut, bool isSimd /*= false*/)
     : Type(loc, modifier, isInOut, isSimd)
-    , id_(id)
+    , id_( intern(id) )
+    , class_(0)
 {}
 
 BaseType* BaseType::create(
@@ -188,16 +185,14 @@ BaseType* BaseType::create(
 }
 
 BaseType::~BaseType()
-{
-    delete id_;
-}
+{}
 
 bool BaseType::check(const Type* type, Module* m) const
 {
     if ( const BaseType* bt = type->cast<BaseType>() )
     {
-        Class* class1 = m->lookupClass( id() );
-        Class* class2 = m->lookupClass( bt->id() );
+        Class* class1 = lookupClass(m);
+        Class* class2 = bt->lookupClass(m);
 
         // invalid clases and different pointers mean different types
         return class1 && class2 && (class1 == class2);
@@ -213,8 +208,11 @@ std::string BaseType::toString() const
 
 Class* BaseType::lookupClass(Module* m) const
 {
-    Class* c = m->lookupClass(id_);
-    return c;
+    // there is only one module so the class of a type never changes once found
+    if (!class_)
+        class_ = m->lookupClass(id_);
+
+    return class_;
 }
 
 const std::string* BaseType::id() const
@@ -234,6 +232,8 @@ void BaseType::initTypeMap(llvm::LLVMContext* lctxt)
 
     typeMap["bool"]   = llvm::IntegerType::getInt1Ty(*lctxt);
 
+    // saturating types share the representation of their integer types;
+    // TypeNodeCodeGen emits the saturating arithmetic
     typeMap["int8"]   = llvm::IntegerType::getInt8Ty(*lctxt);
     typeMap["uint8"]  = llvm::IntegerType::getInt8Ty(*lctxt);
     typeMap["sat8"]   = llvm::IntegerType::getInt8Ty(*lctxt);
@@ -390,7 +390,9 @@ bool ScalarType::isSigned() const
         || *id() == "int8" 
         || *id() == "int16" 
         || *id() == "int32" 
-        || *id() == "int64";
+        || *id() == "int64"
+        || *id() == "sat8"
+        || *id() == "sat16";
 }
 
 bool ScalarType::isUnsigned() const
@@ -400,7 +402,17 @@ bool ScalarType::isUnsigned() const
         || *id() == "uint16" 
         || *id() == "uint32" 
         || *id() == "uint64" 
-        || *id() == "index";
+        || *id() == "index"
+        || *id() == "usat8"
+        || *id() == "usat16";
+}
+
+bool ScalarType::isSaturating() const
+{
+    return *id() == "sat8" 
+        || *id() == "sat16" 
+        || *id() == "usat8" 
+        || *id() == "usat16";
 }
 
 int ScalarType::sizeOf() const
@@ -431,7 +443,7 @@ bool UserType::perRef() const
 
 bool UserType::validate(Module* m) const
 {
-    if ( m->lookupClass(id()) == 0 )
+    if ( lookupClass(m) == 0 )
     {
         errorf( loc_, "class '%s' is not defined in module '%s'", cid(), m->cid() );
         return false;
@@ -442,7 +454,7 @@ bool UserType::validate(Module* m) const
 
 const llvm::Type* UserType::getRawLLVMType(Module* m, int simdLength /*= 0*/) const
 {
-    Class* c = m->lookupClass( id() );
+    Class* c = lookupClass(m);
     swiftAssert(c, "must be found");
 
     if (simdLength)
@@ -109,8 +109,8 @@ public:
 
     bool isSimd() const { return simd_; }
 
+    /// \p id must be a symbol -- see \a intern.
     virtual MemberFctInfo hasMemberFct(const std::string* id, const TypeList& in, Module* m) const = 0;
-    MemberFctInfo hasMemberFct(const std::string& id, const TypeList& in, Module* m) const;
 
 protected:
 
@@ -180,7 +180,8 @@ protected:
 
 private:
 
-    std::string* id_;
+    const std::string* id_;
+    mutable Class* class_; ///< caches the result of \a lookupClass
 };
 
 //------------------------------------------------------------------------------
@@ -208,6 +209,7 @@ public:
     bool isInteger() const;
     bool isSigned() const;
     bool isUnsigned() const;
+    bool isSaturating() const;
     int sizeOf() const;
 
     static bool isScalar(const std::string* id);
@@ -55,6 +55,39 @@ std::string TypeList::toString() const
     return result;
 }
 
+/*
+ * Two type lists check against each other iff their keys are equal: base types
+ * are identified by their class and there is only one class per name. This
+ * does not hold if an \a ErrorType is involved -- see \a hasError.
+ */
+std::string TypeList::key() const
+{
+    std::string result;
+
+    for (size_t i = 0; i < size(); ++i)
+    {
+        if ( (*this)[i] )
+            result += (*this)[i]->toString();
+        else
+            result += "void";
+
+        result += ',';
+    }
+
+    return result;
+}
+
+bool TypeList::hasError() const
+{
+    for (size_t i = 0; i < size(); ++i)
+    {
+        if ( (*this)[i] && (*this)[i]->cast<ErrorType>() )
+            return true;
+    }
+
+    return false;
+}
+
 bool TypeList::check(Module* m, const TypeList& t) const
 {
     // if the sizes do not match the type lists are obviously different
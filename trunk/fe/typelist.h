@@ -35,8 +35,12 @@ class TypeList : public std::vector<const Type*>
 public:
 
     std::string toString() const;
+    std::string key() const;
     bool check(Module* m, const TypeList& t) const;
 
+    /// Does this list contain an \a ErrorType?
+    bool hasError() const;
+
     TypeList();
     TypeList(size_t size);
     TypeList(const_iterator begin, const_iterator end);
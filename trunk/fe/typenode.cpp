@@ -5,6 +5,7 @@
 #include <llvm/Support/TypeBuilder.h>
 
 #include "utils/llvmplace.h"
+#include "utils/stringhelper.h"
 
 #include "fe/context.h"
 #include "fe/tnlist.h"
@@ -15,9 +16,13 @@ namespace swift {
 
 //------------------------------------------------------------------------------
 
+size_t TypeNode::numCreated_ = 0;
+
 TypeNode::TypeNode(const Location& loc, Type* type /*= 0*/)
     : Node(loc)
 {
+    ++numCreated_;
+
     if (type)
     {
         results_.resize(1);
@@ -39,7 +44,7 @@ TypeNode::~TypeNode()
 
 Decl::Decl(const Location& loc, bool simd, Type* type, std::string* id)
     : TypeNode( loc, simd ? type->simdClone() : type->clone() )
-    , id_(id)
+    , id_( intern(id) )
     , local_(0)
     , alloca_(0)
 {
@@ -49,7 +54,6 @@ Decl::Decl(const Location& loc, bool simd, Type* type, std::string* id)
 Decl::~Decl()
 {
     delete local_;
-    delete id_;
 }
 
 void Decl::accept(TypeNodeVisitorBase* t)
@@ -68,12 +72,23 @@ const char* Decl::cid() const
     return id_->c_str();
 }
 
+Local* Decl::getLocal() const
+{
+    return local_;
+}
+
 //------------------------------------------------------------------------------
 
 Expr::Expr(const Location& loc)
     : TypeNode(loc, 0)
+    , folded_(0)
 {}
 
+Expr::~Expr()
+{
+    delete folded_;
+}
+
 //------------------------------------------------------------------------------
 
 ErrorExpr::ErrorExpr(const Location& loc)
@@ -107,13 +122,11 @@ void Broadcast::accept(TypeNodeVisitorBase* t)
 
 Id::Id(const Location& loc, std::string* id)
     : Expr(loc)
-    , id_(id)
+    , id_( intern(id) )
 {}
 
 Id::~Id()
-{
-    delete id_;
-}
+{}
 
 void Id::accept(TypeNodeVisitorBase* t)
 {
@@ -144,6 +157,11 @@ Access::~Access()
     delete prefixExpr_;
 }
 
+Expr* Access::getPrefixExpr() const
+{
+    return prefixExpr_;
+}
+
 //------------------------------------------------------------------------------
 
 IndexExpr::IndexExpr(const Location& loc, Expr* prefixExpr, Expr* indexExpr)
@@ -165,6 +183,8 @@ void IndexExpr::accept(TypeNodeVisitorBase* t)
 
 SimdIndexExpr::SimdIndexExpr(const Location& loc, Expr* prefixExpr)
     : Access(loc, prefixExpr)
+    , stream_(false)
+    , register_(false)
 {}
 
 void SimdIndexExpr::accept(TypeNodeVisitorBase* t)
@@ -172,17 +192,25 @@ void SimdIndexExpr::accept(TypeNodeVisitorBase* t)
     t->visit(this);
 }
 
+void SimdIndexExpr::setStream(bool stream)
+{
+    stream_ = stream;
+}
+
+void SimdIndexExpr::setRegister(bool reg)
+{
+    register_ = reg;
+}
+
 //------------------------------------------------------------------------------
 
 MemberAccess::MemberAccess(const Location& loc, Expr* prefixExpr, std::string* id)
     : Access(loc, prefixExpr)
-    , id_(id)
+    , id_( intern(id) )
 {}
 
 MemberAccess::~MemberAccess()
-{
-    delete id_;
-}
+{}
 
 void MemberAccess::accept(TypeNodeVisitorBase* t)
 {
@@ -203,14 +231,13 @@ const char* MemberAccess::cid() const
 
 FctCall::FctCall(const Location& loc, std::string* id, TNList* exprList)
     : Expr(loc)
-    , id_(id)
+    , id_( intern(id) )
     , exprList_(exprList)
 {}
 
 FctCall::~FctCall()
 {
     delete exprList_;
-    delete id_;
 }
 
 const std::string* FctCall::id() const
@@ -223,12 +250,18 @@ const char* FctCall::cid() const
     return id_->c_str();
 }
 
+TNList* FctCall::getExprList() const
+{
+    return exprList_;
+}
+
 //------------------------------------------------------------------------------
 
 CCall::CCall(const Location& loc, Type* retType, TokenType token, std::string* id, TNList* exprList)
     : FctCall(loc, id, exprList)
     , retType_(retType)
     , token_(token)
+    , mathFct_(0)
 {}
 
 CCall::~CCall()
@@ -273,13 +306,11 @@ StaticMethodCall::StaticMethodCall(const Location& loc, std::string* id, TNList*
 
 CreateCall::CreateCall(const Location& loc, std::string* classId, TNList* exprList)
     : StaticMethodCall( loc, new std::string("create"), exprList )
-    , classId_(classId)
+    , classId_( intern(classId) )
 {}
 
 CreateCall::~CreateCall()
-{
-    delete classId_;
-}
+{}
 
 void CreateCall::accept(TypeNodeVisitorBase* t)
 {
@@ -296,13 +327,11 @@ const char* CreateCall::qualifierStr() const
 
 RoutineCall::RoutineCall(const Location& loc, std::string* classId, std::string* id, TNList* exprList)
     : StaticMethodCall(loc, id, exprList)
-    , classId_(classId)
+    , classId_( intern(classId) )
 {}
 
 RoutineCall::~RoutineCall()
-{
-    delete classId_;
-}
+{}
 
 void RoutineCall::accept(TypeNodeVisitorBase* t)
 {
@@ -325,6 +354,11 @@ OperatorCall::OperatorCall(const Location& loc, std::string* id, Expr* op1)
     //exprList_->append(op1);
 }
 
+Expr* OperatorCall::getOp1() const
+{
+    return op1_;
+}
+
 //------------------------------------------------------------------------------
 
 BinExpr::BinExpr(const Location& loc, std::string* id, Expr* op1, Expr* op2)
@@ -345,6 +379,11 @@ const char* BinExpr::qualifierStr() const
     return str;
 }
 
+Expr* BinExpr::getOp2() const
+{
+    return op2_;
+}
+
 //------------------------------------------------------------------------------
 
 UnExpr::UnExpr(const Location& loc, std::string* id, Expr* op)
@@ -385,6 +424,11 @@ const char* MethodCall::qualifierStr() const
     return str;
 }
 
+Expr* MethodCall::getExpr() const
+{
+    return expr_;
+}
+
 //------------------------------------------------------------------------------
 
 Literal::Literal(const Location& loc, Box box, TokenType token)
@@ -403,6 +447,11 @@ TokenType Literal::getToken() const
     return token_;
 }
 
+const Box& Literal::getBox() const
+{
+    return box_;
+}
+
 //------------------------------------------------------------------------------
 
 Nil::Nil(const Location& loc, Type* type)
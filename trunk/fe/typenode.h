@@ -19,6 +19,7 @@ namespace llvm {
 
 namespace swift {
 
+class Literal;
 class Local;
 class MemberVar;
 class TNList;
@@ -51,6 +52,8 @@ public:
     const TNResult& get(size_t i = 0) const { return results_[i]; }
     size_t numResults() const { return results_.size(); }
 
+    static size_t numCreated_; ///< number of type nodes created so far
+
 protected:
 
     TNResult& set(size_t i = 0) { return results_[i]; }
@@ -74,10 +77,11 @@ public:
     virtual void accept(TypeNodeVisitorBase* t);
     const std::string* id() const;
     const char* cid() const;
+    Local* getLocal() const;
 
 protected:
 
-    std::string* id_;
+    const std::string* id_;
     Local* local_;
     llvm::AllocaInst* alloca_;
 
@@ -91,9 +95,12 @@ class Expr : public TypeNode
 public:
 
     Expr(const Location& loc);
+    virtual ~Expr();
 
 protected:
 
+    Literal* folded_; ///< compile time result of builtin operations on literals
+
     template<class T> friend class TypeNodeVisitor;
 };
 
@@ -121,6 +128,8 @@ public:
     Access(const Location& loc, Expr* prefixExpr);
     virtual ~Access();
 
+    Expr* getPrefixExpr() const;
+
 protected:
 
     Expr* prefixExpr_;
@@ -157,9 +166,17 @@ public:
     SimdIndexExpr(const Location& loc, Expr* prefixExpr);
 
     virtual void accept(TypeNodeVisitorBase* t);
+    void setStream(bool stream);
+    void setRegister(bool reg);
 
 protected:
 
+    /// Write-only within its simd loop -> may be stored non-temporally.
+    bool stream_;
+
+    /// The container has been replaced by a value per iteration.
+    bool register_;
+
     template<class T> friend class TypeNodeVisitor;
 };
 
@@ -179,7 +196,7 @@ public:
 
 protected:
 
-    std::string* id_;
+    const std::string* id_;
     MemberVar* memberVar_;
 
     template<class T> friend class TypeNodeVisitor;
@@ -197,10 +214,11 @@ public:
     virtual const char* qualifierStr() const = 0;
     const std::string* id() const;
     const char* cid() const;
+    TNList* getExprList() const;
 
 protected:
 
-    std::string* id_;
+    const std::string* id_;
 
     TNList* exprList_;
 
@@ -224,6 +242,9 @@ protected:
     Type* retType_;
     TokenType token_;
 
+    /// The math library routine used instead if called with simd values.
+    MemberFct* mathFct_;
+
     template<class T> friend class TypeNodeVisitor;
 };
 
@@ -259,6 +280,7 @@ public:
 
     virtual void accept(TypeNodeVisitorBase* t);
     virtual const char* qualifierStr() const;
+    Expr* getExpr() const;
 
 protected:
 
@@ -275,6 +297,8 @@ public:
 
     OperatorCall(const Location& loc, std::string* id, Expr* op1);
 
+    Expr* getOp1() const;
+
 protected:
 
     Expr* op1_;
@@ -293,6 +317,7 @@ public:
 
     virtual void accept(TypeNodeVisitorBase* t);
     virtual const char* qualifierStr() const;
+    Expr* getOp2() const;
 
 protected:
 
@@ -336,7 +361,7 @@ public:
 
 protected:
 
-    std::string* classId_;
+    const std::string* classId_;
 
     template<class T> friend class TypeNodeVisitor;
 };
@@ -355,7 +380,7 @@ public:
 
 protected:
 
-    std::string* classId_;
+    const std::string* classId_;
 
     template<class T> friend class TypeNodeVisitor;
 };
@@ -370,6 +395,7 @@ public:
 
     virtual void accept(TypeNodeVisitorBase* t);
     TokenType getToken() const;
+    const Box& getBox() const;
 
     static void initTypeMap(llvm::LLVMContext* lctxt);
     static void destroyTypeMap();
@@ -416,7 +442,7 @@ public:
 
 protected:
 
-    std::string* id_;
+    const std::string* id_;
     Var* var_;
 
     template<class T> friend class TypeNodeVisitor;
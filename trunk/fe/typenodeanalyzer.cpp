@@ -1,12 +1,15 @@
 #include "fe/typenodeanalyzer.h"
 
 #include "utils/cast.h"
+#include "utils/stringhelper.h"
 
 #include "fe/class.h"
+#include "fe/constfold.h"
 #include "fe/context.h"
 #include "fe/tnlist.h"
 #include "fe/error.h"
 #include "fe/scope.h"
+#include "fe/stmnt.h"
 #include "fe/type.h"
 
 #define SWIFT_ERROR_ONLY_WITHIN_SIMD_LOOPS(loc) errorf((loc), "a simd index may only be used within simd loops");
@@ -134,6 +137,11 @@ void TypeNodeAnalyzer::visit(Id* id)
         return;
     }
 
+    ++ctxt_->varUses_[var];
+
+    if (ctxt_->currentSimdLoop_)
+        ctxt_->currentSimdLoop_->addUse(var);
+
     // this expresion is valid
     setResult(id, var->getType()->clone(), true);
 }
@@ -260,7 +268,34 @@ void TypeNodeAnalyzer::visit(IndexExpr* i)
 
     const Type* prefixType = i->prefixExpr_->get().type_->derefPtr();
     if ( const Container* container = prefixType->derefPtr()->cast<Container>() )
-        setResult(i, container->getInnerType()->clone(), true);
+    {
+        const Type* inner = container->getInnerType();
+
+        // a simd index gathers one element per lane
+        if ( indexType->isSimd() )
+        {
+            if (!ctxt_->simdIndex_)
+            {
+                SWIFT_ERROR_ONLY_WITHIN_SIMD_LOOPS( i->loc() );
+                setError(i, true);
+                return;
+            }
+
+            if ( !inner->cast<ScalarType>() )
+            {
+                errorf( i->loc(), 
+                        "only containers of base types may be indexed "
+                        "with a simd index but type '%s' is given", 
+                        prefixType->toString().c_str() );
+                setError(i, true);
+                return;
+            }
+
+            setResult(i, inner->simdClone(), true);
+        }
+        else
+            setResult(i, inner->clone(), true);
+    }
     else
     {
         errorf( i->loc(), 
@@ -292,7 +327,46 @@ void TypeNodeAnalyzer::visit(SimdIndexExpr* s)
 
     const Type* prefixType = s->prefixExpr_->get().type_->derefPtr();
     if ( const Container* container = prefixType->derefPtr()->cast<Container>() )
+    {
+        const Type* inner = container->getInnerType();
+        const ScalarType* scalar = inner->cast<ScalarType>();
+
+        /*
+         * a@ has SimdLoop::SIMD_STEP lanes -- elements of other types only
+         * work if they lie consecutively in memory
+         */
+
+        if ( container->cast<Simd>() && (!scalar || scalar->isBool()) )
+        {
+            int simdLength = 0;
+
+            if (scalar)
+                inner->getVecLLVMType(ctxt_->module_, simdLength);
+            else if ( const UserType* user = inner->cast<UserType>() )
+            {
+                if ( Class* c = user->lookupClass(ctxt_->module_) )
+                    simdLength = c->getSimdLength();
+            }
+
+            if ( simdLength > 0 && simdLength != SimdLoop::SIMD_STEP )
+            {
+                errorf( s->loc(), "simd loops over a simd container of type '%s' "
+                        "are not supported yet -- it has %i instead of %i lanes",
+                        inner->toString().c_str(), simdLength, int(SimdLoop::SIMD_STEP) );
+                setError(s, true);
+                return;
+            }
+        }
+
+        if ( Id* id = dynamic<Id>(s->prefixExpr_) )
+        {
+            ctxt_->currentSimdLoop_->addSimdAccess( ctxt_->scope()->lookupVar( id->id() ), s );
+        }
+        else
+            ctxt_->currentSimdLoop_->setSideEffects(); // the container cannot be tracked
+
         setResult(s, container->getInnerType()->simdClone(), true);
+    }
     else
     {
         errorf( s->loc(), 
@@ -358,6 +432,10 @@ void TypeNodeAnalyzer::visit(CCall* c)
 
     if (ctxt_->simdIndex_)
     {
+        // use the vector version of the math library if available
+        if ( lookupMathFct(c) )
+            return;
+
         bool error = false;
 
         for (size_t i = 0; i < args.numResults(); ++i)
@@ -377,6 +455,8 @@ void TypeNodeAnalyzer::visit(CCall* c)
         }
     }
 
+    markSideEffects();
+
     if ( c->retType_ )
     {
         if ( !c->retType_->validate(ctxt_->module_) )
@@ -388,10 +468,108 @@ void TypeNodeAnalyzer::visit(CCall* c)
         c->results_.clear();
 }
 
+bool TypeNodeAnalyzer::lookupMathFct(CCall* c)
+{
+    // C math functions which have a vector version in lib/math.swift
+    static const char* cMathFcts[][2] = {
+        {"sqrtf",  "sqrt"},  {"sqrt",  "sqrt"},
+        {"expf",   "exp"},   {"exp",   "exp"},
+        {"logf",   "log"},   {"log",   "log"},
+        {"powf",   "pow"},   {"pow",   "pow"},
+        {"sinf",   "sin"},   {"sin",   "sin"},
+        {"cosf",   "cos"},   {"cos",   "cos"},
+        {"atanf",  "atan"},  {"atan",  "atan"},
+        {"atan2f", "atan2"}, {"atan2", "atan2"}
+    };
+
+    const TNList& args = *c->exprList_;
+
+    if ( !c->retType_ || args.numResults() == 0 )
+        return false;
+
+    for (size_t i = 0; i < args.numResults(); ++i)
+    {
+        if ( !args.getResult(i).type_->isSimd() )
+            return false;
+    }
+
+    const std::string* id = 0;
+    for (size_t i = 0; i < sizeof(cMathFcts) / sizeof(cMathFcts[0]); ++i)
+    {
+        if ( *c->id() == cMathFcts[i][0] )
+            id = intern(cMathFcts[i][1]);
+    }
+
+    if (!id)
+        return false;
+
+    Class* math = ctxt_->module_->lookupClass( intern("math") );
+
+    if (!math)
+        return false;
+
+    MemberFct* m = math->lookupMemberFct( ctxt_->module_, id, args.typeList() );
+
+    if ( !m || !m->isSimd() || !m->isStatic() || m->sig_.outTypes_.size() != 1 )
+        return false;
+
+    // the declared return type must fit
+    if ( !c->retType_->validate(ctxt_->module_) 
+            || !c->retType_->check(m->sig_.outTypes_[0], ctxt_->module_) )
+    {
+        return false;
+    }
+
+    c->mathFct_ = m;
+    setResult( c, m->sig_.outTypes_[0]->simdClone(), false );
+
+    return true;
+}
+
+/*
+ * Calls which cannot be tracked are noted as they must not be reordered. They
+ * also make the current member function impure. The vector math routines and
+ * the builtin methods of scalars are no calls in this sense.
+ */
+void TypeNodeAnalyzer::markSideEffects()
+{
+    if (ctxt_->currentSimdLoop_)
+        ctxt_->currentSimdLoop_->setSideEffects();
+
+    if (ctxt_->memberFct_)
+        ctxt_->memberFct_->setSideEffects();
+}
+
+/*
+ * Calls of member functions are noted with their callee. Whether they have
+ * side effects is decided later on by MemberFct::isPure as the callee's body
+ * may not have been analyzed yet.
+ */
+void TypeNodeAnalyzer::markCall(MemberFctCall* m)
+{
+    if (!m->memberFct_)
+    {
+        markSideEffects();
+        return;
+    }
+
+    if (ctxt_->currentSimdLoop_)
+        ctxt_->currentSimdLoop_->addCall(m->memberFct_);
+
+    if (ctxt_->memberFct_)
+        ctxt_->memberFct_->addCallee(m->memberFct_);
+}
+
 void TypeNodeAnalyzer::visit(MethodCall* m)
 {
     if ( setClass(m) )
+    {
         analyzeMemberFctCall(m);
+        fold(m);
+    }
+
+    if ( m->expr_->numResults() != 1 || !m->expr_->get().type_->cast<ScalarType>() )
+        markCall(m);
 }
 
 void TypeNodeAnalyzer::visit(CreateCall* c)
@@ -406,24 +584,38 @@ void TypeNodeAnalyzer::visit(RoutineCall* r)
 {
     if ( setClass(r) )
         analyzeMemberFctCall(r);
+
+    markCall(r);
 }
 
 void TypeNodeAnalyzer::visit(UnExpr* u)
 {
     if ( setClass(u) )
+    {
         analyzeMemberFctCall(u);
+        fold(u);
+    }
 
     if ( !u->op1_->get().type_->cast<ScalarType>() )
+    {
         u->builtin_ = false;
+        markCall(u);
+    }
 }
 
 void TypeNodeAnalyzer::visit(BinExpr* b)
 {
     if ( setClass(b) )
+    {
         analyzeMemberFctCall(b);
+        fold(b);
+    }
 
     if ( !b->op1_->get().type_->cast<ScalarType>() )
+    {
         b->builtin_ = false;
+        markCall(b);
+    }
 }
 
 bool TypeNodeAnalyzer::setClass(MethodCall* m)
@@ -558,6 +750,74 @@ void TypeNodeAnalyzer::analyzeMemberFctCall(MemberFctCall* m)
     }
 }
 
+/*
+ * Builtin operations on scalars whose operands are literals -- or have been
+ * folded themselves -- are evaluated at compile time. The result is attached
+ * as literal to the expression and emitted in place of the operation.
+ */
+void TypeNodeAnalyzer::fold(MethodCall* m)
+{
+    if ( !m->memberFct_ || m->simd_ || m->numResults() != 1 )
+        return;
+
+    const ScalarType* from = m->expr_->get().type_->cast<ScalarType>();
+    const ScalarType* to = m->get().type_->cast<ScalarType>();
+
+    if (!from || !to)
+        return;
+
+    Box val, arg, result;
+
+    if ( !getConstant(m->expr_, val) )
+        return;
+
+    bool folded;
+
+    if ( BinExpr* b = dynamic<BinExpr>(m) )
+        folded = getConstant(b->op2_, arg) && foldBinOp(*b->id(), from, val, arg, result);
+    else if ( dynamic<UnExpr>(m) )
+        folded = foldUnOp(*m->id(), from, val, result);
+    else
+    {
+        size_t numArgs = m->exprList_->numTypeNodes();
+
+        if (numArgs > 1)
+            return;
+
+        if (numArgs == 1)
+        {
+            Expr* e = dynamic<Expr>( m->exprList_->getTypeNode(0) );
+            if ( !e || !getConstant(e, arg) )
+                return;
+        }
+
+        folded = foldMethod(*m->id(), from, to, val, arg, result);
+    }
+
+    if (!folded)
+        return;
+
+    m->folded_ = new Literal( m->loc(), result, scalar2LiteralToken(to) );
+    m->folded_->accept(this);
+}
+
+bool TypeNodeAnalyzer::getConstant(Expr* e, Box& box)
+{
+    if ( Literal* l = dynamic<Literal>(e) )
+    {
+        box = l->box_;
+        return true;
+    }
+
+    if (e->folded_)
+    {
+        box = e->folded_->box_;
+        return true;
+    }
+
+    return false;
+}
+
 void TypeNodeAnalyzer::setResult(TypeNode* tn, Type* type, bool lvalue)
 {
     tn->results_.resize(1);
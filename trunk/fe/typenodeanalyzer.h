@@ -42,8 +42,13 @@ public:
 private:
 
     void analyzeMemberFctCall(MemberFctCall* m);
+    bool lookupMathFct(CCall* c);
+    void markSideEffects();
+    void markCall(MemberFctCall* m);
     bool setClass(MethodCall* m);
     bool setClass(RoutineCall* r);
+    void fold(MethodCall* m);
+    bool getConstant(Expr* e, Box& box);
 
     void setResult(TypeNode* tn, Type* type, bool lvalue);
     void setError(TypeNode* tn, bool lvalue);
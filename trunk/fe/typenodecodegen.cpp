@@ -1,7 +1,10 @@
 #include "fe/typenodecodegen.h"
 
+#include <algorithm>
 #include <sstream>
 
+#include <llvm/Constants.h>
+#include <llvm/DerivedTypes.h>
 #include <llvm/Intrinsics.h>
 #include <llvm/LLVMContext.h>
 #include <llvm/Module.h>
@@ -10,9 +13,12 @@
 #include "utils/cast.h"
 #include "utils/llvmhelper.h"
 
+#include "vec/vectype.h"
+
 #include "fe/context.h"
 #include "fe/class.h"
 #include "fe/scope.h"
+#include "fe/stmnt.h"
 #include "fe/tnlist.h"
 #include "fe/type.h"
 #include "fe/var.h"
@@ -177,6 +183,13 @@ void TypeNodeCodeGen::visit(IndexExpr* i)
             Container::POINTER, addr->getNameStr() + ".ptr" );
 
     const Type* prefixType = i->prefixExpr_->get().type_;
+
+    if ( i->indexExpr_->get().type_->isSimd() )
+    {
+        emitGather(i, ptr, idx);
+        return;
+    }
+
     if ( dynamic<Array>(prefixType) )
         setResult( i, new Addr(builder_.CreateInBoundsGEP(ptr, idx)) );
     else
@@ -198,30 +211,116 @@ void TypeNodeCodeGen::visit(IndexExpr* i)
     }
 }
 
+/*
+ * The elements of an array{T} as well as of a simd{T} with a base type T lie
+ * consecutively in memory. Consecutive indices are loaded and stored as one
+ * vector -- all others are gathered and scattered lane by lane.
+ */
+void TypeNodeCodeGen::emitGather(IndexExpr* i, Value* ptr, Value* idxVec)
+{
+    const Container* container = cast<Container>( i->prefixExpr_->get().type_->derefPtr() );
+    const Type* inner = container->getInnerType();
+    const llvm::Type* elemType = inner->getLLVMType(ctxt_->module_);
+    const llvm::VectorType* idxType = cast<llvm::VectorType>( idxVec->getType() );
+    const llvm::Type* vecType = llvm::VectorType::get( elemType, idxType->getNumElements() );
+
+    Value* elemPtr = builder_.CreateBitCast( ptr, llvm::PointerType::getUnqual(elemType) );
+
+    if ( Value* base = simdConsecutiveBase(idxVec, builder_) )
+    {
+        Value* first = builder_.CreateInBoundsGEP(elemPtr, base);
+        setResult( i, new VecAddr(first, vecType, builder_) );
+        return;
+    }
+
+    Values lanePtrs;
+    for (unsigned lane = 0; lane < idxType->getNumElements(); ++lane)
+    {
+        Value* idx = builder_.CreateExtractElement( idxVec, createInt32(lctxt_, lane) );
+        lanePtrs.push_back( builder_.CreateInBoundsGEP(elemPtr, idx) );
+    }
+
+    setResult( i, new GatherAddr(lanePtrs, vecType, builder_) );
+}
+
+/*
+ * Prefetches the element which is prefetchDistance_ simd steps ahead of
+ * index. Each simd step covers numElems elements of ptr. Prefetching past the
+ * end is harmless.
+ */
+void TypeNodeCodeGen::emitPrefetch(Value* ptr, Value* index, uint64_t numElems)
+{
+    if (ctxt_->prefetchDistance_ == 0)
+        return;
+
+    Value* ahead = builder_.CreateAdd( index, 
+            createInt64(lctxt_, ctxt_->prefetchDistance_ * numElems) );
+    createPrefetch( builder_.CreateGEP(ptr, ahead), builder_ );
+}
+
 void TypeNodeCodeGen::visit(SimdIndexExpr* s)
 {
     swiftAssert(ctxt_->simdIndex_, "can only be valid within simd loops");
 
+    if (s->register_)
+    {
+        // the container has been elided by the SimdLoopFuser
+        Var* var = ctxt_->scope()->lookupVar( cast<Id>(s->prefixExpr_)->id() );
+        setResult( s, new Addr(var->getAddr(builder_)) );
+        return;
+    }
+
     Value* addr = resolvePrefixExpr(s);
     Value* ptr = createLoadInBoundsGEP_0_i32( lctxt_, builder_, addr, 
             Container::POINTER, addr->getNameStr() + ".ptr" );
     const Type* prefixType = s->prefixExpr_->get().type_;
+    const Type* inner = cast<Container>(prefixType)->getInnerType();
 
+    /*
+     * a@ always has SimdLoop::SIMD_STEP lanes -- the vectors of a simd{T} are
+     * used directly only if they have as many lanes
+     */
+
+    int simdLength = 0;
     if ( dynamic<Simd>(prefixType) )
+        inner->getVecLLVMType(ctxt_->module_, simdLength);
+
+    if (simdLength == SimdLoop::SIMD_STEP)
     {
         Value* index = builder_.CreateUDiv( 
                 builder_.CreateLoad(ctxt_->simdIndex_),
-                createInt64(lctxt_, 4) ); // HACK
-        setResult( s, new Addr(builder_.CreateInBoundsGEP(ptr, index)) );
+                createInt64(lctxt_, SimdLoop::SIMD_STEP) );
+        Value* elemPtr = builder_.CreateInBoundsGEP(ptr, index);
+
+        if (ctxt_->streaming_)
+        {
+            if (s->stream_)
+            {
+                setResult( s, new StreamAddr(elemPtr, builder_) );
+                return;
+            }
+
+            emitPrefetch(ptr, index, 1);
+        }
+
+        setResult( s, new Addr(elemPtr) );
         //Value* val = createInt64(lctxt_, 7);
         //setResult( s, new Addr( abuilder_.CreateInBoundsGEP(ptr, val)) );
         return;
     }
     else
     {
-        swiftAssert( dynamic<Array>(prefixType), "must be an array" );
-        //setResult( i, new ScalarAddr(builder_.CreateInBoundsGEP(ptr, ctxt_->simdIndex_)) );
-        swiftAssert(false, "TODO");
+        // a@ refers to SimdLoop::SIMD_STEP consecutive elements
+        const llvm::Type* elemType = inner->getLLVMType(ctxt_->module_);
+        ptr = builder_.CreateBitCast( ptr, llvm::PointerType::getUnqual(elemType) );
+        Value* index = builder_.CreateLoad(ctxt_->simdIndex_);
+        Value* first = builder_.CreateInBoundsGEP(ptr, index);
+
+        if (ctxt_->streaming_)
+            emitPrefetch(ptr, index, SimdLoop::SIMD_STEP);
+
+        setResult( s, new VecAddr(first, 
+                    inner->getLLVMType(ctxt_->module_, SimdLoop::SIMD_STEP), builder_) );
         return;
     }
 }
@@ -245,6 +344,21 @@ void TypeNodeCodeGen::visit(CCall* c)
     args.accept(this);
     const TypeList& inTypes = args.typeList();
 
+    // call the vector version of the math library instead
+    if (c->mathFct_)
+    {
+        Values values;
+        args.getArgs(builder_, values);
+
+        llvm::CallInst* call = llvm::CallInst::Create( 
+                c->mathFct_->simdFct_, values.begin(), values.end() );
+        call->setCallingConv(llvm::CallingConv::Fast);
+        Value* retVal = builder_.Insert(call);
+
+        setResult( c, new Scalar(builder_.CreateExtractValue(retVal, 0)) );
+        return;
+    }
+
     /*
      * build function type
      */
@@ -286,6 +400,9 @@ void TypeNodeCodeGen::visit(CCall* c)
 
 void TypeNodeCodeGen::visit(MethodCall* m)
 {
+    if ( emitFolded(m) )
+        return;
+
     Place* _this = getThis(m);
 
     if ( const ScalarType* from = m->expr_->get().type_->cast<ScalarType>() )
@@ -297,6 +414,27 @@ void TypeNodeCodeGen::visit(MethodCall* m)
 
         if ( m->id()->find("bitcast") != std::string::npos )
             val = builder_.CreateBitCast(val, llvmTo);
+        else if ( *m->id() == "sqrt" )
+        {
+            // works for scalars and vectors alike
+            const llvm::Type* llvmTypes[1];
+            llvmTypes[0] = val->getType();
+            llvm::Function* sqrtFct = llvm::Intrinsic::getDeclaration(
+                    ctxt_->lmodule(), llvm::Intrinsic::sqrt, llvmTypes, 1);
+
+            val = builder_.CreateCall(sqrtFct, val);
+        }
+        else if ( *m->id() == "min" || *m->id() == "max" )
+        {
+            m->exprList_->accept(this);
+            Value* arg = m->exprList_->getArg(builder_, 0);
+            val = emitMinMax( from, val, arg, *m->id() == "max" );
+        }
+        else if ( from->isInteger() && to->isSaturating() )
+        {
+            // same-width casts which change the signedness must clamp, too
+            val = emitClamp( to, val, from->isSigned() );
+        }
         else // -> assumes that r is a normal cast
         {
             if ( llvmTo == llvmFrom )
@@ -358,16 +496,35 @@ void TypeNodeCodeGen::visit(RoutineCall* r)
 
 void TypeNodeCodeGen::visit(UnExpr* u)
 {
+    if ( emitFolded(u) )
+        return;
+
     u->op1_->accept(this);
 
     if ( u->builtin_ )
     {
         Value* val = u->op1_->get().place_->getScalar(builder_);
 
+        // a loaded vectorized bool is a mask
+        if ( cast<ScalarType>(u->op1_->get().type_)->isBool() && dynamic<llvm::VectorType>(val->getType()) )
+            val = vec::toPredicate(builder_, val);
+
         switch ( (*u->id_)[0] )
         {
             case '+': break; // nothing to do
-            case '-': val = builder_.CreateNeg(val); break;
+            case '-': 
+            {
+                const ScalarType* scalar = cast<ScalarType>( u->op1_->get().type_ );
+
+                if ( scalar->isSaturating() )
+                {
+                    Value* zero = llvm::Constant::getNullValue( val->getType() );
+                    val = emitSaturated('-', scalar, zero, val);
+                }
+                else
+                    val = builder_.CreateNeg(val); 
+                break;
+            }
             case '!': val = builder_.CreateNot(val); break;
             case '~': val = builder_.CreateNot(val); break;
             default:         swiftAssert(false, "TODO");
@@ -388,6 +545,9 @@ static inline int tok2val(const char* str)
 
 void TypeNodeCodeGen::visit(BinExpr* b)
 {
+    if ( emitFolded(b) )
+        return;
+
     // accept this value in all cases
     b->op1_->accept(this);
 
@@ -400,12 +560,27 @@ void TypeNodeCodeGen::visit(BinExpr* b)
 
         const ScalarType* scalar = cast<ScalarType>( b->op1_->get().type_ );
 
+        // loaded vectorized bools are masks -- calculate with predicates
+        if ( scalar->isBool() && dynamic<llvm::VectorType>(v1->getType()) )
+        {
+            v1 = vec::toPredicate(builder_, v1);
+            v2 = vec::toPredicate(builder_, v2);
+        }
+
         Value* val;
 
         // calc unique value
-        std::string& id = *b->id_;
+        const std::string& id = *b->id_;
         int token = id[0] + ((id.size() > 1) ? id[1] * 0x100 : 0 );
 
+        // saturating arithmetic
+        if ( scalar->isSaturating() 
+                && (token == '+' || token == '-' || token == '*' || token == '/') )
+        {
+            setResult( b, new Scalar(emitSaturated(token, scalar, v1, v2)) );
+            return;
+        }
+
         switch (token)
         {
             /*
@@ -451,8 +626,9 @@ void TypeNodeCodeGen::visit(BinExpr* b)
             {
                 using namespace llvm::Intrinsic;
 
+                // v1 may also be a vector in simd mode
                 const llvm::Type* llvmTypes[1];
-                llvmTypes[0] = scalar->getLLVMType(ctxt_->module_);
+                llvmTypes[0] = v1->getType();
                 llvm::Function* powFct = getDeclaration(
                         ctxt_->lmodule(), llvm::Intrinsic::pow, llvmTypes, 1);
 
@@ -511,6 +687,18 @@ void TypeNodeCodeGen::visit(BinExpr* b)
         emitCall(b, b->op1_->set().place_);
 }
 
+bool TypeNodeCodeGen::emitFolded(Expr* e)
+{
+    if (!e->folded_)
+        return false;
+
+    // the operands are literals -- nothing to evaluate
+    e->folded_->accept(this);
+    setResult( e, new Scalar(e->folded_->get().place_->getScalar(builder_)) );
+
+    return true;
+}
+
 Place* TypeNodeCodeGen::getThis(MethodCall* m)
 {
     swiftAssert(m->expr_->numResults() == 1, "must exactly have one result" );
@@ -546,6 +734,7 @@ void TypeNodeCodeGen::emitCall(MemberFctCall* call, Place* _this)
         args.push_back( _this->getAddr(builder_) );
 
     Values perRefRetValues;
+    size_t idxRetByValue = 0;
 
     // append return-value arguments
     for (size_t i = 0; i < out.size(); ++i)
@@ -554,6 +743,10 @@ void TypeNodeCodeGen::emitCall(MemberFctCall* call, Place* _this)
 
         if ( type->perRef() )
         {
+            // returned in vector registers?
+            if ( call->simd_ && fct->simdRetByValue_[idxRetByValue++] )
+                continue;
+
             int simdLength = call->simd_ ? 4 : 0; // HACK
             const llvm::Type* llvmType = type->getRawLLVMType(ctxt_->module_, simdLength);
 
@@ -578,6 +771,9 @@ void TypeNodeCodeGen::emitCall(MemberFctCall* call, Place* _this)
     llvm::Function* llvmFct = call->simd_ ? fct->simdFct_ : fct->llvmFct_;
     swiftAssert(llvmFct, "must exist");
 
+    if (call->simd_)
+        fct->prepareSimdArgs(builder_, args);
+
     // create actual call
     llvm::CallInst* callInst = llvm::CallInst::Create( 
             llvmFct, args.begin(), args.end() );
@@ -592,14 +788,207 @@ void TypeNodeCodeGen::emitCall(MemberFctCall* call, Place* _this)
 
     size_t idxRetType = 0;
     size_t idxPerRef = 0;
+    idxRetByValue = 0;
     for (size_t i = 0; i < out.size(); ++i)
     {
-        call->set(i).place_ = out[i]->perRef() 
-            ? (Place*) new Addr( perRefRetValues[idxPerRef++] )
-            : (Place*) new Scalar( builder_.CreateExtractValue(retValue, idxRetType++) );
+        if ( out[i]->perRef() && call->simd_ && fct->simdRetByValue_[idxRetByValue++] )
+        {
+            Value* val = builder_.CreateExtractValue(retValue, idxRetType++);
+
+            // the aggregate only goes to memory if a place is waiting for it
+            if ( call->initPlaces_ && (*call->initPlaces_)[i] )
+            {
+                Value* addr = (*call->initPlaces_)[i]->getAddr(builder_);
+                builder_.CreateStore(val, addr);
+                call->set(i).place_ = new Addr(addr);
+            }
+            else
+                call->set(i).place_ = new Scalar(val);
+
+            continue;
+        }
+
+        if ( out[i]->perRef() )
+            call->set(i).place_ = new Addr( perRefRetValues[idxPerRef++] );
+        else
+        {
+            Value* val = builder_.CreateExtractValue(retValue, idxRetType++);
+
+            // bools come back as masks
+            if ( call->simd_ && out[i]->isBool() )
+                val = vec::toPredicate(builder_, val);
+
+            call->set(i).place_ = new Scalar(val);
+        }
     }
 }
 
+Value* TypeNodeCodeGen::emitSaturated(int token, const ScalarType* scalar, Value* v1, Value* v2)
+{
+    const llvm::VectorType* vecType = dynamic<llvm::VectorType>( v1->getType() );
+    bool isSigned = scalar->isSigned();
+
+    /*
+     * 16 x i8 and 8 x i16 additions and subtractions directly map to the
+     * saturating SSE2 instructions padds, paddus, psubs and psubus
+     */
+
+    if ( vecType && vecType->getBitWidth() == 128 && (token == '+' || token == '-') )
+    {
+        using namespace llvm::Intrinsic;
+        bool isByte = scalar->sizeOf() == 1;
+        llvm::Intrinsic::ID id;
+
+        if (token == '+')
+        {
+            if (isSigned)
+                id = isByte ? x86_sse2_padds_b  : x86_sse2_padds_w;
+            else
+                id = isByte ? x86_sse2_paddus_b : x86_sse2_paddus_w;
+        }
+        else
+        {
+            if (isSigned)
+                id = isByte ? x86_sse2_psubs_b  : x86_sse2_psubs_w;
+            else
+                id = isByte ? x86_sse2_psubus_b : x86_sse2_psubus_w;
+        }
+
+        llvm::Function* fct = getDeclaration(ctxt_->lmodule(), id);
+
+        return builder_.CreateCall2(fct, v1, v2);
+    }
+
+    /*
+     * otherwise calculate with a wider type and clamp the result
+     */
+
+    int bits = scalar->sizeOf() * 8;
+    const llvm::Type* wideType = llvm::IntegerType::get( lctxt_, (token == '*') ? 4*bits : 2*bits );
+
+    if (vecType)
+        wideType = llvm::VectorType::get( wideType, vecType->getNumElements() );
+
+    Value* w1 = isSigned ? builder_.CreateSExt(v1, wideType) : builder_.CreateZExt(v1, wideType);
+    Value* w2 = isSigned ? builder_.CreateSExt(v2, wideType) : builder_.CreateZExt(v2, wideType);
+
+    Value* val;
+    switch (token)
+    {
+        case '+': val = builder_.CreateAdd(w1, w2); break;
+        case '-': val = builder_.CreateSub(w1, w2); break;
+        case '*': val = builder_.CreateMul(w1, w2); break;
+        case '/': 
+            val = isSigned ? builder_.CreateSDiv(w1, w2) : builder_.CreateUDiv(w1, w2); 
+            break;
+        default:
+            val = 0;
+            swiftAssert(false, "unreachable");
+    }
+
+    // the wide result is signed even for unsigned types
+    return emitClamp(scalar, val, true);
+}
+
+Value* TypeNodeCodeGen::emitMinMax(const ScalarType* scalar, Value* v1, Value* v2, bool isMax)
+{
+    Value* cond;
+
+    if ( scalar->isFloat() )
+        cond = isMax ? builder_.CreateFCmpOGT(v1, v2) : builder_.CreateFCmpOLT(v1, v2);
+    else if ( scalar->isSigned() )
+        cond = isMax ? builder_.CreateICmpSGT(v1, v2) : builder_.CreateICmpSLT(v1, v2);
+    else
+        cond = isMax ? builder_.CreateICmpUGT(v1, v2) : builder_.CreateICmpULT(v1, v2);
+
+    const llvm::Type* type = v1->getType();
+    const llvm::Type* intType = type;
+
+    // floats are selected via their bit patterns
+    if ( scalar->isFloat() )
+    {
+        intType = llvm::IntegerType::get( lctxt_, scalar->sizeOf() * 8 );
+
+        if ( const llvm::VectorType* vecType = dynamic<llvm::VectorType>(type) )
+            intType = llvm::VectorType::get( intType, vecType->getNumElements() );
+
+        v1 = builder_.CreateBitCast(v1, intType);
+        v2 = builder_.CreateBitCast(v2, intType);
+    }
+
+    // use masks instead of selects as this works for vectors, too
+    Value* mask = builder_.CreateSExt(cond, intType);
+    Value* val = builder_.CreateOr( builder_.CreateAnd(v1, mask), builder_.CreateAnd(v2, builder_.CreateNot(mask)) );
+
+    if ( scalar->isFloat() )
+        val = builder_.CreateBitCast(val, type);
+
+    return val;
+}
+
+/*
+ * Clamps the integer val, which is interpreted as signed if isSigned is set,
+ * against the range of to and converts it to to. The bounds are only checked
+ * if the range of val is not contained in the one of to -- this covers
+ * narrowing casts as well as changes of signedness.
+ */
+Value* TypeNodeCodeGen::emitClamp(const ScalarType* to, Value* val, bool isSigned)
+{
+    const llvm::Type* toType = to->getLLVMType(ctxt_->module_);
+    const llvm::VectorType* vecType = dynamic<llvm::VectorType>( val->getType() );
+
+    int srcBits = cast<llvm::IntegerType>( vecType ? vecType->getElementType() : val->getType() )->getBitWidth();
+    int dstBits = to->sizeOf() * 8;
+    int bits = std::max(srcBits, dstBits);
+
+    // number of bits of the largest value
+    int srcValueBits = isSigned ? srcBits - 1 : srcBits;
+    int dstValueBits = to->isSigned() ? dstBits - 1 : dstBits;
+
+    bool checkLo = isSigned && ( to->isUnsigned() || srcValueBits > dstValueBits );
+    bool checkHi = srcValueBits > dstValueBits;
+
+    // calculate with the wider of both types
+    const llvm::Type* type = llvm::IntegerType::get(lctxt_, bits);
+
+    if (vecType)
+    {
+        type = llvm::VectorType::get( type, vecType->getNumElements() );
+        toType = llvm::VectorType::get( toType, vecType->getNumElements() );
+    }
+
+    val = isSigned ? builder_.CreateSExt(val, type) : builder_.CreateZExt(val, type);
+
+    uint64_t min = to->isSigned() ? ~uint64_t(0) << (dstBits-1) : 0;
+    uint64_t max = to->isSigned() 
+                 ? (uint64_t(1) << (dstBits-1)) - 1 
+                 : (dstBits == 64 ? ~uint64_t(0) : (uint64_t(1) << dstBits) - 1);
+
+    Value* lo = llvm::ConstantInt::get(type, min);
+    Value* hi = llvm::ConstantInt::get(type, max);
+
+    /*
+     * use masks instead of selects as this works for vectors, too:
+     * val = (bound & mask) | (val & ~mask)
+     */
+
+    Value* mask;
+
+    if (checkLo)
+    {
+        mask = builder_.CreateSExt( builder_.CreateICmpSLT(val, lo), type );
+        val = builder_.CreateOr( builder_.CreateAnd(lo, mask), builder_.CreateAnd(val, builder_.CreateNot(mask)) );
+    }
+
+    if (checkHi)
+    {
+        mask = builder_.CreateSExt( isSigned ? builder_.CreateICmpSGT(val, hi) : builder_.CreateICmpUGT(val, hi), type );
+        val = builder_.CreateOr( builder_.CreateAnd(hi, mask), builder_.CreateAnd(val, builder_.CreateNot(mask)) );
+    }
+
+    return builder_.CreateTrunc(val, toType);
+}
+
 void TypeNodeCodeGen::setResult(TypeNode* tn, Place* place)
 {
     swiftAssert( tn->numResults() == 1, "must exactly have one result" );
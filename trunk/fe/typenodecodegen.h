@@ -14,6 +14,8 @@ namespace llvm {
 
 namespace swift {
 
+class ScalarType;
+
 template <>
 class TypeNodeVisitor<class CodeGen> : public TypeNodeVisitorBase
 {
@@ -45,11 +47,20 @@ public:
     virtual void visit(UnExpr* u);
     virtual void visit(BinExpr* b);
 
+    /// Works for scalars and vectors alike.
+    llvm::Value* emitMinMax(const ScalarType* scalar, llvm::Value* v1, llvm::Value* v2, bool isMax);
+
 private:
 
     llvm::Value* resolvePrefixExpr(Access* a);
+    void emitGather(IndexExpr* i, llvm::Value* ptr, llvm::Value* idxVec);
+    void emitPrefetch(llvm::Value* ptr, llvm::Value* index, uint64_t numElems);
     void emitCall(MemberFctCall* call, Place* _this);
     Place* getThis(MethodCall* m);
+    bool emitFolded(Expr* e);
+
+    llvm::Value* emitSaturated(int token, const ScalarType* scalar, llvm::Value* v1, llvm::Value* v2);
+    llvm::Value* emitClamp(const ScalarType* to, llvm::Value* val, bool isSigned);
 
     void setResult(TypeNode* tn, Place* place);
 
@@ -23,6 +23,7 @@
 #include <llvm/Function.h>
 
 #include "utils/llvmhelper.h"
+#include "utils/stringhelper.h"
 
 #include "fe/type.h"
 #include "fe/context.h"
@@ -36,14 +37,13 @@ namespace swift {
 Var::Var(const Location& loc, Type* type, std::string* id)
     : Node(loc) 
     , type_(type)
-    , id_(id)
+    , id_( intern(id) )
     , alloca_(0)
 {}
 
 Var::~Var()
 {
     delete type_;
-    delete id_;
 }
 
 const Type* Var::getType() const
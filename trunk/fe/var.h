@@ -57,7 +57,7 @@ public:
 protected:
 
     Type* type_;
-    std::string* id_;
+    const std::string* id_;
     llvm::AllocaInst* alloca_;
 };
 
@@ -1,8 +1,36 @@
+# Vectorized math library
+#
+# All routines are simd routines so they can be called from scalar code as
+# well as from simd loops where the vector version is used. The vector
+# versions are generated for the simd width of the target; the simd length
+# follows from the type, i.e. 4 lanes for real and 2 lanes for real64 on SSE.
+#
+# Each function is available for real and real64. There are two tiers:
+#
+#   sqrt, rsqrt, exp, log, pow, sin, cos, sincos, atan, atan2
+#       accurate versions -- about 1 ulp; pow is computed via exp and log and
+#       loses some bits for very large results
+#
+#   fast_rsqrt, fast_exp, fast_log, fast_pow
+#       fast versions -- about 1e-4 relative error for real and about 1e-9
+#       for real64
+#
+# Arguments out of the domain yield NaN, overflows yield inf.
+
 class math
+
+    #
+    # rounding
+    #
+
     simd routine sfix(real x) -> real result
         result = x.to_int().to_real()
     end
 
+    simd routine sfix(real64 x) -> real64 result
+        result = x.to_int64().to_real64()
+    end
+
     simd routine sfloor(real x) -> real result
         result = ::sfix(x)
 
@@ -11,6 +39,14 @@ class math
         end
     end
 
+    simd routine sfloor(real64 x) -> real64 result
+        result = ::sfix(x)
+
+        if result > x
+            result = result - 1.0q
+        end
+    end
+
     simd routine sceil(real x) -> real result
         result = ::sfix(x)
 
@@ -19,10 +55,380 @@ class math
         end
     end
 
+    simd routine sceil(real64 x) -> real64 result
+        result = ::sfix(x)
+
+        if result < x
+            result = result + 1.0q
+        end
+    end
+
     simd routine sround(real x) -> real result
         result = ::sfloor(x + 0.5)
     end
 
+    simd routine sround(real64 x) -> real64 result
+        result = ::sfloor(x + 0.5q)
+    end
+
+    #
+    # square roots
+    #
+
+    simd routine sqrt(real x) -> real result
+        result = x.sqrt()
+    end
+
+    simd routine sqrt(real64 x) -> real64 result
+        result = x.sqrt()
+    end
+
+    simd routine rsqrt(real x) -> real result
+        result = 1.0 / x.sqrt()
+    end
+
+    simd routine rsqrt(real64 x) -> real64 result
+        result = 1.0q / x.sqrt()
+    end
+
+    simd routine fast_rsqrt(real x) -> real result
+        # initial guess via the exponent refined by Newton-Raphson steps
+        result = (0x5F3759DF - (x.bitcast_to_int() >> 1)).bitcast_to_real()
+        result = result * (1.5 - 0.5 * x * result * result)
+        result = result * (1.5 - 0.5 * x * result * result)
+    end
+
+    simd routine fast_rsqrt(real64 x) -> real64 result
+        result = (0x5FE6EB50C7B537A9q - (x.bitcast_to_int64() >> 1q)).bitcast_to_real64()
+        result = result * (1.5q - 0.5q * x * result * result)
+        result = result * (1.5q - 0.5q * x * result * result)
+        result = result * (1.5q - 0.5q * x * result * result)
+    end
+
+    #
+    # exponential function
+    #
+
+    # handles overflows, underflows and NaN -- x is the argument of exp
+    simd routine _exp_special(real x, real y) -> real result
+        result = y
+
+        if x < -88.376
+            result = 0.0
+        end
+        if x > 88.376
+            result = 2139095040u.bitcast_to_real() # inf
+        end
+        if (x.bitcast_to_int() & 2147483647) > 2139095040
+            result = x # NaN
+        end
+    end
+
+    simd routine _exp_special(real64 x, real64 y) -> real64 result
+        result = y
+
+        if x < -708.39q
+            result = 0.0q
+        end
+        if x > 709.08q
+            result = 0x7FF0000000000000uq.bitcast_to_real64() # inf
+        end
+        if (x.bitcast_to_int64() & 0x7FFFFFFFFFFFFFFFq) > 0x7FF0000000000000q
+            result = x # NaN
+        end
+    end
+
+    simd routine exp(real arg) -> real result
+        # make working copy
+        real x = arg
+
+        # clamp to bounds -- 127.5 * ln(2) is 88.3762626647949 so stay below
+        # in order to keep n within [-127, 127]; otherwise 2^n overflows
+        real exp_lo = -88.376 # less yields 0
+        real exp_hi =  88.376 # more yields inf
+        if x < exp_lo
+           x = exp_lo
+        end
+        if x > exp_hi
+           x = exp_hi
+        end
+
+        # exp(x) = exp(g + n log 2)
+        #        = exp(g) * exp(n log 2)
+        #        = exp(g) * exp(log 2^n)
+        #        = exp(g) * 2^n
+
+        # express exp(x) as exp(g + n*log(2))
+        real         log_e_2 = 1060208640u.bitcast_to_real() #   ln(2)
+        real one_div_log_e_2 = 1069066811u.bitcast_to_real() # 1/ln(2)
+        real magic_const     = 3109978243u.bitcast_to_real() # -0.000212.., whatever this is?!
+        real n = ::sround(one_div_log_e_2 * x)
+        real g = x - n * log_e_2 - n * magic_const
+
+        # calc exp(g) via exp-series
+        real f2 = (1.0q / (2.0q)).to_real()
+        real f3 = (1.0q / (2.0q*3.0q)).to_real()
+        real f4 = (1.0q / (2.0q*3.0q*4.0q)).to_real()
+        real f5 = (1.0q / (2.0q*3.0q*4.0q*5.0q)).to_real()
+        real f6 = (1.0q / (2.0q*3.0q*4.0q*5.0q*6.0q)).to_real()
+        real f7 = (1.0q / (2.0q*3.0q*4.0q*5.0q*6.0q*7.0q)).to_real()
+
+        real exp_g = 1.0+g*(1.0+g*(f2+g*(f3+g*(f4+g*(f5+g*(f6+g*f7))))))
+
+        # build 2^n
+        real pow2n = ((n.to_int() + 127) << 23).bitcast_to_real()
+
+        result = ::_exp_special(arg, exp_g * pow2n)
+    end
+
+    simd routine fast_exp(real arg) -> real result
+        real x = arg
+
+        # clamp to the bounds of exp
+        if x < -88.376
+           x = -88.376
+        end
+        if x > 88.376
+           x = 88.376
+        end
+
+        # see exp -- but with a shorter series
+        real n = ::sround(1.44269504088896341 * x)
+        real g = x - n * 0.693147180559945309
+
+        real exp_g = 1.0+g*(1.0+g*(0.5+g*(0.166666666666+g*0.0416666666666)))
+        real pow2n = ((n.to_int() + 127) << 23).bitcast_to_real()
+
+        result = ::_exp_special(arg, exp_g * pow2n)
+    end
+
+    simd routine exp(real64 arg) -> real64 result
+        real64 x = arg
+
+        # clamp to bounds -- less yields 0, more yields inf
+        if x < -708.39q
+           x = -708.39q
+        end
+        if x > 709.08q
+           x = 709.08q
+        end
+
+        # express exp(x) as exp(g) * 2^n with |g| <= ln(2)/2
+        real64 C1 = 6.93145751953125E-1q
+        real64 C2 = 1.42860682030941723212E-6q
+        real64 n = ::sfloor(1.4426950408889634073599q * x + 0.5q)
+        real64 g = (x - n * C1) - n * C2
+
+        # Pade approximation of exp(g)
+        real64 P0 = 1.26177193074810590878E-4q
+        real64 P1 = 3.02994407707441961300E-2q
+        real64 P2 = 9.99999999999999999910E-1q
+        real64 Q0 = 3.00198505138664455042E-6q
+        real64 Q1 = 2.52448340349684104192E-3q
+        real64 Q2 = 2.27265548208155028766E-1q
+        real64 Q3 = 2.00000000000000000009E0q
+
+        real64 gg = g * g
+        real64 px = g * ((P0 * gg + P1) * gg + P2)
+        real64 exp_g = 1.0q + 2.0q * (px / ((((Q0 * gg + Q1) * gg + Q2) * gg + Q3) - px))
+
+        # build 2^n
+        real64 pow2n = ((n.to_int64() + 1023q) << 52q).bitcast_to_real64()
+
+        result = ::_exp_special(arg, exp_g * pow2n)
+    end
+
+    simd routine fast_exp(real64 arg) -> real64 result
+        real64 x = arg
+
+        if x < -708.39q
+           x = -708.39q
+        end
+        if x > 709.08q
+           x = 709.08q
+        end
+
+        real64 n = ::sround(1.4426950408889634073599q * x)
+        real64 g = (x - n * 6.93145751953125E-1q) - n * 1.42860682030941723212E-6q
+
+        real64 f2 = 1.0q / 2.0q
+        real64 f3 = f2 / 3.0q
+        real64 f4 = f3 / 4.0q
+        real64 f5 = f4 / 5.0q
+        real64 f6 = f5 / 6.0q
+        real64 f7 = f6 / 7.0q
+        real64 f8 = f7 / 8.0q
+
+        real64 exp_g = 1.0q+g*(1.0q+g*(f2+g*(f3+g*(f4+g*(f5+g*(f6+g*(f7+g*f8)))))))
+        real64 pow2n = ((n.to_int64() + 1023q) << 52q).bitcast_to_real64()
+
+        result = ::_exp_special(arg, exp_g * pow2n)
+    end
+
+    #
+    # natural logarithm
+    #
+
+    # splits x > 0 into a mantissa m in [sqrt(1/2), sqrt(2)) and an exponent e
+    simd routine _frexp(real x) -> real m, real e
+        int bits = x.bitcast_to_int()
+        int ie = ((bits >> 23) & 0xFF) - 126
+        m = ((bits & 0x007FFFFF) | 0x3F000000).bitcast_to_real() # in [0.5, 1)
+
+        if m < 0.707106781186547524
+            m = m + m
+            ie = ie - 1
+        end
+
+        e = ie.to_real()
+    end
+
+    simd routine _frexp(real64 x) -> real64 m, real64 e
+        int64 bits = x.bitcast_to_int64()
+        int64 ie = ((bits >> 52q) & 0x7FFq) - 1022q
+        m = ((bits & 0x000FFFFFFFFFFFFFq) | 0x3FE0000000000000q).bitcast_to_real64()
+
+        if m < 0.70710678118654752440q
+            m = m + m
+            ie = ie - 1q
+        end
+
+        e = ie.to_real64()
+    end
+
+    # handles x <= 0, inf and NaN
+    simd routine _log_special(real x, real y) -> real result
+        result = y
+
+        if x == 0.0
+            result = 4286578688u.bitcast_to_real() # -inf
+        end
+        if x < 0.0
+            result = 2143289344u.bitcast_to_real() # NaN
+        end
+        if x == 2139095040u.bitcast_to_real()
+            result = x # inf
+        end
+        if (x.bitcast_to_int() & 2147483647) > 2139095040
+            result = x # NaN
+        end
+    end
+
+    simd routine _log_special(real64 x, real64 y) -> real64 result
+        result = y
+
+        if x == 0.0q
+            result = 0xFFF0000000000000uq.bitcast_to_real64() # -inf
+        end
+        if x < 0.0q
+            result = 0x7FF8000000000000uq.bitcast_to_real64() # NaN
+        end
+        if x == 0x7FF0000000000000uq.bitcast_to_real64()
+            result = x # inf
+        end
+        if (x.bitcast_to_int64() & 0x7FFFFFFFFFFFFFFFq) > 0x7FF0000000000000q
+            result = x # NaN
+        end
+    end
+
+    simd routine log(real arg) -> real result
+        real m, real e = ::_frexp(arg)
+        real x = m - 1.0
+        real z = x * x
+
+        real y =          7.0376836292E-2
+        y = y * x + -1.1514610310E-1
+        y = y * x +  1.1676998740E-1
+        y = y * x + -1.2420140846E-1
+        y = y * x +  1.4249322787E-1
+        y = y * x + -1.6668057665E-1
+        y = y * x +  2.0000714765E-1
+        y = y * x + -2.4999993993E-1
+        y = y * x +  3.3333331174E-1
+        y = y * x * z
+
+        # log(2) is split into two parts in order to retain precision
+        y = y + -2.12194440E-4 * e
+        y = y - 0.5 * z
+
+        result = ::_log_special( arg, x + y + 0.693359375 * e )
+    end
+
+    simd routine fast_log(real arg) -> real result
+        real m, real e = ::_frexp(arg)
+
+        # log(m) = 2 * atanh(s) with s = (m-1) / (m+1)
+        real s = (m - 1.0) / (m + 1.0)
+        real s2 = s * s
+        real y = 2.0 * s * (1.0 + s2 * (0.333333333333 + s2 * 0.2))
+
+        result = ::_log_special( arg, y + 0.693147180559945309 * e )
+    end
+
+    simd routine log(real64 arg) -> real64 result
+        real64 m, real64 e = ::_frexp(arg)
+        real64 x = m - 1.0q
+        real64 z = x * x
+
+        real64 P0 = 1.01875663804580931796E-4q
+        real64 P1 = 4.97494994976747001425E-1q
+        real64 P2 = 4.70579119878881725854E0q
+        real64 P3 = 1.44989225341610930846E1q
+        real64 P4 = 1.79368678507819816313E1q
+        real64 P5 = 7.70838733755885391666E0q
+
+        real64 Q0 = 1.12873587189167450590E1q
+        real64 Q1 = 4.52279145837532221105E1q
+        real64 Q2 = 8.29875266912776603211E1q
+        real64 Q3 = 7.11544750618563894466E1q
+        real64 Q4 = 2.31251620126765340583E1q
+
+        real64 p = ((((P0 * x + P1) * x + P2) * x + P3) * x + P4) * x + P5
+        real64 q = ((((x + Q0) * x + Q1) * x + Q2) * x + Q3) * x + Q4
+        real64 y = x * (z * p / q)
+
+        # log(2) is split into two parts in order to retain precision
+        y = y - e * 2.121944400546905827679E-4q
+        y = y - 0.5q * z
+
+        result = ::_log_special( arg, x + y + e * 0.693359375q )
+    end
+
+    simd routine fast_log(real64 arg) -> real64 result
+        real64 m, real64 e = ::_frexp(arg)
+
+        # log(m) = 2 * atanh(s) with s = (m-1) / (m+1)
+        real64 s = (m - 1.0q) / (m + 1.0q)
+        real64 s2 = s * s
+        real64 y = 2.0q * s * (1.0q + s2 * (1.0q/3.0q + s2 * (0.2q + s2 * (1.0q/7.0q + s2 * (1.0q/9.0q)))))
+
+        result = ::_log_special( arg, y + 0.6931471805599453094172q * e )
+    end
+
+    #
+    # power function
+    #
+
+    simd routine pow(real x, real y) -> real result
+        result = ::exp( y * ::log(x) )
+    end
+
+    simd routine pow(real64 x, real64 y) -> real64 result
+        result = ::exp( y * ::log(x) )
+    end
+
+    simd routine fast_pow(real x, real y) -> real result
+        result = ::fast_exp( y * ::fast_log(x) )
+    end
+
+    simd routine fast_pow(real64 x, real64 y) -> real64 result
+        result = ::fast_exp( y * ::fast_log(x) )
+    end
+
+    #
+    # sine and cosine
+    #
+
     simd routine _k_cos(real x, real z) -> real y
         real coscof0 =  2.443315711809948E-005
         real coscof1 = -1.388731625493765E-003
@@ -31,6 +437,18 @@ class math
         y = (((coscof0 * z + coscof1) * z + coscof2) * z - 0.5) * z + 1.0
     end
 
+    simd routine _k_cos(real64 x, real64 z) -> real64 y
+        real64 coscof0 = -1.13585365213876817300E-11q
+        real64 coscof1 =  2.08757008419747316778E-9q
+        real64 coscof2 = -2.75573141792967388112E-7q
+        real64 coscof3 =  2.48015872888517045348E-5q
+        real64 coscof4 = -1.38888888888730564116E-3q
+        real64 coscof5 =  4.16666666666665929218E-2q
+
+        real64 p = ((((coscof0 * z + coscof1) * z + coscof2) * z + coscof3) * z + coscof4) * z + coscof5
+        y = 1.0q - 0.5q * z + z * z * p
+    end
+
     simd routine _k_sin(real x, real z) -> real y
         real sincof0 = -1.9515295891E-4
         real sincof1 =  8.3321608736E-3
@@ -39,10 +457,26 @@ class math
         y = (((sincof0 * z + sincof1) * z + sincof2) * z * x) + x
     end
 
+    simd routine _k_sin(real64 x, real64 z) -> real64 y
+        real64 sincof0 =  1.58962301576546568060E-10q
+        real64 sincof1 = -2.50507477628578072866E-8q
+        real64 sincof2 =  2.75573136213857245213E-6q
+        real64 sincof3 = -1.98412698295895385996E-4q
+        real64 sincof4 =  8.33333333332211858878E-3q
+        real64 sincof5 = -1.66666666666666307295E-1q
+
+        real64 p = ((((sincof0 * z + sincof1) * z + sincof2) * z + sincof3) * z + sincof4) * z + sincof5
+        y = x + x * z * p
+    end
+
     simd routine _adjust_sign(int sign, real y) -> real result
         result = ((sign << 31) ^ y.bitcast_to_int()).bitcast_to_real()
     end
 
+    simd routine _adjust_sign(int64 sign, real64 y) -> real64 result
+        result = ((sign << 63q) ^ y.bitcast_to_int64()).bitcast_to_real64()
+    end
+
     simd routine _pre_sin_cos(real arg) -> real x, uint j
         real FOPI = 1.27323954473516
         real PIO4F = 0.7853981633974483096
@@ -77,6 +511,27 @@ class math
         end
     end
 
+    simd routine _pre_sin_cos(real64 arg) -> real64 x, uint64 j
+        real64 FOPI = 1.27323954473516268615q
+        real64 DP1 = 7.85398125648498535156E-1q
+        real64 DP2 = 3.77489470793079817668E-8q
+        real64 DP3 = 2.69515142907905952645E-15q
+
+        x = (arg.bitcast_to_int64() & 0x7FFFFFFFFFFFFFFFq).bitcast_to_real64() # abs(arg)
+
+        j = (FOPI * x).to_uint64() # integer part of x/(PI/4)
+        real64 y = j.to_real64()
+
+        # map zeros to origin
+        if (j & 1uq) > 0uq
+            j = j + 1uq
+            y = y + 1.0q
+        end
+
+        # Extended precision modular arithmetic
+        x = ((x - y * DP1) - y * DP2) - y * DP3
+    end
+
     simd routine _sin_cos_helper(uint in_j, int in_sign) -> uint j, int sign
         j = in_j & 7u; # octant modulo 360 degrees
 
@@ -89,6 +544,18 @@ class math
         end
     end
 
+    simd routine _sin_cos_helper(uint64 in_j, int64 in_sign) -> uint64 j, int64 sign
+        j = in_j & 7uq; # octant modulo 360 degrees
+
+        # reflect in x axis
+        if j > 3uq
+            sign = ~in_sign
+            j = j - 4uq
+        else
+            sign = in_sign
+        end
+    end
+
     simd routine cos(real arg) -> real result
         real x, uint j = ::_pre_sin_cos(arg)
         j, int sign = ::_sin_cos_helper(j, 0)
@@ -109,6 +576,26 @@ class math
         result = ::_adjust_sign(sign, y)
     end
 
+    simd routine cos(real64 arg) -> real64 result
+        real64 x, uint64 j = ::_pre_sin_cos(arg)
+        j, int64 sign = ::_sin_cos_helper(j, 0q)
+        real64 z = x * x
+
+        real64 y
+
+        if j > 1uq
+            sign = ~sign
+        end
+
+        if (j==1uq) | (j==2uq)
+            y = ::_k_sin(x, z)
+        else
+            y = ::_k_cos(x, z)
+        end
+
+        result = ::_adjust_sign(sign, y)
+    end
+
     simd routine sin(real arg) -> real result
         real x, uint j = ::_pre_sin_cos(arg)
         j, int sign = ::_sin_cos_helper(j, arg.bitcast_to_int() >> 31)
@@ -124,6 +611,21 @@ class math
         result = ::_adjust_sign(sign, y)
     end
 
+    simd routine sin(real64 arg) -> real64 result
+        real64 x, uint64 j = ::_pre_sin_cos(arg)
+        j, int64 sign = ::_sin_cos_helper(j, arg.bitcast_to_int64() >> 63q)
+        real64 z = x * x
+        real64 y
+
+        if (j==1uq) | (j==2uq)
+            y = ::_k_cos(x, z)
+        else
+            y = ::_k_sin(x, z)
+        end
+
+        result = ::_adjust_sign(sign, y)
+    end
+
     simd routine sincos(real arg) -> real r_sin, real r_cos
         real x, uint j_sin = ::_pre_sin_cos(arg)
         uint j_cos = j_sin
@@ -158,45 +660,136 @@ class math
         r_cos = ::_adjust_sign(sign_cos, y_cos)
     end
 
-    simd routine exp(real arg) -> real result
-        # make working copy
-        real x = arg
+    simd routine sincos(real64 arg) -> real64 r_sin, real64 r_cos
+        real64 x, uint64 j_sin = ::_pre_sin_cos(arg)
+        uint64 j_cos = j_sin
+        real64 z = x * x
 
-        # clamp to bounds
-        real exp_lo = -88.3762626647949 # less yields 0
-        real exp_hi =  88.3762626647949 # less yields inf
-        if x < exp_lo
-           x = exp_lo
+        j_sin, int64 sign_sin = ::_sin_cos_helper(j_sin, arg.bitcast_to_int64() >> 63q)
+        j_cos, int64 sign_cos = ::_sin_cos_helper(j_cos, 0q)
+
+        if j_cos > 1uq
+            sign_cos = ~sign_cos
         end
-        if x > exp_hi
-           x = exp_hi
+
+        real64 y_k_cos = ::_k_cos(x, z)
+        real64 y_k_sin = ::_k_sin(x, z)
+
+        real64 y_sin
+        real64 y_cos
+
+        if (j_sin==1uq) | (j_sin==2uq)
+            y_sin = y_k_cos
+        else
+            y_sin = y_k_sin
         end
 
-        # exp(x) = exp(g + n log 2) 
-        #        = exp(g) * exp(n log 2)
-        #        = exp(g) * exp(log 2^n)
-        #        = exp(g) * 2^n
+        if (j_cos==1uq) | (j_cos==2uq)
+            y_cos = y_k_sin
+        else
+            y_cos = y_k_cos
+        end
 
-        # express exp(x) as exp(g + n*log(2))
-        real         log_e_2 = 1060208640u.bitcast_to_real() #   ln(2)
-        real one_div_log_e_2 = 1069066811u.bitcast_to_real() # 1/ln(2)
-        real magic_const     = 3109978243u.bitcast_to_real() # -0.000212.., whatever this is?!
-        real n = ::sround(one_div_log_e_2 * x)
-        real g = x - n * log_e_2 - n * magic_const
+        r_sin = ::_adjust_sign(sign_sin, y_sin)
+        r_cos = ::_adjust_sign(sign_cos, y_cos)
+    end
 
-        # calc exp(g) via exp-series
-        real f2 = (1.0q / (2.0q)).to_real()
-        real f3 = (1.0q / (2.0q*3.0q)).to_real()
-        real f4 = (1.0q / (2.0q*3.0q*4.0q)).to_real()
-        real f5 = (1.0q / (2.0q*3.0q*4.0q*5.0q)).to_real()
-        real f6 = (1.0q / (2.0q*3.0q*4.0q*5.0q*6.0q)).to_real()
-        real f7 = (1.0q / (2.0q*3.0q*4.0q*5.0q*6.0q*7.0q)).to_real()
+    #
+    # arc tangent
+    #
 
-        real exp_g = 1.0+g*(1.0+g*(f2+g*(f3+g*(f4+g*(f5+g*(f6+g*f7))))))
+    simd routine atan(real arg) -> real result
+        int sign = arg.bitcast_to_int() >> 31
+        real x = (arg.bitcast_to_int() & 0x7FFFFFFF).bitcast_to_real() # abs(arg)
+        real y = 0.0
 
-        # build 2^n
-        real pow2n = ((n.to_int() + 127) << 23).bitcast_to_real()
+        # range reduction
+        if x > 2.414213562373095
+            y = 1.5707963267948966192
+            x = -1.0 / x
+        else
+            if x > 0.4142135623730950
+                y = 0.7853981633974483096
+                x = (x - 1.0) / (x + 1.0)
+            end
+        end
+
+        real z = x * x
+        y = y + (((8.05374449538e-2 * z - 1.38776856032E-1) * z + 1.99777106478E-1) * z - 3.33329491539E-1) * z * x + x
+
+        result = ::_adjust_sign(sign, y)
+    end
 
-        result = exp_g * pow2n
+    simd routine atan(real64 arg) -> real64 result
+        int64 sign = arg.bitcast_to_int64() >> 63q
+        real64 x = (arg.bitcast_to_int64() & 0x7FFFFFFFFFFFFFFFq).bitcast_to_real64() # abs(arg)
+        real64 y = 0.0q
+        real64 morebits = 0.0q
+
+        # range reduction
+        if x > 2.41421356237309504880q
+            y = 1.57079632679489661923q
+            morebits = 6.123233995736765886130E-17q
+            x = -1.0q / x
+        else
+            if x > 0.66q
+                y = 0.78539816339744830962q
+                morebits = 0.5q * 6.123233995736765886130E-17q
+                x = (x - 1.0q) / (x + 1.0q)
+            end
+        end
+
+        real64 P0 = -8.750608600031904122785E-1q
+        real64 P1 = -1.615753718733365076637E1q
+        real64 P2 = -7.500855792314704667340E1q
+        real64 P3 = -1.228866684490136173410E2q
+        real64 P4 = -6.485021904942025371773E1q
+
+        real64 Q0 = 2.485846490142306297962E1q
+        real64 Q1 = 1.650270098316988542046E2q
+        real64 Q2 = 4.328810604912902668951E2q
+        real64 Q3 = 4.853903996359136964868E2q
+        real64 Q4 = 1.945506571482613964425E2q
+
+        real64 z = x * x
+        real64 p = (((P0 * z + P1) * z + P2) * z + P3) * z + P4
+        real64 q = ((((z + Q0) * z + Q1) * z + Q2) * z + Q3) * z + Q4
+        z = x * (z * p / q) + x
+
+        result = ::_adjust_sign(sign, y + (z + morebits))
+    end
+
+    simd routine atan2(real y, real x) -> real result
+        result = ::atan(y / x)
+
+        # move to the proper quadrant
+        if x < 0.0
+            if y < 0.0
+                result = result - 3.14159265358979323846
+            else
+                result = result + 3.14159265358979323846
+            end
+        end
+
+        if (x == 0.0) & (y == 0.0)
+            result = 0.0
+        end
+    end
+
+    simd routine atan2(real64 y, real64 x) -> real64 result
+        result = ::atan(y / x)
+
+        # move to the proper quadrant
+        if x < 0.0q
+            if y < 0.0q
+                result = result - 3.14159265358979323846q
+            else
+                result = result + 3.14159265358979323846q
+            end
+        end
+
+        if (x == 0.0q) & (y == 0.0q)
+            result = 0.0q
+        end
     end
 end
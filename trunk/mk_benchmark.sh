@@ -1,23 +1,60 @@
 #!/bin/bash 
 
+# usage: mk_benchmark.sh <number of runs> [number of warmup runs]
+
 NUM_ITER=$1
+NUM_WARMUP=${2:-1}
 BENCH=0
 ALL_TYPES=uint8\ uint16\ uint32\ uint64\ real\ real64
 REAL_TYPES=real\ real64
+SAT_TYPES=sat8\ usat8\ sat16\ usat16
+
+NUM_CORES=$(getconf _NPROCESSORS_ONLN)
+
+# one JSON record per line and measurement
+RESULTS=benchmark/results.json
+COMMIT=$(git rev-parse --short HEAD 2>/dev/null || svnversion 2>/dev/null || echo unknown)
+DATE=$(date +%Y-%m-%dT%H:%M:%S)
+
+RUNNER=benchmark/bench_runner
+BENCH_LIB=test/lib.o
 
+# $1: type
+type_size () {
+    case $1 in
+        uint8|sat8|usat8)    echo 1 ;;
+        uint16|sat16|usat16) echo 2 ;;
+        uint32|real)         echo 4 ;;
+        *)                   echo 8 ;;
+    esac
+}
+
+# $1: program, $2: number of elements, $3: bytes per element, $4...: meta data
+# sets BENCH to the median kernel time in seconds
 benchmark () {
     echo benchmarking $1
+    program=$1
+    elements=$2
+    bytes=$3
+    shift 3
 
-    for ((BENCH=0, i=0; i < $NUM_ITER; i++))
+    meta="-m commit=$COMMIT -m date=$DATE"
+    for m in "$@"
     do
-        echo -n .
-        BENCH=$(echo "scale=2; $BENCH + $(/usr/bin/time -f "%U" "$1" 2>&1)" | bc)
+        meta="$meta -m $m"
     done
 
-    BENCH=$(echo "scale=2; $BENCH/$NUM_ITER" | bc)
+    BENCH=$($RUNNER -w $NUM_WARMUP -r $NUM_ITER -e $elements -b $bytes $meta -j $RESULTS $program)
     echo " -> $BENCH"
 }
 
+# records the speedup of swift over c++
+# $1: benchmark, $2: type, $3: speedup, $4: kind of speedup
+record_speedup () {
+    echo "{\"commit\": \"$COMMIT\", \"date\": \"$DATE\", \"benchmark\": \"$1\", \"type\": \"$2\", \"$4\": $3}" >> $RESULTS
+}
+
+# $4: number of elements, $5: number of TYPE values moved per element
 build_and_benchmark () {
     echo
     echo "### runnig $2 benchmark ###"
@@ -48,23 +85,125 @@ build_and_benchmark () {
         echo compiling file $file_swift
         ./swiftc $file_swift
         echo compiling file $file_cpp and $file_main
-        g++ $file_cpp $file_main -O3 -fomit-frame-pointer -ffinite-math-only -o $file_cpp.out
+        g++ $file_cpp $file_main $BENCH_LIB -Ibenchmark -O3 -fomit-frame-pointer -ffinite-math-only -o $file_cpp.out
 
-        benchmark $file_swift.out
-        cpp=$BENCH
+        bytes=$(( $5 * $(type_size $TYPE) ))
 
-        benchmark $file_cpp.out
+        benchmark $file_swift.out $4 $bytes benchmark=$2 type=$TYPE impl=swift
         swift=$BENCH
 
-        speedup=$(echo "scale=2; $swift / $cpp" | bc)
+        benchmark $file_cpp.out $4 $bytes benchmark=$2 type=$TYPE impl=cpp
+        cpp=$BENCH
+
+        speedup=$(echo "scale=2; $cpp / $swift" | bc)
         echo "---> speedup: $speedup"
+        record_speedup $2 $TYPE $speedup speedup
         echo
     done
 
     rm temp
 }
 
-echo "*** RUNNING BENCHMARK WITH $1 ITERATIONS EACH ***"
+# runs an already built benchmark compiled with -parallel-simd on 1 to N cores
+# $4: number of elements, $5: number of TYPE values moved per element
+scale_benchmark () {
+    echo
+    echo "### running $2 scaling benchmark on 1 to $NUM_CORES cores ###"
+    echo
+
+    for TYPE in $1
+    do
+        file_swift=benchmark/$2/swift/$3_$TYPE.swift
+        file_par=benchmark/$2/swift/$3_parallel_$TYPE.swift
+
+        cp $file_swift $file_par
+        echo compiling file $file_par
+        ./swiftc -parallel-simd $file_par
+        bytes=$(( $5 * $(type_size $TYPE) ))
+
+        for ((threads=1; threads <= $NUM_CORES; threads++))
+        do
+            echo -n "$threads thread(s): "
+            SWIFT_NUM_THREADS=$threads benchmark $file_par.out $4 $bytes \
+                benchmark=$2 type=$TYPE impl=swift threads=$threads
+
+            if [[ $threads == 1 ]]; then
+                single=$BENCH
+            fi
+
+            speedup=$(echo "scale=2; $single / $BENCH" | bc)
+            echo "---> scaling: $speedup"
+            record_speedup $2 $TYPE $speedup scaling_$threads
+        done
+        echo
+    done
+}
+
+# compares an already built benchmark with and without streaming simd loops
+# $4: number of elements, $5: number of TYPE values moved per element
+stream_benchmark () {
+    echo
+    echo "### running $2 streaming benchmark ###"
+    echo
+
+    for TYPE in $1
+    do
+        file_swift=benchmark/$2/swift/$3_$TYPE.swift
+        file_cached=benchmark/$2/swift/$3_cached_$TYPE.swift
+
+        cp $file_swift $file_cached
+        echo compiling file $file_cached without streaming
+        ./swiftc -stream-threshold 0 $file_cached
+        bytes=$(( $5 * $(type_size $TYPE) ))
+
+        benchmark $file_cached.out $4 $bytes benchmark=$2 type=$TYPE impl=swift stream=no
+        cached=$BENCH
+
+        benchmark $file_swift.out $4 $bytes benchmark=$2 type=$TYPE impl=swift stream=yes
+        streaming=$BENCH
+
+        speedup=$(echo "scale=2; $cached / $streaming" | bc)
+        echo "---> streaming speedup: $speedup"
+        record_speedup $2 $TYPE $speedup streaming_speedup
+        echo
+    done
+}
+
+# compares an already built benchmark compiled with each floating point model
+# $4: number of elements, $5: number of TYPE values moved per element
+fp_model_benchmark () {
+    echo
+    echo "### running $2 floating point model benchmark ###"
+    echo
+
+    for TYPE in $1
+    do
+        file_swift=benchmark/$2/swift/$3_$TYPE.swift
+        bytes=$(( $5 * $(type_size $TYPE) ))
+
+        for MODEL in strict contract fast
+        do
+            file_model=benchmark/$2/swift/$3_${MODEL}_$TYPE.swift
+
+            cp $file_swift $file_model
+            echo compiling file $file_model with -fp-model $MODEL
+            ./swiftc -fp-model $MODEL $file_model
+
+            benchmark $file_model.out $4 $bytes benchmark=$2 type=$TYPE impl=swift fp_model=$MODEL
+
+            if [[ $MODEL == strict ]]; then
+                strict=$BENCH
+            fi
+
+            speedup=$(echo "scale=2; $strict / $BENCH" | bc)
+            echo "---> speedup over strict: $speedup"
+            record_speedup $2 $TYPE $speedup fp_${MODEL}_speedup
+        done
+        echo
+    done
+}
+
+echo "*** RUNNING BENCHMARK WITH $NUM_ITER RUNS AND $NUM_WARMUP WARMUP RUNS EACH ***"
 echo "*** system specification ***"
 uname -a
 echo 
@@ -73,7 +212,20 @@ echo
 g++ --version
 echo 
 
-build_and_benchmark "$ALL_TYPES" vec3add vec3
-build_and_benchmark "$REAL_TYPES" vec3cross vec3
-build_and_benchmark "$REAL_TYPES" matmul mat
-build_and_benchmark "$REAL_TYPES" ifelse vec3
+# build the runner and the timing lib
+g++ -O2 benchmark/runner.cpp -o $RUNNER || exit -1
+gcc -c test/lib.c -o $BENCH_LIB || exit -1
+
+build_and_benchmark "$ALL_TYPES" vec3add vec3 80000000 9
+stream_benchmark "$ALL_TYPES" vec3add vec3 80000000 9
+build_and_benchmark "$REAL_TYPES" vec3cross vec3 80000000 9
+stream_benchmark "$REAL_TYPES" vec3cross vec3 80000000 9
+fp_model_benchmark "$REAL_TYPES" vec3cross vec3 80000000 9
+build_and_benchmark "$REAL_TYPES" matmul mat 40000000 15
+stream_benchmark "$REAL_TYPES" matmul mat 40000000 15
+fp_model_benchmark "$REAL_TYPES" matmul mat 40000000 15
+scale_benchmark "$REAL_TYPES" matmul mat 40000000 15
+build_and_benchmark "$REAL_TYPES" ifelse vec3 80000000 6
+build_and_benchmark "$SAT_TYPES" saturate sat 64000000 3
+
+echo "*** results appended to $RESULTS ***"
@@ -68,9 +68,11 @@ class Math
 
     routine main() -> int result
         simd{real} a = 40000000x
+        simd{real} b = 40000000x
         index i = 0x
         while i < 40000000x
             a[i] = c_call real rand_float()
+            b[i] = a[i]
             i = i + 1x
         end
 
@@ -80,6 +82,54 @@ class Math
         end
         c_call stop_timer()
 
+        # the same with the library version
+        c_call start_timer()
+        simd i: 0x, 40000000x
+            b@ = math::exp(b@)
+        end
+        c_call stop_timer()
+
+        # edge values of the library version
         result = 0
+
+        real inf = 2139095040u.bitcast_to_real()
+        real nan = 2143289344u.bitcast_to_real()
+
+        if math::exp(100.0) != inf
+            c_call print_float( math::exp(100.0) )
+            result = 1
+        end
+        if math::exp(-100.0) != 0.0
+            c_call print_float( math::exp(-100.0) )
+            result = 1
+        end
+        if math::exp(0.0) != 1.0
+            c_call print_float( math::exp(0.0) )
+            result = 1
+        end
+        if math::exp(nan) == math::exp(nan) # only NaN differs from itself
+            c_call print_float( math::exp(nan) )
+            result = 1
+        end
+
+        real64 inf64 = 0x7FF0000000000000uq.bitcast_to_real64()
+        real64 nan64 = 0x7FF8000000000000uq.bitcast_to_real64()
+
+        if math::exp(1000.0q) != inf64
+            c_call print_double( math::exp(1000.0q) )
+            result = 1
+        end
+        if math::exp(-1000.0q) != 0.0q
+            c_call print_double( math::exp(-1000.0q) )
+            result = 1
+        end
+        if math::exp(0.0q) != 1.0q
+            c_call print_double( math::exp(0.0q) )
+            result = 1
+        end
+        if math::exp(nan64) == math::exp(nan64)
+            c_call print_double( math::exp(nan64) )
+            result = 1
+        end
     end
 end
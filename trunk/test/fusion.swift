@@ -0,0 +1,52 @@
+simd class Vec3
+    real x
+    real y
+    real z
+
+    simd operator + (Vec3 v1, Vec3 v2) -> Vec3 result
+        result.x = v1.x + v2.x
+        result.y = v1.y + v2.y
+        result.z = v1.z + v2.z
+    end
+
+    simd operator * (Vec3 v1, Vec3 v2) -> Vec3 result
+        result.x = v1.x * v2.x
+        result.y = v1.y * v2.y
+        result.z = v1.z * v2.z
+    end
+end
+
+class Fusion
+    routine main() -> int result
+        simd{real} a = 4000000x
+        simd{real} b = 4000000x
+        simd{real} c = 4000000x
+        simd{real} tmp = 4000000x # elided after fusion
+
+        c_call start_timer()
+        simd i: 0x, 4000000x
+            tmp@ = a@ + b@
+        end
+        simd j: 0x, 4000000x
+            c@ = tmp@ * a@
+        end
+        c_call stop_timer()
+
+        # the operators of Vec3 are pure -- these loops are fused, too
+        simd{Vec3} va = 4000000x
+        simd{Vec3} vb = 4000000x
+        simd{Vec3} vc = 4000000x
+        simd{Vec3} vtmp = 4000000x # elided after fusion
+
+        c_call start_timer()
+        simd k: 0x, 4000000x
+            vtmp@ = va@ + vb@
+        end
+        simd l: 0x, 4000000x
+            vc@ = vtmp@ * va@
+        end
+        c_call stop_timer()
+
+        result = 0
+    end
+end
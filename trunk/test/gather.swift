@@ -0,0 +1,43 @@
+class Gather
+
+    routine main() -> int result
+        simd{index} keys = 4000000x
+        array{real} table = 256x
+        array{real} hist = 256x
+
+        index i = 0x
+        while i < 4000000x
+            keys[i] = (i * 40503x) & 255x
+            i = i + 1x
+        end
+
+        i = 0x
+        while i < 256x
+            table[i] = c_call real rand_float()
+            hist[i] = 0.0
+            i = i + 1x
+        end
+
+        simd{real} looked_up = 4000000x
+
+        c_call start_timer()
+        simd i: 0x, 4000000x
+            looked_up@ = table[keys@]       # gather
+            hist[keys@] = hist[keys@] + 1.0 # scatter -- equal keys must all count
+        end
+        c_call stop_timer()
+
+        c_call print_float(looked_up[42x])
+
+        # 40503 is odd so each block of 256 keys is a permutation of 0..255
+        result = 0
+        i = 0x
+        while i < 256x
+            if hist[i] != 15625.0
+                c_call print_float(hist[i])
+                result = 1
+            end
+            i = i + 1x
+        end
+    end
+end
@@ -3,8 +3,10 @@
 #include <sys/resource.h> 
 #include <stdlib.h>
 #include <stdint.h>
+#include <time.h>
 
 static struct rusage start;
+static struct timeval wall_start;
 
 static struct timeval sub(const struct timeval* t1, const struct timeval* t2)
 {
@@ -24,15 +26,20 @@ static struct timeval sub(const struct timeval* t1, const struct timeval* t2)
 void start_timer()
 {
     getrusage(RUSAGE_SELF, &start);
+    gettimeofday(&wall_start, 0);
 }
 
 void stop_timer()
 {
     struct rusage end;
+    struct timeval wall_end;
     getrusage(RUSAGE_SELF, &end);
+    gettimeofday(&wall_end, 0);
 
     struct timeval utime = sub(&end.ru_utime, &start.ru_utime);
     struct timeval stime = sub(&end.ru_stime, &start.ru_stime);
+    // user time sums up all threads of parallel simd loops
+    struct timeval wtime = sub(&wall_end, &wall_start);
 
     printf("user time: %jd:%06jd\n",  
             (intmax_t) utime.tv_sec,
@@ -40,6 +47,40 @@ void stop_timer()
     printf("system time: %jd:%06jd\n",  
             (intmax_t) stime.tv_sec,
             (intmax_t) stime.tv_usec);
+    printf("wall time: %jd:%06jd\n",  
+            (intmax_t) wtime.tv_sec,
+            (intmax_t) wtime.tv_usec);
+}
+
+/*
+ * bench_begin/bench_end time one kernel region with the monotonic clock in
+ * nanoseconds. The time is appended to the file named by SWIFT_BENCH_FILE or
+ * printed to stderr as "kernel <number> <nanoseconds>".
+ */
+
+static struct timespec bench_start;
+static int num_kernels = 0;
+
+void bench_begin()
+{
+    clock_gettime(CLOCK_MONOTONIC, &bench_start);
+}
+
+void bench_end()
+{
+    struct timespec bench_stop;
+    clock_gettime(CLOCK_MONOTONIC, &bench_stop);
+
+    intmax_t ns = (intmax_t) (bench_stop.tv_sec  - bench_start.tv_sec) * 1000000000
+                + (intmax_t) (bench_stop.tv_nsec - bench_start.tv_nsec);
+
+    const char* name = getenv("SWIFT_BENCH_FILE");
+    FILE* file = name ? fopen(name, "a") : 0;
+
+    fprintf(file ? file : stderr, "kernel %i %jd\n", num_kernels++, ns);
+
+    if (file)
+        fclose(file);
 }
 
 float rand_float()
@@ -0,0 +1,233 @@
+/*
+ * runtime support for simd loops compiled with -parallel-simd
+ *
+ * A pool of worker threads is started on the first parallel loop and lives
+ * until the program exits. The number of threads is taken from the
+ * environment variable SWIFT_NUM_THREADS and defaults to the number of online
+ * cores. The calling thread takes part in the work as worker 0.
+ *
+ * The iteration range is split into chunks which are a multiple of the simd
+ * step. Each worker initially owns a contiguous range of chunks which it
+ * processes from the front. A worker running out of chunks steals the back
+ * half of the range of another worker.
+ *
+ * Reductions combine the partial result of each chunk with the reduction
+ * variable between swift_parallel_lock and swift_parallel_unlock.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_THREADS 64
+#define CHUNK_STEPS 64 // number of simd steps per chunk
+
+typedef void (*chunk_fct_t)(void* env, int64_t lo, int64_t hi);
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    int64_t next; // first chunk of this worker
+    int64_t end;  // one past the last chunk of this worker
+} worker_t;
+
+static worker_t workers[MAX_THREADS];
+static pthread_t threads[MAX_THREADS];
+static int num_threads = 0;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t reduction_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  pool_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  pool_done  = PTHREAD_COND_INITIALIZER;
+static unsigned generation = 0;
+static int num_busy = 0;
+
+// the current job
+static chunk_fct_t job_fct;
+static void* job_env;
+static int64_t job_lower;
+static int64_t job_upper;
+static int64_t job_chunk;
+
+static __thread int is_worker = 0;
+
+static int take(int id, int64_t* chunk)
+{
+    worker_t* w = &workers[id];
+    int result = 0;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->next < w->end)
+    {
+        *chunk = w->next++;
+        result = 1;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return result;
+}
+
+static int steal(int id)
+{
+    int i;
+    for (i = 1; i < num_threads; ++i)
+    {
+        worker_t* victim = &workers[(id + i) % num_threads];
+        int64_t first = 0, last = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->next < victim->end)
+        {
+            last  = victim->end;
+            first = victim->end - (victim->end - victim->next + 1) / 2;
+            victim->end = first;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (first < last)
+        {
+            worker_t* w = &workers[id];
+            pthread_mutex_lock(&w->lock);
+            w->next = first;
+            w->end  = last;
+            pthread_mutex_unlock(&w->lock);
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void work(int id)
+{
+    int64_t chunk;
+
+    do
+    {
+        while ( take(id, &chunk) )
+        {
+            int64_t lo = job_lower + chunk * job_chunk;
+            int64_t hi = lo + job_chunk;
+
+            job_fct(job_env, lo, hi < job_upper ? hi : job_upper);
+        }
+    } while ( steal(id) );
+}
+
+static void* worker_main(void* arg)
+{
+    int id = (int) (intptr_t) arg;
+    unsigned seen = 0;
+
+    is_worker = 1;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pool_lock);
+        while (generation == seen)
+            pthread_cond_wait(&pool_start, &pool_lock);
+        seen = generation;
+        pthread_mutex_unlock(&pool_lock);
+
+        work(id);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--num_busy == 0)
+            pthread_cond_signal(&pool_done);
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    return 0;
+}
+
+static void init_pool()
+{
+    int i;
+    const char* env = getenv("SWIFT_NUM_THREADS");
+
+    num_threads = env ? atoi(env) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (num_threads < 1)
+        num_threads = 1;
+    if (num_threads > MAX_THREADS)
+        num_threads = MAX_THREADS;
+
+    for (i = 0; i < num_threads; ++i)
+        pthread_mutex_init(&workers[i].lock, 0);
+
+    for (i = 1; i < num_threads; ++i)
+        pthread_create(&threads[i], 0, worker_main, (void*) (intptr_t) i);
+}
+
+void swift_parallel_for(chunk_fct_t fct, void* env, int64_t lower, int64_t upper, int64_t step)
+{
+    int i;
+    int64_t num_chunks, per_worker;
+
+    if (lower >= upper)
+        return;
+
+    // nested parallel loops run sequentially on the current worker
+    if (is_worker)
+    {
+        fct(env, lower, upper);
+        return;
+    }
+
+    if (num_threads == 0)
+        init_pool();
+
+    job_fct   = fct;
+    job_env   = env;
+    job_lower = lower;
+    job_upper = upper;
+    job_chunk = step * CHUNK_STEPS;
+
+    num_chunks = (upper - lower + job_chunk - 1) / job_chunk;
+
+    if (num_threads == 1 || num_chunks == 1)
+    {
+        fct(env, lower, upper);
+        return;
+    }
+
+    // distribute chunks evenly
+    per_worker = (num_chunks + num_threads - 1) / num_threads;
+    for (i = 0; i < num_threads; ++i)
+    {
+        int64_t first = i * per_worker;
+        int64_t last  = first + per_worker;
+
+        workers[i].next = first < num_chunks ? first : num_chunks;
+        workers[i].end  = last  < num_chunks ? last  : num_chunks;
+    }
+
+    // wake up workers
+    pthread_mutex_lock(&pool_lock);
+    num_busy = num_threads - 1;
+    ++generation;
+    pthread_cond_broadcast(&pool_start);
+    pthread_mutex_unlock(&pool_lock);
+
+    is_worker = 1;
+    work(0);
+    is_worker = 0;
+
+    // wait for the others
+    pthread_mutex_lock(&pool_lock);
+    while (num_busy != 0)
+        pthread_cond_wait(&pool_done, &pool_lock);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void swift_parallel_lock()
+{
+    pthread_mutex_lock(&reduction_lock);
+}
+
+void swift_parallel_unlock()
+{
+    pthread_mutex_unlock(&reduction_lock);
+}
@@ -0,0 +1,35 @@
+class Reduction
+
+    routine main() -> int result
+        simd{real} a = 4000000x
+        index i = 0x
+        while i < 4000000x
+            a[i] = c_call real rand_float()
+            i = i + 1x
+        end
+
+        real sum = 0.0
+        real biggest = -1.0
+        bool all_in_range = true
+        bool any_positive = false
+
+        c_call start_timer()
+        simd i: 0x, 4000000x
+            sum = sum + a@
+            biggest = biggest.max(a@)
+            all_in_range = all_in_range & (a@ >= -1.0)
+            any_positive = any_positive | (a@ > 0.0)
+        end
+        c_call stop_timer()
+
+        c_call print_float(sum)
+        c_call print_float(biggest)
+
+        # rand_float yields values in [-1, 1]
+        if all_in_range & any_positive
+            result = 0
+        else
+            result = 1
+        end
+    end
+end
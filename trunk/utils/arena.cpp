@@ -0,0 +1,55 @@
+#include "utils/arena.h"
+
+#include <new>
+
+// everything handed out is aligned like this
+static const size_t ALIGNMENT = 16;
+
+static size_t align(size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+Arena::Arena(size_t chunkSize /*= 64 * 1024*/)
+    : chunkSize_(chunkSize)
+    , pos_(0)
+    , end_(0)
+    , size_(0)
+{}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void* Arena::allocate(size_t size)
+{
+    size = align(size);
+
+    if ( size_t(end_ - pos_) < size )
+    {
+        // large requests get a chunk of their own
+        size_t chunkSize = size > chunkSize_ ? size : chunkSize_;
+
+        pos_ = static_cast<char*>( ::operator new(chunkSize) );
+        end_ = pos_ + chunkSize;
+        chunks_.push_back(pos_);
+    }
+
+    void* result = pos_;
+    pos_ += size;
+    size_ += size;
+
+    return result;
+}
+
+void Arena::release()
+{
+    for (size_t i = 0; i < chunks_.size(); ++i)
+        ::operator delete(chunks_[i]);
+
+    chunks_.clear();
+    pos_ = 0;
+    end_ = 0;
+    size_ = 0;
+}
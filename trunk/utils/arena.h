@@ -0,0 +1,80 @@
+#ifndef SWIFT_ARENA_H
+#define SWIFT_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief A bump allocator which hands out memory from large chunks and frees
+ * all of it at once.
+ *
+ * Not thread safe.
+ */
+class Arena
+{
+public:
+
+    Arena(size_t chunkSize = 64 * 1024);
+    ~Arena();
+
+    void* allocate(size_t size);
+
+    /// Frees all memory handed out so far.
+    void release();
+
+    /// Returns the number of bytes handed out since the last release.
+    size_t size() const { return size_; }
+
+private:
+
+    typedef std::vector<char*> Chunks;
+
+    Chunks chunks_;
+    size_t chunkSize_;
+    char* pos_;
+    char* end_;
+    size_t size_;
+};
+
+//----------------------------------------------------------------------
+
+/**
+ * @brief Derive from this class in order to allocate all objects of a class
+ * hierarchy from the arena of \p Tag.
+ *
+ * delete still runs the destructor but the memory is reclaimed not until
+ * arena().release() is called. Hence, no object of the hierarchy may be used
+ * after that.
+ *
+ * If the MemMgr is used each object is allocated on its own so leaks are
+ * still traced.
+ */
+template<class Tag>
+class ArenaObject
+{
+public:
+
+    static void* operator new(size_t size)
+    {
+#ifdef SWIFT_USE_MEM_MGR
+        return ::operator new(size);
+#else // SWIFT_USE_MEM_MGR
+        return arena().allocate(size);
+#endif // SWIFT_USE_MEM_MGR
+    }
+
+    static void operator delete(void* p)
+    {
+#ifdef SWIFT_USE_MEM_MGR
+        ::operator delete(p);
+#endif // SWIFT_USE_MEM_MGR
+    }
+
+    static Arena& arena()
+    {
+        static Arena arena;
+        return arena;
+    }
+};
+
+#endif // SWIFT_ARENA_H
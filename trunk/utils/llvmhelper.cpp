@@ -3,6 +3,9 @@
 #include <llvm/Constants.h>
 #include <llvm/DerivedTypes.h>
 #include <llvm/Function.h>
+#include <llvm/Instructions.h>
+#include <llvm/Intrinsics.h>
+#include <llvm/Module.h>
 #include <llvm/ADT/APFloat.h>
 #include <llvm/Support/TypeBuilder.h>
 #include <llvm/Support/IRBuilder.h>
@@ -227,3 +230,155 @@ Value* simdBroadcast(Value* sVal, const Type* vType, LLVMBuilder& builder)
         return vVal;
     }
 }
+
+Value* simdSplatValue(Value* vVal)
+{
+    // shufflevector (insertelement undef, s, 0), undef, zeroinitializer
+    ShuffleVectorInst* shuffle = dyn_cast<ShuffleVectorInst>(vVal);
+    if (!shuffle)
+        return 0;
+
+    Constant* mask = dyn_cast<Constant>( shuffle->getOperand(2) );
+    if ( !mask || !mask->isNullValue() )
+        return 0;
+
+    InsertElementInst* insert = dyn_cast<InsertElementInst>( shuffle->getOperand(0) );
+    if (!insert)
+        return 0;
+
+    ConstantInt* idx = dyn_cast<ConstantInt>( insert->getOperand(2) );
+    if ( !idx || !idx->isZero() )
+        return 0;
+
+    return insert->getOperand(1);
+}
+
+Value* simdConsecutiveBase(Value* vVal, LLVMBuilder& builder)
+{
+    // <c, c+1, ..., c+n-1> as built by simd_range
+    if ( ConstantVector* cVec = dyn_cast<ConstantVector>(vVal) )
+    {
+        ConstantInt* first = dyn_cast<ConstantInt>( cVec->getOperand(0) );
+        if (!first)
+            return 0;
+
+        for (unsigned i = 1; i < cVec->getNumOperands(); ++i)
+        {
+            ConstantInt* elem = dyn_cast<ConstantInt>( cVec->getOperand(i) );
+            if ( !elem || elem->getValue() != first->getValue() + i )
+                return 0;
+        }
+
+        return first;
+    }
+
+    // consecutive +/- broadcast
+    BinaryOperator* binOp = dyn_cast<BinaryOperator>(vVal);
+    if (!binOp)
+        return 0;
+
+    Value* op0 = binOp->getOperand(0);
+    Value* op1 = binOp->getOperand(1);
+
+    if ( binOp->getOpcode() == Instruction::Add )
+    {
+        if ( Value* s = simdSplatValue(op1) )
+        {
+            if ( Value* base = simdConsecutiveBase(op0, builder) )
+                return builder.CreateAdd(base, s);
+        }
+
+        if ( Value* s = simdSplatValue(op0) )
+        {
+            if ( Value* base = simdConsecutiveBase(op1, builder) )
+                return builder.CreateAdd(base, s);
+        }
+    }
+    else if ( binOp->getOpcode() == Instruction::Sub )
+    {
+        if ( Value* s = simdSplatValue(op1) )
+        {
+            if ( Value* base = simdConsecutiveBase(op0, builder) )
+                return builder.CreateSub(base, s);
+        }
+    }
+
+    return 0;
+}
+
+//----------------------------------------------------------------------
+
+static Module* getModule(LLVMBuilder& builder)
+{
+    return builder.GetInsertBlock()->getParent()->getParent();
+}
+
+void createStreamingStore(Value* val, Value* ptr, LLVMBuilder& builder)
+{
+    const Type* type = val->getType();
+
+    if ( const StructType* structType = dyn_cast<StructType>(type) )
+    {
+        for (unsigned i = 0; i < structType->getNumElements(); ++i)
+        {
+            createStreamingStore( 
+                    builder.CreateExtractValue(val, i), 
+                    builder.CreateStructGEP(ptr, i), 
+                    builder );
+        }
+
+        return;
+    }
+
+    const VectorType* vecType = dyn_cast<VectorType>(type);
+    if ( !vecType || vecType->getBitWidth() % 128 != 0 )
+    {
+        builder.CreateStore(val, ptr); // no non-temporal store available
+        return;
+    }
+
+    /*
+     * split into <2 x i64> pieces for movntdq
+     */
+
+    LLVMContext& lctxt = type->getContext();
+    unsigned num = vecType->getBitWidth() / 64;
+    const VectorType* i64Vec = VectorType::get( IntegerType::getInt64Ty(lctxt), num );
+
+    Value* i64Val = builder.CreateBitCast(val, i64Vec);
+    Value* i8Ptr = builder.CreateBitCast( ptr, PointerType::getUnqual(IntegerType::getInt8Ty(lctxt)) );
+    Function* movnt = Intrinsic::getDeclaration( getModule(builder), Intrinsic::x86_sse2_movnt_dq );
+
+    for (unsigned i = 0; i < num; i += 2)
+    {
+        Value* piece = i64Val;
+
+        if (num != 2)
+        {
+            std::vector<Constant*> mask(2);
+            mask[0] = createInt32(lctxt, i);
+            mask[1] = createInt32(lctxt, i + 1);
+
+            piece = builder.CreateShuffleVector( 
+                    i64Val, UndefValue::get(i64Vec), ConstantVector::get(mask) );
+        }
+
+        builder.CreateCall2( movnt, builder.CreateConstGEP1_32(i8Ptr, i * 8), piece );
+    }
+}
+
+void createStoreFence(LLVMBuilder& builder)
+{
+    builder.CreateCall( Intrinsic::getDeclaration(getModule(builder), Intrinsic::x86_sse_sfence) );
+}
+
+void createPrefetch(Value* ptr, LLVMBuilder& builder)
+{
+    LLVMContext& lctxt = ptr->getContext();
+    Value* i8Ptr = builder.CreateBitCast( ptr, PointerType::getUnqual(IntegerType::getInt8Ty(lctxt)) );
+
+    // read access without temporal locality
+    builder.CreateCall3( 
+            Intrinsic::getDeclaration(getModule(builder), Intrinsic::prefetch),
+            i8Ptr, createInt32(lctxt, 0), createInt32(lctxt, 0) );
+}
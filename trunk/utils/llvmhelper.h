@@ -65,6 +65,31 @@ llvm::Value* simdExtract(llvm::Value* vVec, llvm::Value* mod, const llvm::Type*
 llvm::Value* simdPack(llvm::Value* sVal, llvm::Value* vVal, llvm::Value* mod, LLVMBuilder& builder);
 llvm::Value* simdBroadcast(llvm::Value* sVal, const llvm::Type* vType, LLVMBuilder& builder);
 
+/// Returns the scalar if \p vVal has been built by \a simdBroadcast or 0 otherwise.
+llvm::Value* simdSplatValue(llvm::Value* vVal);
+
+/**
+ * @brief Checks whether \p vVal is an integer vector <b, b+1, ..., b+n-1>.
+ *
+ * @return b or 0 if this cannot be proven.
+ */
+llvm::Value* simdConsecutiveBase(llvm::Value* vVal, LLVMBuilder& builder);
+
+//----------------------------------------------------------------------
+
+/**
+ * @brief Stores \p val to \p ptr with non-temporal stores.
+ *
+ * Aggregates are stored member by member. Members which are no vectors of a
+ * multiple of 128 bits fall back to an ordinary store. \p ptr must be aligned.
+ */
+void createStreamingStore(llvm::Value* val, llvm::Value* ptr, LLVMBuilder& builder);
+
+/// Orders all preceding non-temporal stores before all following stores.
+void createStoreFence(LLVMBuilder& builder);
+
+void createPrefetch(llvm::Value* ptr, LLVMBuilder& builder);
+
 //----------------------------------------------------------------------
 
 #endif // UTILS_LLVM_HELPER_H
@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include <llvm/DerivedTypes.h>
+#include <llvm/Instructions.h>
 #include <llvm/Support/IRBuilder.h>
 
 #include "utils/cast.h"
@@ -108,3 +110,116 @@ void ScalarAddr::writeBack(LLVMBuilder& builder) const
     //Value* vValNew = simdPack(sVal, vVal, mod_, builder);
     //builder.CreateStore(vValNew, val_);
 }
+
+//----------------------------------------------------------------------
+
+VecAddr::VecAddr(Value* ptr, const Type* vecType, LLVMBuilder& builder)
+    : Addr( builder.CreateBitCast(ptr, PointerType::getUnqual(vecType)) )
+    , align_( ::cast<VectorType>(vecType)->getElementType()->getPrimitiveSizeInBits() / 8 )
+{
+    LoadInst* vVal = builder.CreateLoad( val_, ptr->getName() );
+    vVal->setAlignment(align_);
+
+    alloca_ = createEntryAlloca(builder, vecType, ptr->getNameStr() + ".tmp" );
+    builder.CreateStore(vVal, alloca_);
+}
+
+Value* VecAddr::getScalar(LLVMBuilder& builder) const
+{
+    return builder.CreateLoad(alloca_);
+}
+
+Value* VecAddr::getAddr(LLVMBuilder& builder) const
+{
+    return alloca_;
+}
+
+void VecAddr::writeBack(LLVMBuilder& builder) const
+{
+    StoreInst* store = builder.CreateStore( builder.CreateLoad(alloca_), val_ );
+    store->setAlignment(align_);
+}
+
+//----------------------------------------------------------------------
+
+StreamAddr::StreamAddr(Value* ptr, LLVMBuilder& builder)
+    : Addr(ptr)
+{
+    // do not load the old value -- this would fetch the cache line anyway
+    const Type* type = ::cast<PointerType>( ptr->getType() )->getElementType();
+    alloca_ = createEntryAlloca(builder, type, ptr->getNameStr() + ".tmp" );
+}
+
+Value* StreamAddr::getScalar(LLVMBuilder& builder) const
+{
+    return builder.CreateLoad(alloca_);
+}
+
+Value* StreamAddr::getAddr(LLVMBuilder& builder) const
+{
+    return alloca_;
+}
+
+void StreamAddr::writeBack(LLVMBuilder& builder) const
+{
+    createStreamingStore( builder.CreateLoad(alloca_), val_, builder );
+}
+
+//----------------------------------------------------------------------
+
+GatherAddr::GatherAddr(const Values& lanePtrs, const Type* vecType, LLVMBuilder& builder)
+    : Addr(0)
+    , lanePtrs_(lanePtrs)
+    , lane_(-1)
+{
+    LLVMContext& lctxt = vecType->getContext();
+    Value* vVal = UndefValue::get(vecType);
+
+    for (size_t i = 0; i < lanePtrs_.size(); ++i)
+    {
+        Value* sVal = builder.CreateLoad(lanePtrs_[i]);
+        vVal = builder.CreateInsertElement( vVal, sVal, createInt32(lctxt, i) );
+    }
+
+    alloca_ = createEntryAlloca(builder, vecType, "gather.tmp");
+    builder.CreateStore(vVal, alloca_);
+}
+
+Value* GatherAddr::getScalar(LLVMBuilder& builder) const
+{
+    return builder.CreateLoad(alloca_);
+}
+
+Value* GatherAddr::getAddr(LLVMBuilder& builder) const
+{
+    return alloca_;
+}
+
+void GatherAddr::writeBack(LLVMBuilder& builder) const
+{
+    LLVMContext& lctxt = alloca_->getContext();
+    Value* vVal = builder.CreateLoad(alloca_);
+
+    for (size_t i = 0; i < lanePtrs_.size(); ++i)
+    {
+        if ( lane_ != -1 && size_t(lane_) != i )
+            continue;
+
+        Value* sVal = builder.CreateExtractElement( vVal, createInt32(lctxt, i) );
+        builder.CreateStore(sVal, lanePtrs_[i]);
+    }
+}
+
+Value* GatherAddr::emitConflictCheck(LLVMBuilder& builder) const
+{
+    Value* conflict = createInt1( alloca_->getContext(), 0 );
+
+    for (size_t i = 0; i < lanePtrs_.size(); ++i)
+    {
+        for (size_t j = i + 1; j < lanePtrs_.size(); ++j)
+            conflict = builder.CreateOr( conflict, builder.CreateICmpEQ(lanePtrs_[i], lanePtrs_[j]) );
+    }
+
+    return conflict;
+}
+
@@ -3,11 +3,13 @@
 
 #include <vector>
 
+#include "utils/arena.h"
 #include "utils/llvmhelper.h"
 
 //----------------------------------------------------------------------
 
-class Place
+/// Places are owned by TypeNodes and therefore live in an arena, too.
+class Place : public ArenaObject<Place>
 {
 public:
 
@@ -103,6 +105,90 @@ protected:
 
 //----------------------------------------------------------------------
 
+/**
+ * @brief Consecutive scalars starting at a possibly unaligned address which
+ * are loaded and stored as one vector.
+ */
+class VecAddr : public Addr
+{
+public:
+
+    VecAddr(llvm::Value* ptr, const llvm::Type* vecType, LLVMBuilder& builder);
+    virtual ~VecAddr() {}
+
+    virtual llvm::Value* getScalar(LLVMBuilder& builder) const;
+    virtual llvm::Value* getAddr(LLVMBuilder& builder) const;
+    virtual void writeBack(LLVMBuilder& builder) const;
+
+protected:
+
+    unsigned align_;
+    llvm::Value* alloca_;
+};
+
+//----------------------------------------------------------------------
+
+/**
+ * @brief An aligned location which is completely overwritten without being
+ * read before.
+ *
+ * The value is written back with non-temporal stores so it does not evict
+ * data from the caches. A store fence must follow before the data is read.
+ */
+class StreamAddr : public Addr
+{
+public:
+
+    StreamAddr(llvm::Value* ptr, LLVMBuilder& builder);
+    virtual ~StreamAddr() {}
+
+    virtual llvm::Value* getScalar(LLVMBuilder& builder) const;
+    virtual llvm::Value* getAddr(LLVMBuilder& builder) const;
+    virtual void writeBack(LLVMBuilder& builder) const;
+
+protected:
+
+    llvm::Value* alloca_;
+};
+
+//----------------------------------------------------------------------
+
+/**
+ * @brief Scalars at arbitrary addresses -- one per lane -- which are
+ * gathered into a vector and scattered back.
+ *
+ * The lanes are scattered in ascending order so if several lanes refer to
+ * the same address the last one wins. Statements which read what they
+ * scatter check for such conflicts and handle one lane after the other.
+ */
+class GatherAddr : public Addr
+{
+public:
+
+    GatherAddr(const Values& lanePtrs, const llvm::Type* vecType, LLVMBuilder& builder);
+    virtual ~GatherAddr() {}
+
+    virtual llvm::Value* getScalar(LLVMBuilder& builder) const;
+    virtual llvm::Value* getAddr(LLVMBuilder& builder) const;
+    virtual void writeBack(LLVMBuilder& builder) const;
+
+    /// Returns an i1 which is set if at least two lanes refer to the same address.
+    llvm::Value* emitConflictCheck(LLVMBuilder& builder) const;
+
+    size_t numLanes() const { return lanePtrs_.size(); }
+
+    /// Only scatter \p lane in \a writeBack -- -1 scatters all lanes.
+    void setLane(int lane) { lane_ = lane; }
+
+protected:
+
+    Values lanePtrs_;
+    llvm::Value* alloca_;
+    int lane_;
+};
+
+//----------------------------------------------------------------------
+
 typedef std::vector<Place*> Places;
 
 //----------------------------------------------------------------------
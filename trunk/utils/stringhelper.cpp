@@ -20,6 +20,32 @@
 #include "stringhelper.h"
 
 #include <sstream>
+#include <tr1/unordered_set>
+
+typedef std::tr1::unordered_set<std::string> Symbols;
+
+static Symbols& symbols()
+{
+    static Symbols symbols;
+    return symbols;
+}
+
+const std::string* intern(const std::string& str)
+{
+    // elements of an unordered_set never move
+    return &*symbols().insert(str).first;
+}
+
+const std::string* intern(std::string* str)
+{
+    if (!str)
+        return 0;
+
+    const std::string* sym = intern(*str);
+    delete str;
+
+    return sym;
+}
 
 std::string number2String(int number)
 {
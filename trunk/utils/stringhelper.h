@@ -22,6 +22,7 @@
 
 #include <sstream>
 #include <string>
+#include <tr1/functional>
 
 /**
  * Use this function object in order to compare string pointer properly.
@@ -35,6 +36,29 @@ struct StringPtrCmp
     }
 };
 
+/**
+ * Symbols are interned strings: there is exactly one copy of each string, so
+ * symbols can be compared and hashed by address. They live until the end of
+ * the program.
+ */
+const std::string* intern(const std::string& str);
+
+/**
+ * Interns \p str and deletes it. The AST nodes turn the ids handed over by
+ * the parser into symbols this way once, so all lookups with their ids merely
+ * hash and compare addresses. Returns 0 if \p str is 0.
+ */
+const std::string* intern(std::string* str);
+
+/// Hashes symbols by address.
+struct SymbolHash
+{
+    size_t operator () (const std::string* sym) const
+    {
+        return std::tr1::hash<const std::string*>()(sym);
+    }
+};
+
 /// Builds a string from a number which has at least 4 digits
 std::string number2String(int number);
 
@@ -4,8 +4,10 @@
 #include <sstream>
 
 #include <llvm/Type.h>
+#include <llvm/Constants.h>
 #include <llvm/DerivedTypes.h>
 #include <llvm/Module.h>
+#include <llvm/Support/IRBuilder.h>
 
 #include "utils/assert.h"
 #include "utils/cast.h"
@@ -38,13 +40,7 @@ const Type* vecTypeRec(Module* module, int simdWidth, const Type* type, const bv
     simdLength = (simdLength == vec::CONTAINS_BOOL) ? simdWidth : simdLength;
 
     if ( type->isIntegerTy() && type->getPrimitiveSizeInBits() == 1 )
-    {
-        // -> this is a bool
-        int numBits = (simdWidth / simdLength) * 8;
-        const IntegerType* intType = IntegerType::get(type->getContext(), numBits);
-
-        return VectorType::get(intType, simdLength);
-    }
+        return vec::maskType(type->getContext(), simdWidth, simdLength); // -> this is a bool
     else if ( type->isIntegerTy() || type->isFloatTy() || type->isDoubleTy() )
         return VectorType::get(type, simdLength);
     else if ( type->isVoidTy() )
@@ -180,4 +176,53 @@ const FunctionType* vecFunctionType(Module* module,
     return cast<FunctionType>( vecTypeRec(module, simdWidth, type, uniforms, simdLength) );
 }
 
+//------------------------------------------------------------------------------
+
+static MaskKind maskKind = LANE_MASK;
+
+void setMaskKind(MaskKind kind)
+{
+    maskKind = kind;
+}
+
+MaskKind getMaskKind()
+{
+    return maskKind;
+}
+
+const Type* maskType(LLVMContext& lctxt, int simdWidth, int simdLength)
+{
+    if (maskKind == PREDICATE_MASK)
+        return VectorType::get( IntegerType::getInt1Ty(lctxt), simdLength );
+
+    int numBits = (simdWidth / simdLength) * 8;
+    return VectorType::get( IntegerType::get(lctxt, numBits), simdLength );
+}
+
+bool isPredicate(const Type* type)
+{
+    const VectorType* vt = dynamic<VectorType>(type);
+    return vt && vt->getElementType()->isIntegerTy() 
+              && vt->getElementType()->getPrimitiveSizeInBits() == 1;
+}
+
+Value* toMask(LLVMBuilder& builder, Value* pred, const Type* maskType)
+{
+    if ( pred->getType() == maskType )
+        return pred;
+
+    swiftAssert( isPredicate(pred->getType()), "must be a predicate" );
+
+    // true lanes become all ones
+    return builder.CreateSExt(pred, maskType);
+}
+
+Value* toPredicate(LLVMBuilder& builder, Value* mask)
+{
+    if ( isPredicate(mask->getType()) )
+        return mask;
+
+    return builder.CreateICmpNE( mask, Constant::getNullValue(mask->getType()) );
+}
+
 } // namespace vec
@@ -3,8 +3,11 @@
 
 #include <vector>
 
+#include "utils/llvmhelper.h"
+
 namespace llvm {
     class FunctionType;
+    class LLVMContext;
     class Module;
     class Type;
 }
@@ -30,6 +33,40 @@ const llvm::FunctionType* vecFunctionType(llvm::Module* module,
                                           const llvm::FunctionType* ft, 
                                           const std::vector<bool>& uniforms, 
                                           int& simdLength);
+
+/*
+ * Masks
+ *
+ * Within a function a vectorized bool is a predicate -- a vector of i1 --
+ * which is what compares yield and what &, | and ^ work on. In memory and at
+ * the boundaries of simd routines it takes the form of the target's masks:
+ * either one full-width integer lane per element for SSE/AVX style blends or
+ * the predicate itself where the target has mask registers like AVX-512's k
+ * registers. Predicates are converted to masks when they are stored or
+ * passed to a simd routine; masks are converted back to predicates when a
+ * loaded or returned value enters an operation.
+ */
+
+enum MaskKind
+{
+    LANE_MASK,     ///< All bits of a lane set or clear.
+    PREDICATE_MASK ///< One bit per lane.
+};
+
+void setMaskKind(MaskKind kind);
+MaskKind getMaskKind();
+
+/// Returns the mask type for \p simdLength bools.
+const llvm::Type* maskType(llvm::LLVMContext& lctxt, int simdWidth, int simdLength);
+
+/// Is \p type a vector of i1?
+bool isPredicate(const llvm::Type* type);
+
+/// Converts the predicate \p pred to a value of \p maskType if necessary.
+llvm::Value* toMask(LLVMBuilder& builder, llvm::Value* pred, const llvm::Type* maskType);
+
+/// Converts the mask \p mask to a predicate if necessary.
+llvm::Value* toPredicate(LLVMBuilder& builder, llvm::Value* mask);
 } // namespace vec
 
 #endif // VEC_TYPE_VECTORIZER_H